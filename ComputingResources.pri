@@ -0,0 +1,80 @@
+# the sources of the application without main.cpp, shared by ComputingResources.pro and the tests
+
+QT       += core gui widgets printsupport
+QT       += charts
+QT       += network
+QT       += xml
+
+# qmake CONFIG+=alloc_stats counts the heap allocations per subsystem and the live objects, see allocstats.h
+alloc_stats:DEFINES += ALLOC_STATS
+
+include($$PWD/QFontIcon/QFontIcon.pri)
+
+INCLUDEPATH += $$PWD $$PWD/QFontIcon
+
+SOURCES += \
+    $$PWD/mainwindow.cpp \
+    $$PWD/logger.cpp \
+    $$PWD/resources.cpp \
+    $$PWD/alice.cpp \
+    $$PWD/fundingagency.cpp \
+    $$PWD/consolewidget.cpp \
+    $$PWD/mymdiarea.cpp \
+    $$PWD/tier.cpp \
+    $$PWD/naming.cpp \
+    $$PWD/pltablemodel.cpp \
+    $$PWD/fatablemodel.cpp \
+    $$PWD/fasortproxymodel.cpp \
+    $$PWD/usageledger.cpp \
+    $$PWD/tableexporter.cpp \
+    $$PWD/downsampler.cpp \
+    $$PWD/seriesbuilder.cpp \
+    $$PWD/timeseriespyramid.cpp \
+    $$PWD/zoomchartview.cpp \
+    $$PWD/heatmapwidget.cpp \
+    $$PWD/ingestpipeline.cpp \
+    $$PWD/fetcher.cpp \
+    $$PWD/async.cpp \
+    $$PWD/modelsnapshot.cpp \
+    $$PWD/taskscheduler.cpp \
+    $$PWD/progressmodel.cpp \
+    $$PWD/timing.cpp \
+    $$PWD/tracer.cpp \
+    $$PWD/networksession.cpp \
+    $$PWD/allocstats.cpp
+
+HEADERS += \
+    $$PWD/mainwindow.h \
+    $$PWD/logger.h \
+    $$PWD/resources.h \
+    $$PWD/alice.h \
+    $$PWD/fundingagency.h \
+    $$PWD/consolewidget.h \
+    $$PWD/mymdiarea.h \
+    $$PWD/tier.h \
+    $$PWD/naming.h \
+    $$PWD/pltablemodel.h \
+    $$PWD/fatablemodel.h \
+    $$PWD/fasortproxymodel.h \
+    $$PWD/usageledger.h \
+    $$PWD/tableexporter.h \
+    $$PWD/downsampler.h \
+    $$PWD/seriesbuilder.h \
+    $$PWD/timeseriespyramid.h \
+    $$PWD/zoomchartview.h \
+    $$PWD/heatmapwidget.h \
+    $$PWD/ingestpipeline.h \
+    $$PWD/fetcher.h \
+    $$PWD/async.h \
+    $$PWD/modelsnapshot.h \
+    $$PWD/taskscheduler.h \
+    $$PWD/progressmodel.h \
+    $$PWD/canceltoken.h \
+    $$PWD/timing.h \
+    $$PWD/tracer.h \
+    $$PWD/networksession.h \
+    $$PWD/allocstats.h
+
+RESOURCES += \
+    $$PWD/images.qrc \
+    $$PWD/data/data.qrc
@@ -4,11 +4,6 @@
 #
 #-------------------------------------------------
 
-QT       += core gui widgets printsupport
-QT       += charts
-QT       += network
-QT       += xml
-
 contains(TARGET, qml.*) {
     QT += qml quick
 }
@@ -18,38 +13,12 @@ CONFIG(release, debug|release):DEFINES += QT_NO_DEBUG_OUTPUT
 TARGET = ComputingResources
 TEMPLATE = app
 
-include("QFontIcon/QFontIcon.pri")
-
-INCLUDEPATH += QFontIcon
+# the sources are listed in ComputingResources.pri, the benchmarks of tests/ build them too
+include(ComputingResources.pri)
 
 ICON = images/logo-alice.icns
 
-SOURCES += main.cpp\
-        mainwindow.cpp \
-    logger.cpp \
-    resources.cpp \
-    alice.cpp \
-    fundingagency.cpp \
-    consolewidget.cpp \
-    mymdiarea.cpp \
-    tier.cpp \
-    naming.cpp \
-    pltablemodel.cpp
-
-HEADERS  += mainwindow.h \
-    logger.h \
-    resources.h \
-    alice.h \
-    fundingagency.h \
-    consolewidget.h \
-    mymdiarea.h \
-    tier.h \
-    naming.h \
-    pltablemodel.h
-
-RESOURCES += \
-    images.qrc \
-    data/data.qrc
+SOURCES += main.cpp
 
 DISTFILES += \
     .travis.yml \
@@ -2,25 +2,39 @@
 // singleton
 // Y. Schutz November 2016
 
-#include <QDir>
 #include <QErrorMessage>
-#include <QFile>
-#include <QNetworkAccessManager>
-#include <QStandardItemModel>
-#include <QStandardPaths>
 #include <QTableView>
 
 #include "alice.h"
+#include "allocstats.h"
+#include "async.h"
+#include "fetcher.h"
 #include "fundingagency.h"
+#include "ingestpipeline.h"
+#include "logger.h"
 #include "mainwindow.h"
 #include "naming.h"
-
-ALICE ALICE::mInstance = ALICE();
+#include "progressmodel.h"
+#include "taskscheduler.h"
+#include "timing.h"
 
 //===========================================================================
 ALICE &ALICE::instance()
 {
-    return mInstance;
+    // created at first use, after the first window is shown (see MainWindow::warmUp), not before main()
+    // the model belongs to the thread creating it: the GUI thread, the loaders only come after the warm up
+
+    static ALICE instance;
+    return instance;
+}
+
+//===========================================================================
+ALICE *ALICE::createScratch()
+{
+    // a new instance, the model shown by the views is not touched by its loads
+    // the caller deletes it, after clear() if it read funding agencies
+
+    return new ALICE;
 }
 
 //===========================================================================
@@ -82,69 +96,84 @@ void ALICE::addTape(Tier::TierCat cat, double tape)
 }
 
 //===========================================================================
-void ALICE::doOffenders(const QString &year)
+void ALICE::clear()
 {
-    // build the table of due resources (requirements-pledges)
-    // collect the M&O information from Glance
-    readGlanceData(year);
+    // deletes the funding agencies and their sites, they are not deleted with ALICE
 
-    organizeFA();
+    qDeleteAll(mFAs);
+    mFAs.clear();
+}
 
-    // collect the information from Rebus, sites and pledges
-    readRebus(year);
+//===========================================================================
+ALICE::Table ALICE::doOffenders(const QString &year)
+{
+    // build the rows of the table of due resources (requirements-pledges)
 
-    // collect the requirements from an ad hoc table
-    readRequirements(year);
+    parseYearReports(year, downloadYearReports(year));
+    return offendersTable();
+}
 
-    // draw the table in a view
-    drawOffendersTable();
+//===========================================================================
+ALICE::Table ALICE::doReqAndPle(const QString &year)
+{
+    // build the rows of the table of requirements and pledges
+
+    parseYearReports(year, downloadYearReports(year));
+    return reqAndPleTable();
 }
 
+//===========================================================================
+ALICE::YearReports ALICE::downloadYearReports(const QString &year) const
+{
+    // downloads the M&O payers, the pledges and the requirements of year at the same time, can run in any thread
+
+    QFuture<QByteArray> glance       = fetchGlanceData(year);
+    QFuture<QByteArray> rebus        = fetchRebus(year);
+    QFuture<QByteArray> requirements = fetchRequirements(year);
+
+    TIMED_SCOPE("year reports: network");
+    YearReports rv;
+    rv.glance       = glance.result();
+    rv.rebus        = rebus.result();
+    rv.requirements = requirements.result();
+    return rv;
+}
 
 //===========================================================================
-void ALICE::doReqAndPle(const QString &year)
+void ALICE::parseYearReports(const QString &year, const YearReports &reports)
 {
-    // build the table of requirements and pledges
+    // the funding agencies, their sites and pledges and the requirements of year, from the files of downloadYearReports
+
     // collect the M&O information from Glance
-    readGlanceData(year);
+    parseGlanceData(reports.glance);
 
     organizeFA();
 
 //    setCEandSE(year);
 
-
     // collect the information from Rebus, sites and pledges
-    readRebus(year);
+    parseRebus(year, reports.rebus);
 
     // collect the requirements from an ad hoc table
-    readRequirements(year);
-
-    // draw the table in a view
-    drawTable();
-
-//    // save it to a csv file
-
-    saveCSV(year);
-
-
-    // TEMPORARY DISABLE
+    parseRequirements(year, reports.requirements);
 }
 
 //===========================================================================
-void ALICE::drawOffendersTable()
+ALICE::Table ALICE::offendersTable()
 {
-    // draw the table
-
-    // first add a few FAs clustering FAs per country
+    // the rows of the table of due resources
+    // the rows are shown by the model in the GUI thread
 
-    mModel->removeColumns(0, mModel->columnCount());
+    TIMED_SCOPE("doOffenders: rows");
+    ALLOC_SCOPE(AllocStats::kTable);
 
-    qint32 row = 0;
+    // first add a few FAs clustering FAs per country
 
     double sumDueCPU  = 0.0;
     double sumDueDisk = 0.0;
     double sumDueTape = 0.0;
 
+    Table rows;
     for (FundingAgency *fa : mFAs) {
         if (fa->name().left(1) == "-")
             continue;
@@ -162,258 +191,150 @@ void ALICE::drawOffendersTable()
             tape = 0;
         sumDueTape += tape;
         if ((cpu < 0) || (disk) < 0 || (tape < 0)) {
-            QList<QStandardItem*> oneRow;
-            oneRow.insert(kStatC, new QStandardItem(fa->status()));
-            oneRow.insert(kFAC, new QStandardItem(fa->name()));
-            oneRow.insert(kMOC, new QStandardItem(QString("%1").arg(fa->payers())));
-            if (fa->name() == "CERN") {
-                oneRow.insert(kConC, new QStandardItem(QString("-")));
-            } else {
-                oneRow.insert(kConC, new QStandardItem(QString("%1").arg(fa->contrib(), 4, 'f', 2)));
-            }
-
-            qint32 col = kConC + 1;
-
-            QStandardItem *cpuSIP = new QStandardItem(QString("%1").arg(qAbs(cpu), 5, 'f', 2));
-            oneRow.insert(col++, cpuSIP);
-
-            QStandardItem *diskSIP = new QStandardItem(QString("%1").arg(qAbs(disk), 5, 'f', 2));
-            oneRow.insert(col++, diskSIP);
-
-            QStandardItem *tapeSIP = new QStandardItem(QString("%1").arg(qAbs(tape), 5, 'f', 2));
-            oneRow.insert(col++, tapeSIP);
-            mModel->insertRow(row, oneRow);
-            for (qint32 index = 0; index < col; index++)
-                mModel->item(row, index)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-            oneRow.clear();
-            row++;        }
+            FATableModel::Row row;
+            row.status  = fa->status();
+            row.name    = fa->name();
+            row.payers  = fa->payers();
+            row.contrib = fa->contrib();
+            row.values << qAbs(cpu) << qAbs(disk) << qAbs(tape);
+            rows.append(row);
+        }
     }
 
-    // the horizontal headers
-
-    mModel->setHorizontalHeaderItem(kStatC, new QStandardItem(tr("Status")));
-    mModel->setHorizontalHeaderItem(kFAC,   new QStandardItem(tr("Funding Agency")));
-    mModel->setHorizontalHeaderItem(kMOC,   new QStandardItem(tr("M&O Payers")));
-    mModel->setHorizontalHeaderItem(kConC,  new QStandardItem(tr("Contribution(%)")));
-
-    mModel->setHorizontalHeaderItem(kConC + 1, new QStandardItem(tr("Due CPU (kHEPSPEC06)")));
-    mModel->setHorizontalHeaderItem(kConC + 2, new QStandardItem(tr("Due Disk (PB)")));
-    mModel->setHorizontalHeaderItem(kConC + 3, new QStandardItem(tr("Due Tape (PB)")));
-
     // the last row
 
-    mLastRow.clear();
-
-    QStandardItem * blanck1 = new QStandardItem("");
-    mLastRow.insert(0, blanck1);
-    QStandardItem *total = new QStandardItem("Total");
-    total->setTextAlignment((Qt::AlignHCenter | Qt::AlignVCenter));
-    mLastRow.insert(1, total);
-    QStandardItem *totMO = new QStandardItem(QString("%1").arg(countMOPayers()));
-    totMO->setTextAlignment((Qt::AlignRight | Qt::AlignVCenter));
-    mLastRow.insert(2, totMO);
-    QStandardItem * blanck2 = new QStandardItem("");
-    mLastRow.insert(3, blanck2);
-
-    QStandardItem *sumCPUD  = new QStandardItem(QString("%1").arg(qAbs(sumDueCPU), 5, 'f', 2));
-    QStandardItem *sumDiskD = new QStandardItem(QString("%1").arg(qAbs(sumDueDisk), 5, 'f', 2));
-    QStandardItem *sumTapeD = new QStandardItem(QString("%1").arg(qAbs(sumDueTape), 5, 'f', 2));
-    sumCPUD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumDiskD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumTapeD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-
-    mLastRow.insert(4, sumCPUD);
-    mLastRow.insert(5, sumDiskD);
-    mLastRow.insert(6, sumTapeD);
-
-    mModel->appendRow(mLastRow);
+    FATableModel::Row total;
+    total.name   = "Total";
+    total.payers = countMOPayers();
+    total.total  = true;
+    total.values << qAbs(sumDueCPU) << qAbs(sumDueDisk) << qAbs(sumDueTape);
+    rows.append(total);
 
+    return rows;
 }
 
 //===========================================================================
-void ALICE::drawTable()
+ALICE::Table ALICE::reqAndPleTable()
 {
-    // draw the table
+    // the rows of the table of requirements and pledges
+    // the rows are shown by the model in the GUI thread
 
-    // first add a few FAs clustering FAs per country
+    TIMED_SCOPE("doReqAndPle: rows");
+    ALLOC_SCOPE(AllocStats::kTable);
 
-    mModel->removeColumns(0, mModel->columnCount());
-
-    qint32 row = 0;
+    // first add a few FAs clustering FAs per country
 
+    Table rows;
     for (FundingAgency *fa : mFAs) {
         if (fa->name().left(1) == "-")
             continue;
-        QList<QStandardItem*> oneRow;
-        oneRow.insert(kStatC, new QStandardItem(fa->status()));
-        oneRow.insert(kFAC, new QStandardItem(fa->name()));
-        oneRow.insert(kMOC, new QStandardItem(QString("%1").arg(fa->payers())));
-        if (fa->name() == "CERN") {
-            oneRow.insert(kConC, new QStandardItem(QString("-")));
-        } else {
-            oneRow.insert(kConC, new QStandardItem(QString("%1").arg(fa->contrib(), 4, 'f', 2)));
-        }
-
-        qint32 col = kConC + 1;
+        FATableModel::Row row;
+        row.status  = fa->status();
+        row.name    = fa->name();
+        row.payers  = fa->payers();
+        row.contrib = fa->contrib();
 
         // required
-        double cpu = fa->getRequiredCPU();
-        QStandardItem *cpuSIR = new QStandardItem(QString("%1").arg(cpu, 5, 'f', 2));
-        oneRow.insert(col++, cpuSIR);
-
-        double disk = fa->getRequiredDisk();
-        QStandardItem *diskSIR = new QStandardItem(QString("%1").arg(disk, 5, 'f', 2));
-        oneRow.insert(col++, diskSIR);
-
-        double tape = fa->getRequiredTape();
-        QStandardItem *tapeSIR = new QStandardItem(QString("%1").arg(tape, 5, 'f', 2));
-        oneRow.insert(col++, tapeSIR);
+        row.values << fa->getRequiredCPU() << fa->getRequiredDisk() << fa->getRequiredTape();
 
         // pledges
-        cpu = fa->getPledgedCPU();
-        QStandardItem *cpuSIP = new QStandardItem(QString("%1").arg(cpu, 5, 'f', 2));
-        oneRow.insert(col++, cpuSIP);
-
-        disk = fa->getPledgedDisk();
-        QStandardItem *diskSIP = new QStandardItem(QString("%1").arg(disk, 5, 'f', 2));
-        oneRow.insert(col++, diskSIP);
-
-        tape = fa->getPledgedTape();
-        QStandardItem *tapeSIP = new QStandardItem(QString("%1").arg(tape, 5, 'f', 2));
-        oneRow.insert(col++, tapeSIP);
+        row.values << fa->getPledgedCPU() << fa->getPledgedDisk() << fa->getPledgedTape();
 
         // the difference
         double diff =  100 * (fa->getPledgedCPU() - fa->getRequiredCPU()) / fa->getRequiredCPU();
-        QStandardItem *cpuSID = new QStandardItem(QString("%1").arg(diff, 5, 'f', 0));
-        if (diff < -20)
-            cpuSID->setForeground(QBrush(Qt::red));
-        else
-            cpuSID->setForeground(QBrush(Qt::green));
-        oneRow.insert(col++, cpuSID);
-
+        row.values << diff;
         diff =  100 * (fa->getPledgedDisk() - fa->getRequiredDisk()) / fa->getRequiredDisk();
-        QStandardItem *diskSID = new QStandardItem(QString("%1").arg(diff, 5, 'f', 0));
-        if (diff < -20)
-            diskSID->setForeground(QBrush(Qt::red));
-        else
-            diskSID->setForeground(QBrush(Qt::green));
-        oneRow.insert(col++, diskSID);
-
+        row.values << diff;
         if (fa->getRequiredTape() != 0.0)
             diff =  100 * (fa->getPledgedTape() - fa->getRequiredTape()) / fa->getRequiredTape();
         else
             diff = 0.0;
-        QStandardItem *tapeSID = new QStandardItem(QString("%1").arg(diff, 5, 'f', 0));
-        if (diff < -20)
-            tapeSID->setForeground(QBrush(Qt::red));
-        else
-            tapeSID->setForeground(QBrush(Qt::green));
-        oneRow.insert(col++, tapeSID);
+        row.values << diff;
 
-        mModel->insertRow(row, oneRow);
-        for (qint32 index = 0; index < col; index++)
-            mModel->item(row, index)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-        oneRow.clear();
-        row++;
+        rows.append(row);
     }
 
-    // the horizontal headers
-
-    mModel->setHorizontalHeaderItem(kStatC, new QStandardItem(tr("Status")));
-    mModel->setHorizontalHeaderItem(kFAC,   new QStandardItem(tr("Funding Agency")));
-    mModel->setHorizontalHeaderItem(kMOC,   new QStandardItem(tr("M&O Payers")));
-    mModel->setHorizontalHeaderItem(kConC,  new QStandardItem(tr("Contribution(%)")));
-
     mT0Required.setObjectName(QString("Required Resources at T0"));
     mT1Required.setObjectName(QString("Required Resources at T1"));
     mT2Required.setObjectName(QString("Required Resources at T2"));
 
-    mModel->setHorizontalHeaderItem(kConC + 1, new QStandardItem(tr("Required CPU (kHEPSPEC06)")));
-    mModel->setHorizontalHeaderItem(kConC + 2, new QStandardItem(tr("Required Disk (PB)")));
-    mModel->setHorizontalHeaderItem(kConC + 3, new QStandardItem(tr("Required Tape (PB)")));
+    // the last row
 
-    mModel->setHorizontalHeaderItem(kConC + 4, new QStandardItem(tr("Pledged CPU (kHEPSPEC06)")));
-    mModel->setHorizontalHeaderItem(kConC + 5, new QStandardItem(tr("Pledged Disk (PB)")));
-    mModel->setHorizontalHeaderItem(kConC + 6, new QStandardItem(tr("Pledged Tape (PB)")));
+    FATableModel::Row total;
+    total.name   = "Total";
+    total.payers = countMOPayers();
+    total.total  = true;
 
-    mModel->setHorizontalHeaderItem(kConC + 7, new QStandardItem(tr("Diff CPU (%)")));
-    mModel->setHorizontalHeaderItem(kConC + 8, new QStandardItem(tr("Diff Disk (%)")));
-    mModel->setHorizontalHeaderItem(kConC + 9, new QStandardItem(tr("Diff Tape (%)")));
+    double sumRequiredCPU  = mT0Required.getCPU()  + mT1Required.getCPU()  + mT2Required.getCPU();
+    double sumRequiredDisk = mT0Required.getDisk() + mT1Required.getDisk() + mT2Required.getDisk();
+    double sumRequiredTape = mT0Required.getTape() + mT1Required.getTape() + mT2Required.getTape();
+    total.values << sumRequiredCPU << sumRequiredDisk << sumRequiredTape;
 
-    // the last row
+    double sumPledgedCPU  = mT0Pledged.getCPU()  + mT1Pledged.getCPU()  + mT2Pledged.getCPU();
+    double sumPledgedDisk = mT0Pledged.getDisk() + mT1Pledged.getDisk() + mT2Pledged.getDisk();
+    double sumPledgedTape = mT0Pledged.getTape() + mT1Pledged.getTape() + mT2Pledged.getTape();
+    total.values << sumPledgedCPU << sumPledgedDisk << sumPledgedTape;
+
+    total.values << 100 * ( sumPledgedCPU  - sumRequiredCPU )  / sumRequiredCPU;
+    total.values << 100 * ( sumPledgedDisk - sumRequiredDisk ) / sumRequiredDisk;
+    total.values << 100 * ( sumPledgedTape - sumRequiredTape ) / sumRequiredTape;
+    rows.append(total);
+
+    return rows;
+}
+
+//===========================================================================
+bool ALICE::exportTable(const QString &fileName, TableExporter::Format format, const QAbstractItemModel *view) const
+{
+    // save the table in fileName, as CSV, TSV or JSON Lines
+    // through view, a sort and filter proxy of the model, the rows are written as they are shown
+
+    return TableExporter::exportModel(view ? view : mModel, fileName, format, FATableModel::kRawRole);
+}
+
+//===========================================================================
+QFuture<QByteArray> ALICE::fetchGlanceData(const QString &year) const
+{
+    // starts the download of the M&O payers of year
+
+    return fetchReport(QString("/data/%1/MandO.csv").arg(year));
+}
+
+//===========================================================================
+QList<QFuture<QByteArray> > ALICE::fetchMonthlyReport(const QDate &date) const
+{
+    // starts the downloads of the four files of the monthly report of date, in the order read by computeMonthlyUsage
+
+    QList<QFuture<QByteArray> > rv;
+    rv.append(fetchReport(QString("/data/%1/%2/TIER1_TIER1_sum_normcpu_TIER1_VO.csv").arg(date.year()).arg(date.month())));
+    rv.append(fetchReport(QString("/data/%1/%2/reptier2.csv").arg(date.year()).arg(date.month())));
+    rv.append(fetchReport(QString("/data/%1/%2/CPU_Usage.csv").arg(date.year()).arg(date.month())));
+    rv.append(fetchReport(QString("/data/%1/%2/Disk_Tape_Usage.csv").arg(date.year()).arg(date.month())));
+    return rv;
+}
+
+//===========================================================================
+QFuture<QByteArray> ALICE::fetchRebus(const QString &year) const
+{
+    // starts the download of the pledges of year
+
+    return fetchReport(QString("/data/%1/pledges.csv").arg(year));
+}
+
+//===========================================================================
+QFuture<QByteArray> ALICE::fetchReport(const QString &fileName) const
+{
+    // starts the download of a report from the ALICE web site, the content is empty if it failed
+
+    return Fetcher::instance().get(QUrl(dataURL() + fileName));
+}
 
-    mLastRow.clear();
-
-    QStandardItem * blanck1 = new QStandardItem("");
-    mLastRow.insert(0, blanck1);
-    QStandardItem *total = new QStandardItem("Total");
-    total->setTextAlignment((Qt::AlignHCenter | Qt::AlignVCenter));
-    mLastRow.insert(1, total);
-    QStandardItem *totMO = new QStandardItem(QString("%1").arg(countMOPayers()));
-    totMO->setTextAlignment((Qt::AlignRight | Qt::AlignVCenter));
-    mLastRow.insert(2, totMO);
-    QStandardItem * blanck2 = new QStandardItem("");
-    mLastRow.insert(3, blanck2);
-
-    double sumRequiredCPU = mT0Required.getCPU()  + mT1Required.getCPU() + mT2Required.getCPU();
-    QStandardItem *sumCPUR  = new QStandardItem(QString("%1").arg(sumRequiredCPU, 5, 'f', 2));
-    double sumRequiredDisk = mT0Required.getDisk()  + mT1Required.getDisk() + mT2Required.getDisk();
-    QStandardItem *sumDiskR = new QStandardItem(QString("%1").arg(sumRequiredDisk, 5, 'f', 2));
-    double sumRequiredTape = mT0Required.getTape()  + mT1Required.getTape() + mT2Required.getTape();
-    QStandardItem *sumTapeR = new QStandardItem(QString("%1").arg(sumRequiredTape, 5, 'f', 2));
-    sumCPUR->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumDiskR->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumTapeR->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-
-    mLastRow.insert(4, sumCPUR);
-    mLastRow.insert(5, sumDiskR);
-    mLastRow.insert(6, sumTapeR);
-
-    double sumPledgedCPU = mT0Pledged.getCPU()  + mT1Pledged.getCPU()  + mT2Pledged.getCPU();
-    QStandardItem *sumCPUP  = new QStandardItem(QString("%1").arg(sumPledgedCPU, 5, 'f', 2));
-    double sumPledgedDisk = mT0Pledged.getDisk()  + mT1Pledged.getDisk()  + mT2Pledged.getDisk();
-    QStandardItem *sumDiskP = new QStandardItem(QString("%1").arg(sumPledgedDisk, 5, 'f', 2));
-    double sumPledgedTape = mT0Pledged.getTape()  + mT1Pledged.getTape()  + mT2Pledged.getTape();
-    QStandardItem *sumTapeP = new QStandardItem(QString("%1").arg(sumPledgedTape, 5, 'f', 2));
-    sumCPUP->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumDiskP->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sumTapeP->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-
-
-    mLastRow.insert(7, sumCPUP);
-    mLastRow.insert(8, sumDiskP);
-    mLastRow.insert(9, sumTapeP);
-
-    double diff = 100 * ( sumPledgedCPU - sumRequiredCPU ) / sumRequiredCPU;
-    QStandardItem *sumCPUD  = new QStandardItem(QString("%1").arg(diff, 5, 'f', 2));
-    if (diff < -20)
-        sumCPUD->setForeground(QBrush(Qt::red));
-    else
-        sumCPUD->setForeground(QBrush(Qt::green));
-    sumCPUD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    diff = 100 * ( sumPledgedDisk - sumRequiredDisk ) / sumRequiredDisk;
-    QStandardItem *sumDiskD = new QStandardItem(QString("%1").arg(diff, 5, 'f', 2));
-    if (diff < -20)
-        sumDiskD->setForeground(QBrush(Qt::red));
-    else
-        sumDiskD->setForeground(QBrush(Qt::green));
-    diff = 100 * ( sumPledgedTape - sumRequiredTape ) / sumRequiredTape;
-    sumDiskD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    QStandardItem *sumTapeD = new QStandardItem(QString("%1").arg(diff, 5, 'f', 2));
-    if (diff < -20)
-        sumTapeD->setForeground(QBrush(Qt::red));
-    else
-        sumTapeD->setForeground(QBrush(Qt::green));
-    sumTapeD->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
-
-
-    mLastRow.insert(10, sumCPUD);
-    mLastRow.insert(11, sumDiskD);
-    mLastRow.insert(12, sumTapeD);
-
-
-    mModel->appendRow(mLastRow);
+//===========================================================================
+QFuture<QByteArray> ALICE::fetchRequirements(const QString &year) const
+{
+    // starts the download of the requirements of year
 
+    return fetchReport(QString("/data/%1/Requirements.csv").arg(year));
 }
 
 //===========================================================================
@@ -459,24 +380,28 @@ double ALICE::getPledged(Tier::TierCat tier, Resources::Resources_type restype,
     return rv;
 }
 
+//===========================================================================
+QFuture<double> ALICE::getPledgedAsync(Tier::TierCat tier, Resources::Resources_type restype, const QString &year)
+{
+    // getPledged as a future, to chain continuations to (see Async::then)
+    // the current year is checked and the value read in the ingestion thread, the only one changing them
+
+    QSharedPointer<double> value(new double(0.0));
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, QString("the pledges of %1").arg(year), [this, tier, restype, year, value]{
+        *value = getPledged(tier, restype, year);
+        return true;
+    });
+    return Async::then(IngestPipeline::instance().submit(QString("Reading the pledges of %1").arg(year), steps),
+                       [value](bool) { return *value; });
+}
+
 //===========================================================================
 QByteArray ALICE::getReportFromWeb(QString fileName)
 {
-    QNetworkRequest request;
-    QSslConfiguration conf = request.sslConfiguration();
-    conf.setPeerVerifyMode(QSslSocket::VerifyNone);
-    request.setSslConfiguration(conf);
-    QString url = fileName.prepend(dataURL());
-    request.setUrl(url);
-    if (!mNetworkManager)
-        mNetworkManager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = mNetworkManager->get(request);
-    QEventLoop loop;
-    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    return reply->readAll();
+    // download a report from the ALICE web site and wait for it, the download runs in the network thread
 
+    return fetchReport(fileName).result();
 }
 
 //===========================================================================
@@ -522,15 +447,30 @@ double ALICE::getRequired(Tier::TierCat tier, Resources::Resources_type restype,
     return rv;
 }
 
+//===========================================================================
+QFuture<double> ALICE::getRequiredAsync(Tier::TierCat tier, Resources::Resources_type restype, const QString &year)
+{
+    // getRequired as a future, to chain continuations to (see Async::then)
+    // the current year is checked and the value read in the ingestion thread, the only one changing them
+
+    QSharedPointer<double> value(new double(0.0));
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, QString("the requirements of %1").arg(year), [this, tier, restype, year, value]{
+        *value = getRequired(tier, restype, year);
+        return true;
+    });
+    return Async::then(IngestPipeline::instance().submit(QString("Reading the requirements of %1").arg(year), steps),
+                       [value](bool) { return *value; });
+}
+
 //===========================================================================
 double ALICE::getUsed(Tier::TierCat tier, Resources::Resources_type restype, const QDate date)
 {
     // retrieve required resources
 
-    static bool kReportExists;
     if (date != mCurrentUsedDate)
-        kReportExists = readMonthlyReport(date);
-    if (!kReportExists)
+        readMonthlyReport(date);
+    if (!mUsedFound)
         return -1;
     Resources res;
     switch (tier) {
@@ -567,15 +507,62 @@ double ALICE::getUsed(Tier::TierCat tier, Resources::Resources_type restype, con
     return rv;
 }
 
+//===========================================================================
+QFuture<double> ALICE::getUsedAsync(Tier::TierCat tier, Resources::Resources_type restype, const QDate &date)
+{
+    // getUsed as a future, to chain continuations to (see Async::then), -1 if the report is missing or the job cancelled
+    // the current month is checked and the value read in the ingestion thread, the only one changing them
+
+    QSharedPointer<double> value(new double(-1.0));
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, date.toString("MM.yyyy"), [this, tier, restype, date, value]{
+        *value = getUsed(tier, restype, date);
+        return true;
+    });
+    return Async::then(IngestPipeline::instance().submit(QString("Reading the usage of %1").arg(date.toString("MMMM yyyy")), steps),
+                       [value](bool) { return *value; });
+}
+
+//===========================================================================
+void ALICE::publish()
+{
+    // copies the funding agencies into a new snapshot and swaps it with the current one
+    // called by the thread changing them, the readers holding the previous snapshot keep it until they drop it
+
+    ModelSnapshotPtr next = std::make_shared<const ModelSnapshot>(mFAs, snapshot()->version() + 1);
+    std::atomic_store(&mSnapshot, next);
+    emit modelPublished(next->version());
+}
+
 //===========================================================================
 bool ALICE::readRebus(const QString &year)
 {
 //    Associate sites to Funding Agencies and collect the pledges
 
+    QFuture<QByteArray> rebus = fetchRebus(year);
     if (mFAs.isEmpty()) {
         readGlanceData(year);
         organizeFA();
     }
+    return parseRebus(year, rebus.result());
+}
+
+//===========================================================================
+QFuture<bool> ALICE::readRebusAsync(const QString &year)
+{
+    // readRebus as a job of the ingestion thread, the future ends with its result
+
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kParse, QString("REBUS of %1").arg(year), [this, year]{ return readRebus(year); });
+    return IngestPipeline::instance().submit(QString("Reading the pledges of %1").arg(year), steps);
+}
+
+//===========================================================================
+bool ALICE::parseRebus(const QString &year, QByteArray data)
+{
+    // the sites and pledges of year from the csv file of REBUS
+
+    TIMED_SCOPE("parse rebus");
 
     mT0Pledged.clear();
     mT1Pledged.clear();
@@ -586,8 +573,6 @@ bool ALICE::readRebus(const QString &year)
     mT2Pledged.setObjectName(QString("Pledged Resources at T2 in %1").arg(year));
     mToPledged.setObjectName(QString("Pledged Resources in total in %1").arg(year));
 
-    QString fileName = QString("/data/%1/pledges.csv").arg(year);
-    QByteArray data = getReportFromWeb(fileName);
     if (data.isEmpty())
         return false;
     QTextStream csvFile(&data);
@@ -626,13 +611,13 @@ bool ALICE::readRebus(const QString &year)
                 cat = Tier::kT2;
             else {
                 cat = Tier::kUnknown;
-                qWarning() << "Tier category" << strList.at(0) << "not recognized";
+                qCWarning(lcIngest) << "Tier category" << strList.at(0) << "not recognized";
             }
 
             FundingAgency *fa = searchFA(strList.at(1));
 
             if (!fa)
-                qDebug() << Q_FUNC_INFO << strList.at(1);
+                qCDebug(lcIngest) << Q_FUNC_INFO << strList.at(1);
 
             QString sCPU = strList.at(aliceColumn + diff);
             if (strList.at(4 + diff) == "HEP-SPEC06")
@@ -697,17 +682,43 @@ bool ALICE::readRebus(const QString &year)
     mToPledged.setDisk(mT0Pledged.getDisk() + mT1Pledged.getDisk() + mT2Pledged.getDisk());
     mToPledged.setTape(mT0Pledged.getTape() + mT1Pledged.getTape() + mT2Pledged.getTape());
 
-    if (MainWindow::isDebug()) {
+    // record the pledges of each funding agency in the ledger
+    for (FundingAgency *fa : mFAs) {
+        if (fa->name().left(1) == "-")
+            continue;
+        UsageLedger::Usage pledged;
+        pledged.value[UsageLedger::kCPU]    = fa->getPledgedCPU();
+        pledged.value[UsageLedger::kCPUML]  = fa->getPledgedCPU();
+        pledged.value[UsageLedger::kDiskML] = fa->getPledgedDisk();
+        pledged.value[UsageLedger::kTapeML] = fa->getPledgedTape();
+        mLedger.recordPledged(year.toInt(), fa->name(), pledged);
+    }
+    emit ledgerChanged(QDate());
+
+    if (lcIngest().isDebugEnabled()) {
         for (FundingAgency *fa : mFAs)
-            qInfo() << fa->list();
-        qInfo() <<  mT0Pledged.list();
-        qInfo() <<  mT1Pledged.list();
-        qInfo() <<  mT2Pledged.list();
+            qCDebug(lcIngest) << fa->list();
+        qCDebug(lcIngest) <<  mT0Pledged.list();
+        qCDebug(lcIngest) <<  mT1Pledged.list();
+        qCDebug(lcIngest) <<  mT2Pledged.list();
     }
+    publish();
     mCurrentPledgedYear = year;
     return true;
 }
 
+//===========================================================================
+void ALICE::initFAs()
+{
+    // the funding agencies and their sites are needed to share the used resources, they are taken from the latest data
+
+    if (mFAs.isEmpty()) {
+        readGlanceData(QString("%1").arg(QDate::currentDate().year())); // get the latest data
+        organizeFA();
+        readRebus(QString("%1").arg(QDate::currentDate().year())); // get the latest data
+    }
+}
+
 //===========================================================================
 void ALICE::initTableViewModel()
 {
@@ -721,6 +732,27 @@ void ALICE::initTableViewModel()
 
 //===========================================================================
 bool ALICE::readGlanceData(const QString &year)
+{
+    // read the M&O payers of year from glance
+
+    return parseGlanceData(fetchGlanceData(year).result());
+}
+
+//===========================================================================
+QFuture<bool> ALICE::readGlanceDataAsync(const QString &year)
+{
+    // readGlanceData as a job of the ingestion thread, the future ends with its result
+
+    QSharedPointer<QByteArray> data(new QByteArray);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("glance of %1").arg(year),
+                                  [this, year, data]{ *data = fetchGlanceData(year).result(); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "the M&O payers", [this, data]{ return parseGlanceData(*data); });
+    return IngestPipeline::instance().submit(QString("Reading the M&O payers of %1").arg(year), steps);
+}
+
+//===========================================================================
+bool ALICE::parseGlanceData(QByteArray dataA)
 {
     // read the csv file generated by glance:
     // 1. Membership -> Members
@@ -729,14 +761,14 @@ bool ALICE::readGlanceData(const QString &year)
     // 5. end date   > 31  Août      20xx
     // 6. export as csv
 
+    TIMED_SCOPE("parse glance");
+
     // check the available data per year
 
     mFAs.clear();
 
     const QString fa("Funding Agency");
 
-    QString fileName = QString("/data/%1/MandO.csv").arg(year);
-    QByteArray dataA = getReportFromWeb(fileName);
     if (dataA.isEmpty())
         return false;
     QTextStream csvFile(&dataA);
@@ -801,6 +833,27 @@ bool ALICE::readGlanceData(const QString &year)
 
 //===========================================================================
 bool ALICE::readRequirements(const QString &year)
+{
+    // reads the requirements of year
+
+    return parseRequirements(year, fetchRequirements(year).result());
+}
+
+//===========================================================================
+QFuture<bool> ALICE::readRequirementsAsync(const QString &year)
+{
+    // readRequirements as a job of the ingestion thread, the future ends with its result
+
+    QSharedPointer<QByteArray> data(new QByteArray);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("the requirements of %1").arg(year),
+                                  [this, year, data]{ *data = fetchRequirements(year).result(); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "the requirements", [this, year, data]{ return parseRequirements(year, *data); });
+    return IngestPipeline::instance().submit(QString("Reading the requirements of %1").arg(year), steps);
+}
+
+//===========================================================================
+bool ALICE::parseRequirements(const QString &year, QByteArray dataA)
 {
     // reads the requirements from a csv file
     // the csv file has to be produced by hand from an excell table:
@@ -809,6 +862,8 @@ bool ALICE::readRequirements(const QString &year)
     // T1           xxxx          xxxx         xxxx
     // T2           xxxx          xxxx         xxxx
 
+    TIMED_SCOPE("parse requirements");
+
     mT0Required.clear();
     mT1Required.clear();
     mT2Required.clear();
@@ -828,8 +883,6 @@ bool ALICE::readRequirements(const QString &year)
 
 
     // read the header row and find the column for CPU, Disk and Tape
-    QString fileName = QString("/data/%1/Requirements.csv").arg(year);
-    QByteArray dataA = getReportFromWeb(fileName);
     if (dataA.isEmpty())
         return false;
     QTextStream csvFile(&dataA);
@@ -871,7 +924,7 @@ bool ALICE::readRequirements(const QString &year)
         else if (strList.first() == toName)
             toRow = row;
         else {
-            qWarning() << "File " << fileName << " not found !";
+            qCWarning(lcIngest) << "Requirements of" << year << "not found !";
             return false;
         }
         row++;
@@ -949,6 +1002,7 @@ bool ALICE::readRequirements(const QString &year)
         }
         fa->setRequired(cpuR, diskR, tapeR);
     }
+    publish();
 
     mCurrentRequirementYear = year;
 
@@ -958,22 +1012,43 @@ bool ALICE::readRequirements(const QString &year)
 //===========================================================================
 bool ALICE::readMonthlyReport(const QDate &date)
 {
-    // read the montly report
+    // read the montly report, its four files are downloaded at the same time
 
-    if (mFAs.isEmpty()) {
-        readGlanceData(QString("%1").arg(QDate::currentDate().year())); // get the latest data
-        organizeFA();
-        readRebus(QString("%1").arg(QDate::currentDate().year())); // get the latest data
-    }
+    MonthlyUsage usage = readMonthlyUsage(date);
+    initFAs();
+    return mergeMonthlyUsage(usage);
+}
 
-    mT0Used.clear();
-    mT1Used.clear();
-    mT2Used.clear();
-    mToUsed.clear();
+//===========================================================================
+QFuture<bool> ALICE::readMonthlyReportAsync(const QDate &date)
+{
+    // readMonthlyReport as a job of the ingestion thread, the future ends with its result
+
+    QSharedPointer<QList<QByteArray> > reports(new QList<QByteArray>);
+    QSharedPointer<MonthlyUsage> usage(new MonthlyUsage);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("the report of %1").arg(date.toString("MM.yyyy")),
+                                  [this, date, reports]{ *reports = downloadMonthlyReport(date); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "the CPU, disk and tape usage",
+                                  [date, reports, usage]{ *usage = computeMonthlyUsage(date, *reports); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, date.toString("MM.yyyy"), [this, usage]{
+        initFAs();
+        return mergeMonthlyUsage(*usage);
+    });
+    return IngestPipeline::instance().submit(QString("Reading the report of %1").arg(date.toString("MMMM yyyy")), steps);
+}
+
+//===========================================================================
+ALICE::MonthlyUsage ALICE::computeMonthlyUsage(const QDate &date, QList<QByteArray> reports)
+{
+    // parses the four files of the monthly report of date (see fetchMonthlyReport)
+    // touches no state: the months of a profile are computed at the same time and merged in order by mergeMonthlyUsage
+
+    TIMED_SCOPE("monthly report: parse");
+
+    MonthlyUsage rv;
+    rv.date = date;
     qint32 hours = date.daysInMonth() * 24;
-    QString month = date.toString("MMMM");
-    QString year  = QString::number(date.year());
-    mCurrentUsedDate = date;
 
     // First read the monthly report provided by
     // EGI (http://accounting.egi.eu/egi.php) until 1/12/2016 and then from
@@ -985,11 +1060,9 @@ bool ALICE::readMonthlyReport(const QDate &date)
     // line 5: header TIER1,"alice","atlas","cms","lhcb",Total
     // last line      Total, xxxxx (HEPSPEC06-hours)
 
-    QString fileName = QString("/data/%1/%2/TIER1_TIER1_sum_normcpu_TIER1_VO.csv").arg(date.year()).arg(date.month());
-    QByteArray data = getReportFromWeb(fileName);
-    if (data.isEmpty())
-        return false;
-    QTextStream csvFile1(&data);
+    if (reports.at(0).isEmpty())
+        return rv;
+    QTextStream csvFile1(&reports[0]);
 
     // read header 4 lines for data collected before December 2016
     if (date < QDate(2016, 12, 1)) {
@@ -1009,11 +1082,8 @@ bool ALICE::readMonthlyReport(const QDate &date)
         }
         index++;
     }
-    if (aliceColumn == -1) // wrong or non-existant data in fileName
-        return false;
-
-    double cpuUSumT0 = 0.0;
-    double cpuUSumT1 = 0.0;
+    if (aliceColumn == -1) // wrong or non-existant data in the file
+        return rv;
 
     while(!csvFile1.atEnd()) {
         line = csvFile1.readLine();
@@ -1023,35 +1093,17 @@ bool ALICE::readMonthlyReport(const QDate &date)
             break;
         QString scpu  = strList.at(aliceColumn);
         double cpu = scpu.toDouble();
-        if (cpu != 0) {
-            Tier* tier = searchTier(site);
-            if (!tier) {
-                qWarning() << Q_FUNC_INFO << site << " not found!";
-                exit(1);
-            }
-            Resources res;
-            double rcpu = cpu / hours / 1000.;
-            res.setCPU(rcpu, Resources::kHEPSPEC06);
-            tier->setUsedCPU(month, res.getCPU());
-            if (site == "CH-CERN")
-                cpuUSumT0 += rcpu;
-            else
-                cpuUSumT1 += rcpu;
-        }
+        if (cpu != 0)
+            rv.t1CPU.append(qMakePair(site, cpu));
     }
 
-    mT0Used.setCPU(cpuUSumT0, Resources::kHEPSPEC06);
-    mT1Used.setCPU(cpuUSumT1, Resources::kHEPSPEC06);
-
     // format T2s from http://accounting.egi.eu/reptier2.php before 1/12/2016 and after from
     //                 https://accounting-next.egi.eu/wlcg/tier2/normcpu/FEDERATION/VO/2015/12/2016/12/lhc/onlyinfrajobs/
     // line 1-4: header to be skipped only before 1/12/2016
     // line 5: COUNTRY,FEDERATION,2016 CPU Pledge (HEPSPEC06),pledge inc. efficiency (HEPSPEC06-Hrs),SITE,alice,atlas,cms,lhcb,Total,delivered as % of pledge
-    fileName = QString(":/data/%1/%2/reptier2.csv").arg(date.year()).arg(date.month());
-    data = getReportFromWeb(fileName);
-    if (data.isEmpty())
-        return false;
-    QTextStream csvFile2(&data);
+    if (reports.at(1).isEmpty())
+        return rv;
+    QTextStream csvFile2(&reports[1]);
    // read header 4 lines before 1/12/2016
     qint32 federationIndex = 0;
     if (date < QDate(2016, 12, 1)) {
@@ -1073,46 +1125,17 @@ bool ALICE::readMonthlyReport(const QDate &date)
         index++;
     }
 
-    double cpuUSumT2 = 0.0;
-
     while(!csvFile2.atEnd()) {
         line = csvFile2.readLine();
         strList = line.split(',');
-        QString country = strList.at(0);
-        if (date >= QDate(2016, 12, 1)) {
-            country = country.left(2);
-            country = Naming::instance()->find(country);
-        }
-        if (country == "")
-            continue;
-        QString federation = strList.at(federationIndex);
-        if (federation.contains("Total"))
-            break;
-        QString scpu  = strList.at(aliceColumn);
-        double cpu = scpu.toDouble();
-        if (cpu != 0) {
-            FundingAgency *fa = searchFA(country);
-            if (!fa) {
-                qWarning() << "In" << date << country << "was not an ALICE member";
-                continue;
-            }
-            Tier *tier = fa->search(federation, true);
-            if (!tier) {
-                qWarning() << federation << " site not found!";
-                continue;
-            }
-            Resources res;
-            double rcpu = cpu / hours / 1000.;
-            res.setCPU(rcpu, Resources::kHEPSPEC06);
-            tier->setUsedCPU(month, res.getCPU());
-            cpuUSumT2 += rcpu;
-        }
+        MonthlyUsage::Federation federation;
+        federation.country = strList.at(0);
+        if (date >= QDate(2016, 12, 1))
+            federation.country = federation.country.left(2); // the country code, named by mergeMonthlyUsage
+        federation.name = strList.at(federationIndex);
+        federation.cpu  = strList.value(aliceColumn).toDouble();
+        rv.t2CPU.append(federation);
     }
-    mT2Used.setCPU(cpuUSumT2, Resources::kHEPSPEC06);
-    mToUsed.setCPU(cpuUSumT0 + cpuUSumT1 + cpuUSumT2, Resources::kHEPSPEC06);
-
-    for (FundingAgency * fa : mFAs)
-        fa->computeUsedCPU(month);
 
     // read the CPU usage delivered by MonALISA
     // get it from http://alimonitor.cern.ch/display?annotation.enabled=true&imgsize=1024x600&interval.max=0&interval.min=2628000000&page=jobResUsageSum_time_si2k&download_data_csv=true
@@ -1125,15 +1148,12 @@ bool ALICE::readMonthlyReport(const QDate &date)
     // TimeStamp, data (in GB)
     // take the average over time
 
-    fileName = QString(":/data/%1/%2/CPU_Usage.csv").arg(date.year()).arg(date.month());
-    data = getReportFromWeb(fileName);
-   if (data.isEmpty())
-        return false;
-    QTextStream csvFile3(&data);
+    if (reports.at(2).isEmpty())
+        return rv;
+    QTextStream csvFile3(&reports[2]);
     line = csvFile3.readLine();
     QStringList listCE = line.split(',');
     listCE.removeAt(0); // removes the Time column
-    QHash<QString, double> cpuUsage;
     qint32 linecount = 0;
     while (!csvFile3.atEnd()) {
         QString line = csvFile3.readLine();
@@ -1143,21 +1163,12 @@ bool ALICE::readMonthlyReport(const QDate &date)
             QString key = listCE.at(column);
             key.remove("\n");
             QString value = valuesList.at(column);
-            cpuUsage[key] += value.toDouble();
+            rv.cpuML[key] += value.toDouble();
         }
         linecount++;
     }
-    QHashIterator<QString, double> cpuit(cpuUsage);
-    while (cpuit.hasNext()) {
-        cpuit.next();
-        cpuUsage[cpuit.key()] = cpuit.value() * 4.2 / hours / linecount / 10000; //units = KHEPSpec06; 4.2 converts KSI2K into HEPSpec06
-        FundingAgency *fa = searchCE(cpuit.key());
-        if (fa)
-            fa->addUsedCPU(month,cpuUsage[cpuit.key()]);
-        else if (MainWindow::isDebug())
-            qWarning() << "Ignore CE" << cpuit.key() << "providing" << cpuUsage[cpuit.key()] << "kHEPSpec06";
-    }
-
+    for (QHash<QString, double>::iterator it = rv.cpuML.begin(); it != rv.cpuML.end(); ++it)
+        it.value() = it.value() * 4.2 / hours / linecount / 10000; //units = KHEPSpec06; 4.2 converts KSI2K into HEPSpec06
 
     // read the disk usage delivered by MonALISA
     // get it from: http://alimonitor.cern.ch/display?imgsize=1024x600&interval.max=27630000000&interval.min=30301200000&job_stats.owner=brijesh&modules=SE%2Fhist_used&page=SE%2Fhist&download_data_csv=true
@@ -1168,19 +1179,14 @@ bool ALICE::readMonthlyReport(const QDate &date)
     // header: Time ALICE::xxxx::yy ....
     // where xxxx is the name of the SE and yy is either SE, TAPE, etc..
     // TimeStamp, data (in GB)
-    // take the average over time
+    // take the maximum over time
 
-
-    fileName = QString(":/data/%1/%2/Disk_Tape_Usage.csv").arg(date.year()).arg(date.month());
-    data = getReportFromWeb(fileName);
-    if (data.isEmpty())
-        return false;
-    QTextStream csvFile4(&data);
+    if (reports.at(3).isEmpty())
+        return rv;
+    QTextStream csvFile4(&reports[3]);
     line = csvFile4.readLine();
     QStringList listSE = line.split(',');
     listSE.removeAt(0); // removes the Time column
-    QHash<QString, double> diskUsage;
-    linecount = 0;
     while (!csvFile4.atEnd()) {
         QString line = csvFile4.readLine();
         QStringList valuesList = line.split(',');
@@ -1190,30 +1196,151 @@ bool ALICE::readMonthlyReport(const QDate &date)
             key.remove("\n");
             QString svalue = valuesList.at(column);
             double value = svalue.toDouble();
-            if ( value > diskUsage[key])
-                diskUsage[key] = value;
+            if ( value > rv.storage[key])
+                rv.storage[key] = value;
         }
-        linecount++;
     }
 
+    rv.found = true;
+    return rv;
+}
+
+//===========================================================================
+ALICE::MonthlyUsage ALICE::readMonthlyUsage(const QDate &date) const
+{
+    // downloads and parses the monthly report of date, can run in any thread
+
+    QList<QByteArray> reports = downloadMonthlyReport(date);
+    if (TaskScheduler::currentToken().isCancelled()) // the downloads were aborted
+        return MonthlyUsage();
+    return computeMonthlyUsage(date, reports);
+}
+
+//===========================================================================
+QList<QByteArray> ALICE::downloadMonthlyReport(const QDate &date) const
+{
+    // downloads the four files of the monthly report of date at the same time, can run in any thread
+
+    TIMED_SCOPE("monthly report: network");
+    QList<QByteArray> rv;
+    for (const QFuture<QByteArray> &future : fetchMonthlyReport(date))
+        rv.append(future.result());
+    return rv;
+}
+
+//===========================================================================
+bool ALICE::mergeMonthlyUsage(const MonthlyUsage &usage)
+{
+    // distributes the usage of a month among the funding agencies and their sites, the months are merged one at a time
+
+    TIMED_SCOPE("monthly report: merge");
+
+    const QDate &date = usage.date;
+    mT0Used.clear();
+    mT1Used.clear();
+    mT2Used.clear();
+    mToUsed.clear();
+    qint32 hours = date.daysInMonth() * 24;
+    QString month = date.toString("MMMM yyyy"); // the key of the used resources in FundingAgency and Tier
+    mCurrentUsedDate = date;
+    mUsedFound = usage.found;
+
+    if (!mUsedFound)
+        return false;
+
+    // the T0 and T1s from EGI
+
+    double cpuUSumT0 = 0.0;
+    double cpuUSumT1 = 0.0;
+
+    for (const QPair<QString, double> &used : usage.t1CPU) {
+        const QString &site = used.first;
+        Tier* tier = searchTier(site);
+        if (!tier) {
+            qCWarning(lcIngest) << Q_FUNC_INFO << site << " not found!";
+            exit(1);
+        }
+        Resources res;
+        double rcpu = used.second / hours / 1000.;
+        res.setCPU(rcpu, Resources::kHEPSPEC06);
+        tier->setUsedCPU(month, res.getCPU());
+        if (site == "CH-CERN")
+            cpuUSumT0 += rcpu;
+        else
+            cpuUSumT1 += rcpu;
+    }
+
+    mT0Used.setCPU(cpuUSumT0, Resources::kHEPSPEC06);
+    mT1Used.setCPU(cpuUSumT1, Resources::kHEPSPEC06);
+
+    // the T2s from EGI
+
+    double cpuUSumT2 = 0.0;
+
+    for (const MonthlyUsage::Federation &federation : usage.t2CPU) {
+        QString country = federation.country;
+        if (date >= QDate(2016, 12, 1))
+            country = Naming::instance()->find(country);
+        if (country == "")
+            continue;
+        if (federation.name.contains("Total"))
+            break;
+        if (federation.cpu != 0) {
+            FundingAgency *fa = searchFA(country);
+            if (!fa) {
+                qCWarning(lcIngest) << "In" << date << country << "was not an ALICE member";
+                continue;
+            }
+            Tier *tier = fa->search(federation.name, true);
+            if (!tier) {
+                qCWarning(lcIngest) << federation.name << " site not found!";
+                continue;
+            }
+            Resources res;
+            double rcpu = federation.cpu / hours / 1000.;
+            res.setCPU(rcpu, Resources::kHEPSPEC06);
+            tier->setUsedCPU(month, res.getCPU());
+            cpuUSumT2 += rcpu;
+        }
+    }
+    mT2Used.setCPU(cpuUSumT2, Resources::kHEPSPEC06);
+    mToUsed.setCPU(cpuUSumT0 + cpuUSumT1 + cpuUSumT2, Resources::kHEPSPEC06);
+
+    for (FundingAgency * fa : mFAs)
+        fa->computeUsedCPU(month);
+
+    // the CPU from MonALISA
+
+    QHashIterator<QString, double> cpuit(usage.cpuML);
+    while (cpuit.hasNext()) {
+        cpuit.next();
+        FundingAgency *fa = searchCE(cpuit.key());
+        if (fa)
+            fa->addUsedCPU(month, cpuit.value());
+        else
+            qCDebug(lcIngest) << "Ignore CE" << cpuit.key() << "providing" << cpuit.value() << "kHEPSpec06";
+    }
+
+    // the disk and tape from MonALISA
+
     double tapeUSumT0 = 0.0;
     double tapeUSumT1 = 0.0;
     double diskUSumT0 = 0.0;
     double diskUSumT1 = 0.0;
     double diskUSumT2 = 0.0;
 
-    QHashIterator<QString, double> stoit(diskUsage);
+    QHashIterator<QString, double> stoit(usage.storage);
     while (stoit.hasNext()) {
         stoit.next();
         FundingAgency *fa = searchSE(stoit.key());
 
         if (!fa) {
-            qCritical() << Q_FUNC_INFO << "FA for " << stoit.key() << "not found";
+            qCCritical(lcIngest) << Q_FUNC_INFO << "FA for " << stoit.key() << "not found";
             exit(1);
         }
 
         QString se = stoit.key();
-        double storage = diskUsage[se] / 1000000;
+        double storage = stoit.value() / 1000000;
 
 
         Resources::Resources_type diskOrTape = fa->addUsedDiskTape(month, se, storage);
@@ -1222,7 +1349,7 @@ bool ALICE::readMonthlyReport(const QDate &date)
 
 
                 tapeUSumT0 += storage;
-                qDebug() << Q_FUNC_INFO << se << storage << tapeUSumT0;
+                qCDebug(lcIngest) << Q_FUNC_INFO << se << storage << tapeUSumT0;
             }
             else if (!se.contains("ALICE::CERN::CASTOR2"))
                 tapeUSumT1 += storage;
@@ -1252,76 +1379,54 @@ bool ALICE::readMonthlyReport(const QDate &date)
     mToUsed.setTape(tapeUSumT0 + tapeUSumT1, Resources::PB);
 
 
-    if (!mDrawTable)
-        return true;
+    // record the usage of each funding agency in the ledger
 
-    // complete the table
-    double cpuUSum    = 0.0;
-    double cpuUSumML  = 0.0;
-    double diskUSumML = 0.0;
-    double tapeUSumML = 0.0;
-
-    QList<QStandardItem*> lcpuUColumn;
-    QList<QStandardItem*> lcpuUColumnML;
-    QList<QStandardItem*> ldiskUColumnML;
-    QList<QStandardItem*> ltapeUColumnML;
     for (FundingAgency *fa : mFAs) {
         if (fa->name().left(1) == "-")
             continue;
-        double cpuU  = fa->getUsedCPU(month);
-        cpuUSum += cpuU;
-        double cpuUML  = fa->getUsedCPUML(month);
-        cpuUSumML += cpuUML;
-        double diskUML = fa->getUsedDiskML(month);
-        diskUSumML += diskUML;
-        double tapeUML = fa->getUsedTapeML(month);
-        tapeUSumML += tapeUML;
-        QStandardItem *cpuSIU    = new QStandardItem(QString("%1").arg(cpuU,    5, 'f', 2));
-        QStandardItem *cpuSIUML  = new QStandardItem(QString("%1").arg(cpuUML,  5, 'f', 2));
-        QStandardItem *diskSIUML = new QStandardItem(QString("%1").arg(diskUML, 5, 'f', 2));
-        QStandardItem *tapeSIUML = new QStandardItem(QString("%1").arg(tapeUML, 5, 'f', 2));
-        lcpuUColumn.append(cpuSIU);
-        lcpuUColumnML.append(cpuSIUML);
-        ldiskUColumnML.append(diskSIUML);
-        ltapeUColumnML.append(tapeSIUML);
+        UsageLedger::Usage usage;
+        usage.value[UsageLedger::kCPU]    = fa->getUsedCPU(month);
+        usage.value[UsageLedger::kCPUML]  = fa->getUsedCPUML(month);
+        usage.value[UsageLedger::kDiskML] = fa->getUsedDiskML(month);
+        usage.value[UsageLedger::kTapeML] = fa->getUsedTapeML(month);
+        mLedger.record(date, fa->name(), usage);
     }
+    emit ledgerChanged(date);
 
-    mToUsed.setCPU(cpuUSum);
-    mToUsed.setDisk(diskUSumML);
-    mToUsed.setTape(tapeUSumML);
-
-    QStandardItem *totalcpuSIU  = new QStandardItem(QString("%1").arg(cpuUSum,  5, 'f', 2));
-    lcpuUColumn.append(totalcpuSIU);
-    mModel->appendColumn(lcpuUColumn);
-    QString header = QString("%1 %2 \n Used CPU (kHEPSPEC06)").arg(month).arg(year);
-    mModel->setHorizontalHeaderItem(mModel->columnCount() -1, new QStandardItem(header));
-
-    QStandardItem *totalcpuSIUML  = new QStandardItem(QString("%1").arg(cpuUSumML,  5, 'f', 2));
-    lcpuUColumnML.append(totalcpuSIUML);
-    mModel->appendColumn(lcpuUColumnML);
-    header = QString("%1 %2 \n ML Used CPU (kHEPSPEC06)").arg(month).arg(year);
-    mModel->setHorizontalHeaderItem(mModel->columnCount() -1, new QStandardItem(header));
+    if (!mDrawTable)
+        return true;
 
-    QStandardItem *totaldiskSIUML  = new QStandardItem(QString("%1").arg(diskUSumML,  5, 'f', 2));
-    ldiskUColumnML.append(totaldiskSIUML);
-    mModel->appendColumn(ldiskUColumnML);
-    header = QString("%1 %2\n ML Used Disk (PB)").arg(month).arg(year);
-    mModel->setHorizontalHeaderItem(mModel->columnCount() - 1, new QStandardItem(header));
+    // complete the table
 
-    QStandardItem *totaltapeSIUML  = new QStandardItem(QString("%1").arg(tapeUSumML,  5, 'f', 2));
-    ltapeUColumnML.append(totaltapeSIUML);
-    mModel->appendColumn(ltapeUColumnML);
-    header = QString("%1 %2 \n ML Used Tape (PB)").arg(month).arg(year);
-    mModel->setHorizontalHeaderItem(mModel->columnCount() - 1, new QStandardItem(header));
+    mToUsed.setCPU(mLedger.total(date, UsageLedger::kCPU));
+    mToUsed.setDisk(mLedger.total(date, UsageLedger::kDiskML));
+    mToUsed.setTape(mLedger.total(date, UsageLedger::kTapeML));
 
+    emit monthRead(date); // the model lives in the GUI thread
 
     return true;
 }
 
+//===========================================================================
+void ALICE::reduceMonthlyUsage(UsageProfile &profile, const MonthlyUsage &usage)
+{
+    // merges a month computed by the task scheduler and adds its used resources to profile
+
+    if (!mergeMonthlyUsage(usage))
+        return;
+    QVector<Resources> used(Tier::kTOTS + 1);
+    used[Tier::kT0]   = mT0Used;
+    used[Tier::kT1]   = mT1Used;
+    used[Tier::kT2]   = mT2Used;
+    used[Tier::kTOTS] = mToUsed;
+    profile.insert(usage.date, used);
+}
+
 //===========================================================================
 Tier *ALICE::search(const QString &name)
 {
     // search CE or SE within FAs.
+    ALLOC_SCOPE(AllocStats::kLookup);
     if (mFAs.isEmpty()){
         readGlanceData("2017");
         organizeFA();
@@ -1340,49 +1445,12 @@ Tier *ALICE::search(const QString &name)
 
 }
 
-//===========================================================================
-void ALICE::saveCSV(const QString &year) const
-{
-    // save the table in a csv file
-    QString textData;
-    int rows = mModel->rowCount();
-    int columns = mModel->columnCount();
-
-    for (int j = 0; j < columns; j++) {
-        textData += mModel->headerData(j, Qt::Horizontal, Qt::DisplayRole).toString();
-        textData += ", " ;     // for .csv file format
-    }
-    textData += "\n";             // (optional: for new line segmentation)
-
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < columns; j++) {
-                textData += mModel->data(mModel->index(i,j)).toString();
-                textData += ", " ;     // for .csv file format
-        }
-        textData += "\n";             // (optional: for new line segmentation)
-    }
-
-    // [Save to file] (header file <QFile> needed)
-    // .csv
-
-    QString dir = QStandardPaths::displayName(QStandardPaths::DesktopLocation);
-    dir.prepend(QDir::separator());
-    dir.prepend(QDir::homePath());
-
-    QFile csvFile(QString("%1/PleAndReq%2.csv").arg(dir, year));
-    if(csvFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-
-        QTextStream out(&csvFile);
-        out << textData;
-
-        csvFile.close();
-    }
-}
 
 //===========================================================================
 FundingAgency *ALICE::searchCE(const QString &ce) const
 {
     // searches to which FA belongs the storage ce
+    ALLOC_SCOPE(AllocStats::kLookup);
     for (FundingAgency *fa : mFAs) {
         if (fa->name().left(1) == "-") // skip FAs included in a cluster
             continue;
@@ -1398,26 +1466,16 @@ FundingAgency *ALICE::searchCE(const QString &ce) const
 FundingAgency *ALICE::searchFA(const QString &n) const
 {
     // searches funding agency by name
+    ALLOC_SCOPE(AllocStats::kLookup);
 
-    QString name(n);
-
-    // treat special cases
-    if (name == "Switzerland")
-        name = "CERN";
-    else if (name == "Russian Federation")
-        name = "Russia";
-    else if (name == "UK")
-        name = "UnitedKingdom-STFC";
-    else if (name == "Latin America")
-        name = "Brazil";
+    QString name = ModelSnapshot::canonicalName(n); // treat special cases
     for (FundingAgency *fa : mFAs) {
         if (fa->name().contains(name) && fa->name().left(1) != "-") {
            return fa;
            break;
         }
     }
-    if (MainWindow::isDebug())
-         qWarning() << QString("FA %1 not found").arg(name);
+    qCDebug(lcNaming) << QString("FA %1 not found").arg(name);
     return Q_NULLPTR;
 }
 
@@ -1425,6 +1483,7 @@ FundingAgency *ALICE::searchFA(const QString &n) const
 FundingAgency *ALICE::searchSE(const QString &se) const
 {
     // searches to which FA belongs the storage se
+    ALLOC_SCOPE(AllocStats::kLookup);
     for (FundingAgency *fa : mFAs) {
         if (fa->name().left(1) == "-") // skip FAs included in a cluster
             continue;
@@ -1439,6 +1498,7 @@ FundingAgency *ALICE::searchSE(const QString &se) const
 Tier *ALICE::searchTier(const QString &n)
 {
     // search a Tier by name in the list of FAs
+    ALLOC_SCOPE(AllocStats::kLookup);
 
     Tier * rv = Q_NULLPTR;
     for (FundingAgency *fa : mFAs) {
@@ -1452,6 +1512,31 @@ Tier *ALICE::searchTier(const QString &n)
     return rv;
 }
 
+//===========================================================================
+ALICE::UsageProfile ALICE::usageProfile(const QList<QDate> &months)
+{
+    // the resources used during months: the monthly reports are downloaded and parsed by the task scheduler
+    // while the months already parsed are merged into the funding agencies, one at a time and in date order
+    // the tasks are as urgent as the job asking for the profile
+    // a month without report is missing from the profile, the profile is incomplete if the load is cancelled
+
+    initFAs();
+    ProgressModel::instance().add(ProgressModel::kMonths, 0, months.size());
+    QList<QFuture<MonthlyUsage> > computed;
+    for (const QDate &date : months)
+        computed.append(TaskScheduler::instance().run(TaskScheduler::currentPriority(), TaskScheduler::currentOwner(),
+                                                      [this, date]{ return readMonthlyUsage(date); }));
+    UsageProfile rv;
+    CancelToken token = TaskScheduler::currentToken();
+    for (const QFuture<MonthlyUsage> &future : computed) {
+        MonthlyUsage usage = future.result(); // waited for even when cancelled, the tasks then end at once
+        if (!token.isCancelled())
+            reduceMonthlyUsage(rv, usage);
+        ProgressModel::instance().add(ProgressModel::kMonths, 1, 0);
+    }
+    return rv;
+}
+
 //===========================================================================
 void ALICE::setCEandSE()
 {
@@ -1464,7 +1549,7 @@ void ALICE::setCEandSE()
         QList<QString> tiers = Naming::instance()->find(fa->name(), "any",  Naming::kCEWLCG);
         for (QString t : tiers) {
             if (t.contains("T1"))
-                qDebug() <<fa->name() <<  t;
+                qCDebug(lcNaming) <<fa->name() <<  t;
         }
     }
 
@@ -1484,6 +1569,8 @@ void ALICE::organizeFA()
 {
     // organize FAs, clustering etc...
 
+    TIMED_SCOPE("organize funding agencies");
+
     // and for Brazil
     FundingAgency * brazil = new FundingAgency("*Brazil", FundingAgency::kNMS);
     brazil->addFA(searchFA("Brazil"));
@@ -1548,19 +1635,20 @@ void ALICE::organizeFA()
     usa->addFA(searchFA("USA-NSF"));
     mFAs.append(usa);
 
+    publish();
 }
 
 //===========================================================================
 ALICE::ALICE(QObject *parent) : QObject(parent),
-    mDrawTable(true),  mCurrentPledgedYear(""), mCurrentRequirementYear("")
+    mDrawTable(true),  mCurrentPledgedYear(""), mCurrentRequirementYear(""), mUsedFound(false),
+    mSnapshot(std::make_shared<const ModelSnapshot>())
 {
     // ctor
     setObjectName("The ALICE Collaboration");
-    mModel = new QStandardItemModel(this);
+    mModel = new FATableModel(&mLedger, this);
+    connect(this, &ALICE::monthRead, mModel, &FATableModel::addMonth);
     qDeleteAll(mFAs.begin(), mFAs.end());
     mFAs.clear();
-    qDeleteAll(mLastRow.begin(), mLastRow.end());
-    mLastRow.clear();
     mT0Pledged.clear();
     mT1Pledged.clear();
     mT2Pledged.clear();
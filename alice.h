@@ -6,76 +6,136 @@
 #define ALICE_H
 
 
+#include <memory>
+
 #include <QDate>
 #include <QDebug>
+#include <QFuture>
+#include <QHash>
 #include <QMap>
 #include <QObject>
-#include <QStandardItemModel>
+#include <QPair>
 
+#include "fatablemodel.h"
 #include "fundingagency.h"
+#include "modelsnapshot.h"
 #include "resources.h"
+#include "tableexporter.h"
 #include "tier.h"
+#include "usageledger.h"
 
-class QNetworkAccessManager;
 class ALICE : public QObject
 {
     Q_OBJECT
     Q_ENUMS (ListOptions)
-    Q_ENUMS (Column)
     Q_ENUMS (UserCat)
 
 
 public:
     enum ListOptions {kFA //to Funding Agencies and M&O payers
                      };
-    enum Column {kStatC, kFAC, kMOC, kConC};
-
     enum UserCat {kAliDaq, kAliProd, kAliTrain, kAliUsers};
+    typedef QVector<FATableModel::Row> Table; // the rows of the funding agencies table
+
+    struct MonthlyUsage {
+        MonthlyUsage() : found(false) {}
+        struct Federation {
+            QString country; // the country, or its code after 1/12/2016
+            QString name;    // the federation of T2s
+            double  cpu;     // HEPSPEC06-hours
+        };
+        QDate                          date;    // the month
+        bool                           found;   // false if a file of the report is missing or unreadable
+        QList<QPair<QString, double> > t1CPU;   // HEPSPEC06-hours per T0 and T1 site, from EGI
+        QList<Federation>              t2CPU;   // the T2 federations in the order of the EGI file
+        QHash<QString, double>         cpuML;   // kHEPSpec06 per CE, from MonALISA
+        QHash<QString, double>         storage; // GB per SE, the maximum over the month, from MonALISA
+    };
+    struct YearReports {
+        QByteArray glance;       // the M&O payers, from glance
+        QByteArray rebus;        // the sites and the pledges, from REBUS
+        QByteArray requirements; // the requirements
+    };
+    typedef QMap<QDate, QVector<Resources> > UsageProfile; // the used resources per month, indexed by Tier::TierCat up to kTOTS
 
     static ALICE &instance();
+    static ALICE *createScratch(); // an instance apart from the one of the views, for the benchmarks
+    ~ALICE() {;}
 
     void                 addCPU(Tier::TierCat cat, double cpu);
     void                 addDisk(Tier::TierCat cat, double disk);
     void                 addTape(Tier::TierCat cat, double tape);
+    void                 clear();
+    static MonthlyUsage  computeMonthlyUsage(const QDate &date, QList<QByteArray> reports);
     qint32               countMOPayers() const;
     QString              dataURL() const { return QString("http://alicecrm.web.cern.ch"); }
-    void                 doOffenders(const QString &year);
-    void                 doReqAndPle(const QString &year);
-    void                 drawOffendersTable();
-    void                 drawTable();
+    Table                doOffenders(const QString &year);
+    Table                doReqAndPle(const QString &year);
+    QList<QByteArray>    downloadMonthlyReport(const QDate &date) const;
+    YearReports          downloadYearReports(const QString &year) const;
+    bool                 exportTable(const QString &fileName, TableExporter::Format format, const QAbstractItemModel *view = 0) const;
+    QList<FundingAgency*> fundingAgencies() const { return mFAs; }
     double               getDiskBuffer() const { return 6.0; } // 6PB of disk buffer
-    QStandardItemModel   *getModel() { return mModel; }
+    FATableModel         *getModel() { return mModel; }
     double               getPledged(Tier::TierCat tier, Resources::Resources_type restype, const QString &year);
+    QFuture<double>      getPledgedAsync(Tier::TierCat tier, Resources::Resources_type restype, const QString &year);
     QByteArray           getReportFromWeb(QString fileName);
     double               getRequired(Tier::TierCat tier, Resources::Resources_type restype, const QString &year);
+    QFuture<double>      getRequiredAsync(Tier::TierCat tier, Resources::Resources_type restype, const QString &year);
     double               getUsed(Tier::TierCat tier, Resources::Resources_type restype, const QDate date);
+    QFuture<double>      getUsedAsync(Tier::TierCat tier, Resources::Resources_type restype, const QDate &date);
+    const UsageLedger    &ledger() const { return mLedger; }
+    void                 initFAs();
     void                 initTableViewModel();
     void                 listFA();
+    bool                 mergeMonthlyUsage(const MonthlyUsage &usage);
+    Table                offendersTable();
     void                 organizeFA();
+    bool                 parseGlanceData(QByteArray dataA);
+    bool                 parseRebus(const QString &year, QByteArray data);
+    bool                 parseRequirements(const QString &year, QByteArray dataA);
+    void                 parseYearReports(const QString &year, const YearReports &reports);
+    QFuture<bool>        readGlanceDataAsync(const QString &year);
+    QFuture<bool>        readRebusAsync(const QString &year);
     bool                 readRequirements(const QString &year);
+    QFuture<bool>        readRequirementsAsync(const QString &year);
     bool                 readMonthlyReport(const QDate &date);
+    QFuture<bool>        readMonthlyReportAsync(const QDate &date);
+    MonthlyUsage         readMonthlyUsage(const QDate &date) const;
+    Table                reqAndPleTable();
     Tier                 *search(const QString &name);
     FundingAgency        *searchCE(const QString &ce) const;
-    void                 saveCSV(const QString &year) const;
     FundingAgency        *searchFA(const QString &n) const;
     FundingAgency        *searchSE(const QString &se) const;
     Tier*                searchTier(const QString &n);
     void                 setCEandSE();
     void                 setDrawTable(bool val) { mDrawTable = val; }
+    ModelSnapshotPtr     snapshot() const { return std::atomic_load(&mSnapshot); } // never blocks, safe from any thread
+    UsageProfile         usageProfile(const QList<QDate> &months);
+
+signals:
+    void                 ledgerChanged(const QDate &month); // an invalid month when the pledges changed
+    void                 modelPublished(qint64 version);    // a new snapshot of the funding agencies is available
+    void                 monthRead(const QDate &month);     // a monthly report to be added to the table
 
 private:
     ALICE(QObject *parent = 0);
-    ~ALICE() {;}// mLastRow.clear(); }
-    ALICE(const ALICE&): QObject() {}
-    qint32 countMOPayersT() const;
-    bool   readGlanceData(const QString &year);
-    bool   readRebus(const QString &year);
+    Q_DISABLE_COPY(ALICE)
+    qint32                      countMOPayersT() const;
+    QFuture<QByteArray>         fetchGlanceData(const QString &year) const;
+    QList<QFuture<QByteArray> > fetchMonthlyReport(const QDate &date) const;
+    QFuture<QByteArray>         fetchRebus(const QString &year) const;
+    QFuture<QByteArray>         fetchReport(const QString &fileName) const;
+    QFuture<QByteArray>         fetchRequirements(const QString &year) const;
+    void                        publish();
+    bool                        readGlanceData(const QString &year);
+    bool                        readRebus(const QString &year);
+    void                        reduceMonthlyUsage(UsageProfile &profile, const MonthlyUsage &usage);
 
     bool                  mDrawTable;              // Controls if table should be drawn of not
-    static ALICE          mInstance;               // The unique instance of this object
     QList<FundingAgency*> mFAs;                    // List of funding agencies;
-    QList<QStandardItem*> mLastRow;                // The last row of the table for SUM
-    QStandardItemModel*   mModel;                  // The model for the table view
+    UsageLedger           mLedger;                 // The monthly used resources per funding agency
+    FATableModel*         mModel;                  // The model for the table view
     Resources             mT0Pledged;              // The resources pledged at T0 in a given year
     Resources             mT1Pledged;              // The resources pledged at T1 in a given year
     Resources             mT2Pledged;              // The resources pledged at T2 in a given year
@@ -83,7 +143,7 @@ private:
     QString               mCurrentPledgedYear;     // the current year for the pledges
     QString               mCurrentRequirementYear; // the current year for the requirements
     QDate                 mCurrentUsedDate;        // the current date for the requirements
-    QNetworkAccessManager *mNetworkManager;        // The network manager
+    bool                  mUsedFound;              // the monthly report of mCurrentUsedDate was found
     Resources             mT0Required;             // The resources required at T0 in a given year
     Resources             mT1Required;             // The resources required at T1 in a given year
     Resources             mT2Required;             // The resources required at T2 in a given year
@@ -92,6 +152,7 @@ private:
     Resources             mT1Used;                 // The resources required at T1 in a given year
     Resources             mT2Used;                 // The resources required at T2 in a given year
     Resources             mToUsed;                 // The smoothed resources required in total in a given year
+    ModelSnapshotPtr      mSnapshot;               // The funding agencies as last published, only accessed atomically
 };
 
 #endif // ALICE_H
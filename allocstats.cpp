@@ -0,0 +1,369 @@
+// Counts the heap allocations per subsystem (ingest, lookup, table build, plot build) and the live objects of the model
+// built with CONFIG += alloc_stats only: the global operator new and delete are replaced to count the allocations,
+// the frees and the bytes of the subsystem whose AllocStats::Scope is open in the allocating thread, the rest goes to kOther
+// each block carries a small header with its size and its subsystem, so that a free is charged where the block was made
+// the replacement reaches the Qt libraries on Linux and macOS, not on Windows where each DLL keeps its own operator new
+// the buffers of the Qt containers are allocated with malloc inside Qt: with glibc malloc and its family are replaced
+// as well and they are counted, elsewhere they are not and the report says so
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <QStringList>
+
+#include "allocstats.h"
+
+#if defined(ALLOC_STATS) && defined(Q_OS_WIN)
+#undef ALLOC_STATS // see above
+#endif
+
+namespace {
+struct Counters {
+    std::atomic<qint64> allocations; // the blocks allocated
+    std::atomic<qint64> frees;       // the blocks of the tag freed
+    std::atomic<qint64> bytes;       // the bytes allocated
+    std::atomic<qint64> live;        // the bytes allocated and not yet freed
+    std::atomic<qint64> peak;        // the maximum of live
+};
+
+Counters                       gCounters[AllocStats::kNTags]; // zero initialised before any allocation
+thread_local AllocStats::Tag   tTag         = AllocStats::kOther; // the subsystem of the current thread
+thread_local qint64            tAllocations = 0;                  // the allocations of the current thread
+}
+
+std::atomic<qint64> AllocStats::mLive[AllocStats::kNKinds];
+
+#ifdef ALLOC_STATS
+#if defined(__GLIBC__)
+#define ALLOC_STATS_MALLOC // malloc and its family are replaced too, see below
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+void  __libc_free(void *pointer);
+}
+#endif
+
+namespace {
+struct Header {
+    std::size_t size;   // the size asked
+    quint32     offset; // from the start of the block to the pointer returned
+    quint16     tag;    // the subsystem which allocated the block
+    quint16     magic;  // kMagic, tells the blocks of allocate() from those of the libc
+};
+const std::size_t kHeader = 16;     // the size of the header, keeps the alignment of malloc
+const quint16     kMagic  = 0xa11c;
+static_assert(sizeof(Header) <= kHeader, "the header does not fit");
+
+//===========================================================================
+inline Header *header(void *pointer)
+{
+    return reinterpret_cast<Header*>(static_cast<char*>(pointer) - kHeader);
+}
+
+//===========================================================================
+void *allocate(std::size_t size, std::size_t alignment = kHeader)
+{
+    // a block of size bytes aligned on alignment and counted in the subsystem of the thread, null if the memory is exhausted
+
+    std::size_t offset = alignment > kHeader ? alignment : kHeader;
+#ifdef ALLOC_STATS_MALLOC
+    void *block = offset == kHeader ? __libc_malloc(size + offset) : __libc_memalign(offset, size + offset);
+#else
+    if (offset != kHeader) // only operator new calls allocate() without the malloc family
+        return Q_NULLPTR;
+    void *block = std::malloc(size + offset);
+#endif
+    if (!block)
+        return Q_NULLPTR;
+    void *rv = static_cast<char*>(block) + offset;
+    Header *info = header(rv);
+    info->size   = size;
+    info->offset = quint32(offset);
+    info->tag    = quint16(tTag);
+    info->magic  = kMagic;
+
+    Counters &counters = gCounters[tTag];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(qint64(size), std::memory_order_relaxed);
+    qint64 live = counters.live.fetch_add(qint64(size), std::memory_order_relaxed) + qint64(size);
+    qint64 peak = counters.peak.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        ;
+    tAllocations++;
+    return rv;
+}
+
+//===========================================================================
+void release(void *pointer)
+{
+    // frees a block of allocate() and charges it to the subsystem which allocated it
+
+    if (!pointer)
+        return;
+    Header *info = header(pointer);
+#ifdef ALLOC_STATS_MALLOC
+    if (info->magic != kMagic) { // made by the libc before the replacement was in place
+        __libc_free(pointer);
+        return;
+    }
+#endif
+    Counters &counters = gCounters[info->tag];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.live.fetch_sub(qint64(info->size), std::memory_order_relaxed);
+    info->magic = 0;
+    void *block = static_cast<char*>(pointer) - info->offset;
+#ifdef ALLOC_STATS_MALLOC
+    __libc_free(block);
+#else
+    std::free(block);
+#endif
+}
+}
+
+//===========================================================================
+void *operator new(std::size_t size)
+{
+    void *rv = allocate(size);
+    if (!rv)
+        throw std::bad_alloc();
+    return rv;
+}
+
+//===========================================================================
+void *operator new[](std::size_t size)
+{
+    void *rv = allocate(size);
+    if (!rv)
+        throw std::bad_alloc();
+    return rv;
+}
+
+//===========================================================================
+void *operator new(std::size_t size, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    return allocate(size);
+}
+
+//===========================================================================
+void *operator new[](std::size_t size, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    return allocate(size);
+}
+
+//===========================================================================
+void operator delete(void *pointer) Q_DECL_NOTHROW
+{
+    release(pointer);
+}
+
+//===========================================================================
+void operator delete[](void *pointer) Q_DECL_NOTHROW
+{
+    release(pointer);
+}
+
+//===========================================================================
+void operator delete(void *pointer, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    release(pointer);
+}
+
+//===========================================================================
+void operator delete[](void *pointer, const std::nothrow_t &) Q_DECL_NOTHROW
+{
+    release(pointer);
+}
+
+//===========================================================================
+void operator delete(void *pointer, std::size_t) Q_DECL_NOTHROW
+{
+    // the sized forms of C++14, the size is in the header
+
+    release(pointer);
+}
+
+//===========================================================================
+void operator delete[](void *pointer, std::size_t) Q_DECL_NOTHROW
+{
+    release(pointer);
+}
+
+#ifdef ALLOC_STATS_MALLOC
+// the C allocator, used by the Qt containers for their buffers: the libc calls them through these symbols too,
+// so every form which allocates or frees a block is replaced, a block of allocate() must never reach the libc
+extern "C" {
+
+//===========================================================================
+void *malloc(std::size_t size)
+{
+    return allocate(size);
+}
+
+//===========================================================================
+void *calloc(std::size_t count, std::size_t size)
+{
+    if (size && count > std::size_t(-1) / size)
+        return Q_NULLPTR;
+    void *rv = allocate(count * size);
+    if (rv)
+        std::memset(rv, 0, count * size);
+    return rv;
+}
+
+//===========================================================================
+void *realloc(void *pointer, std::size_t size)
+{
+    // a new block and a copy, counted as an allocation and a free
+
+    if (!pointer)
+        return allocate(size);
+    if (header(pointer)->magic != kMagic)
+        return __libc_realloc(pointer, size);
+    if (!size) {
+        release(pointer);
+        return Q_NULLPTR;
+    }
+    void *rv = allocate(size);
+    if (!rv)
+        return Q_NULLPTR;
+    std::memcpy(rv, pointer, qMin(size, header(pointer)->size));
+    release(pointer);
+    return rv;
+}
+
+//===========================================================================
+void *reallocarray(void *pointer, std::size_t count, std::size_t size)
+{
+    if (size && count > std::size_t(-1) / size)
+        return Q_NULLPTR;
+    return realloc(pointer, count * size);
+}
+
+//===========================================================================
+void free(void *pointer)
+{
+    release(pointer);
+}
+
+//===========================================================================
+void *memalign(std::size_t alignment, std::size_t size)
+{
+    return allocate(size, alignment);
+}
+
+//===========================================================================
+void *aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    return allocate(size, alignment);
+}
+
+//===========================================================================
+int posix_memalign(void **pointer, std::size_t alignment, std::size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)))
+        return EINVAL;
+    void *rv = allocate(size, alignment);
+    if (!rv)
+        return ENOMEM;
+    *pointer = rv;
+    return 0;
+}
+
+//===========================================================================
+void *valloc(std::size_t size)
+{
+    return allocate(size, 4096);
+}
+
+//===========================================================================
+void *pvalloc(std::size_t size)
+{
+    return allocate((size + 4095) & ~std::size_t(4095), 4096);
+}
+
+//===========================================================================
+std::size_t malloc_usable_size(void *pointer)
+{
+    // the size asked, the blocks of the libc made before the replacement are not resized by their users
+
+    if (!pointer || header(pointer)->magic != kMagic)
+        return 0;
+    return header(pointer)->size;
+}
+}
+#endif // ALLOC_STATS_MALLOC
+#endif // ALLOC_STATS
+
+//===========================================================================
+AllocStats::Scope::Scope(Tag tag) :
+    mPrevious(tTag)
+{
+    // ctor
+
+    tTag = tag;
+}
+
+//===========================================================================
+AllocStats::Scope::~Scope()
+{
+    // dtor
+
+    tTag = mPrevious;
+}
+
+//===========================================================================
+bool AllocStats::enabled()
+{
+    // true in a build with CONFIG += alloc_stats
+
+#ifdef ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+//===========================================================================
+QString AllocStats::report()
+{
+    // the table of the allocations per subsystem and of the live objects
+
+    if (!enabled())
+        return QString("The allocations are counted in a build with CONFIG += alloc_stats (not on Windows)");
+
+    static const char *const kTags[]  = {"other", "ingest", "lookup", "table build", "plot build"};
+    static const char *const kKinds[] = {"FundingAgency", "Tier", "Resources", "table rows", "plot rows"};
+
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6").arg("subsystem", -14).arg("allocations", 12).arg("frees", 12)
+                                         .arg("MB", 10).arg("live MB", 10).arg("peak MB", 10);
+    for (qint32 tag = 0; tag < kNTags; tag++) {
+        const Counters &counters = gCounters[tag];
+        lines << QString("%1 %2 %3 %4 %5 %6").arg(kTags[tag], -14)
+                 .arg(counters.allocations.load(std::memory_order_relaxed), 12)
+                 .arg(counters.frees.load(std::memory_order_relaxed), 12)
+                 .arg(counters.bytes.load(std::memory_order_relaxed) / 1e6, 10, 'f', 2)
+                 .arg(counters.live.load(std::memory_order_relaxed) / 1e6, 10, 'f', 2)
+                 .arg(counters.peak.load(std::memory_order_relaxed) / 1e6, 10, 'f', 2);
+    }
+    lines << QString();
+    lines << QString("%1 %2").arg("live objects", -14).arg("count", 12);
+    for (qint32 kind = 0; kind < kNKinds; kind++)
+        lines << QString("%1 %2").arg(kKinds[kind], -14).arg(live(Kind(kind)), 12);
+#ifndef ALLOC_STATS_MALLOC
+    lines << QString();
+    lines << QString("malloc is not counted with this C library: the buffers of the Qt containers are missing");
+#endif
+    return lines.join('\n');
+}
+
+//===========================================================================
+qint64 AllocStats::threadAllocations()
+{
+    // the allocations made so far by the current thread, whatever the subsystem, 0 if they are not counted
+
+    return tAllocations;
+}
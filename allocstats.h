@@ -0,0 +1,67 @@
+// Counts the heap allocations per subsystem (ingest, lookup, table build, plot build) and the live objects of the model
+// built with CONFIG += alloc_stats only: the global operator new and delete, and with glibc malloc and free, are replaced
+// to count the allocations, the frees and the bytes of the subsystem whose AllocStats::Scope is open in the allocating
+// thread, the rest goes to kOther
+// the objects counted carry an ALLOC_LIVE member, the plot rows are counted by their owner
+// in a normal build the scopes and the members vanish and the counters stay at zero
+
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <atomic>
+
+#include <QString>
+
+class AllocStats
+{
+public:
+    enum Tag {kOther, kIngest, kLookup, kTable, kPlot, kNTags};
+    enum Kind {kFundingAgency, kTier, kResources, kTableRow, kPlotRow, kNKinds};
+
+    static bool    enabled();
+    static qint64  live(Kind kind) { return mLive[kind].load(std::memory_order_relaxed); }
+    static void    addLive(Kind kind, qint64 count) { mLive[kind].fetch_add(count, std::memory_order_relaxed); }
+    static QString report();
+    static qint64  threadAllocations();
+
+    class Scope
+    {
+    public:
+        // the allocations of the thread go to tag until the scope ends, the innermost scope wins
+
+        explicit Scope(Tag tag);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        Tag mPrevious; // restored at the end of the scope
+    };
+
+    template <Kind K>
+    class Live
+    {
+    public:
+        // a member counting the live instances of its owner
+
+        Live()             { addLive(K, 1); }
+        Live(const Live &) { addLive(K, 1); }
+        ~Live()            { addLive(K, -1); }
+        Live &operator=(const Live &) { return *this; }
+    };
+
+private:
+    static std::atomic<qint64> mLive[kNKinds]; // the live objects per kind
+};
+
+#ifdef ALLOC_STATS
+#define ALLOC_CONCAT2(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT2(a, b)
+#define ALLOC_SCOPE(tag) AllocStats::Scope ALLOC_CONCAT(allocScope, __LINE__)(tag)
+#define ALLOC_LIVE(kind) AllocStats::Live<kind> mAllocLive
+#else
+#define ALLOC_SCOPE(tag)
+#define ALLOC_LIVE(kind) static_assert(true, "the live objects are not counted")
+#endif
+
+#endif // ALLOCSTATS_H
@@ -0,0 +1,119 @@
+// Chains continuations to the futures of the loads, no thread is blocked waiting for them
+// then() returns at once; a dispatcher thread watches the future and, when it is finished, posts the continuation
+// to the TaskScheduler: it never runs on the thread waiting for the future then() returned, nor in the GUI thread
+// a continuation inherits the priority, the owner and the cancel token of the thread calling then(), a cancelled one is skipped
+// the continuations still waiting when the application quits are dropped, their futures end with a default value
+// singleton
+
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QMutexLocker>
+
+#include "async.h"
+
+//===========================================================================
+Async::Async(QObject *parent) : QObject(parent),
+    mContext(Q_NULLPTR), mStopped(false)
+{
+    // ctor
+    // the dispatcher thread lives as long as the application, it is stopped before the event loop ends
+
+    mThread.setObjectName("async");
+    mContext = new QObject;
+    mContext->moveToThread(&mThread);
+
+    connect(this, &Async::watchRequested, mContext, [this]{ attach(); }, Qt::QueuedConnection);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &Async::stop);
+
+    mThread.start();
+}
+
+//===========================================================================
+Async::~Async()
+{
+    // dtor
+
+    stop();
+}
+
+//===========================================================================
+void Async::attach()
+{
+    // runs in the dispatcher thread: a watcher per requested future, it hands the continuation over when the future is finished
+    // a future already finished is reported by its watcher as well
+
+    QList<Watch> requests;
+    {
+        QMutexLocker locker(&mMutex);
+        requests.swap(mRequests);
+    }
+    for (const Watch &request : requests) {
+        QFutureWatcher<void> *watcher = new QFutureWatcher<void>(mContext);
+        mWatchers.insert(watcher, request.ready);
+        connect(watcher, &QFutureWatcherBase::finished, mContext, [this, watcher]{
+            Ready ready = mWatchers.take(watcher);
+            watcher->deleteLater();
+            ready(true);
+        });
+        watcher->setFuture(request.future);
+    }
+}
+
+//===========================================================================
+Async &Async::instance()
+{
+    // created at first use, when the application object exists
+
+    static Async instance;
+    return instance;
+}
+
+//===========================================================================
+void Async::stop()
+{
+    // the continuations not yet posted are dropped, their futures end with a default value
+
+    {
+        QMutexLocker locker(&mMutex);
+        mStopped = true;
+    }
+    if (!mThread.isRunning())
+        return;
+    mThread.quit();
+    mThread.wait();
+
+    QList<Ready> dropped = mWatchers.values();
+    mWatchers.clear();
+    {
+        QMutexLocker locker(&mMutex);
+        for (const Watch &request : mRequests)
+            dropped.append(request.ready);
+        mRequests.clear();
+    }
+    for (const Ready &ready : dropped)
+        ready(false);
+
+    delete mContext;
+    mContext = Q_NULLPTR;
+}
+
+//===========================================================================
+void Async::watch(const QFuture<void> &future, Ready ready)
+{
+    // hands future over to the dispatcher thread, can be called from any thread
+    // once the application quits, ready is called at once to drop the continuation
+
+    {
+        QMutexLocker locker(&mMutex);
+        if (!mStopped) {
+            Watch request;
+            request.future = future;
+            request.ready  = ready;
+            mRequests.append(request);
+            locker.unlock();
+            emit watchRequested();
+            return;
+        }
+    }
+    ready(false);
+}
@@ -0,0 +1,91 @@
+// Chains continuations to the futures of the loads, no thread is blocked waiting for them
+// then() returns at once; a dispatcher thread watches the future and, when it is finished, posts the continuation
+// to the TaskScheduler: it never runs on the thread waiting for the future then() returned, nor in the GUI thread
+// a continuation inherits the priority, the owner and the cancel token of the thread calling then(), a cancelled one is skipped
+// the continuations still waiting when the application quits are dropped, their futures end with a default value
+// singleton
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include <functional>
+#include <utility>
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+#include "taskscheduler.h"
+
+template <typename T> class QFutureWatcher;
+class Async : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Async &instance();
+
+    template <typename T, typename F>
+    static auto   then(const QFuture<T> &future, F f) -> QFuture<decltype(f(std::declval<T>()))>;
+    void          stop();
+
+signals:
+    void          watchRequested();
+
+private:
+    typedef std::function<void(bool finished)> Ready; // posts the continuation, finished is false when it is dropped
+
+    struct Watch {
+        QFuture<void> future; // the future waited for
+        Ready         ready;  // called in the dispatcher thread once future is finished
+    };
+
+    Async(QObject *parent = 0);
+    ~Async();
+    void attach();
+    void watch(const QFuture<void> &future, Ready ready);
+
+    QObject                             *mContext;  // lives in mThread, the watchers live in its context
+    QMutex                              mMutex;     // protects mRequests and mStopped
+    QList<Watch>                        mRequests;  // the futures waiting for the dispatcher thread
+    bool                                mStopped;   // no more continuation once set
+    QThread                             mThread;    // the dispatcher thread
+    QHash<QFutureWatcher<void>*, Ready> mWatchers;  // the futures being watched, used in mThread only
+};
+
+//===========================================================================
+template <typename T, typename F>
+auto Async::then(const QFuture<T> &future, F f) -> QFuture<decltype(f(std::declval<T>()))>
+{
+    // runs f on the result of future once it is finished and returns the result of f as a future, then() can be chained
+    // f runs on a worker of the TaskScheduler, it should not wait for other futures but chain to them
+    // the result of a future ended empty (see Fetcher) is a default value
+
+    typedef decltype(f(std::declval<T>())) R;
+    QFutureInterface<R> promise;
+    promise.reportStarted();
+    TaskScheduler::Priority priority = TaskScheduler::currentPriority();
+    QObject *owner = TaskScheduler::currentOwner();
+    CancelToken token = TaskScheduler::currentToken();
+    instance().watch(future, [future, f, promise, priority, owner, token](bool finished) mutable {
+        if (!finished) {
+            promise.reportResult(R());
+            promise.reportFinished();
+            return;
+        }
+        TaskScheduler::instance().post(priority, owner, [future, f, promise]() mutable {
+            if (TaskScheduler::currentToken().isCancelled())
+                promise.reportResult(R());
+            else
+                promise.reportResult(f(future.resultCount() > 0 ? future.result() : T()));
+            promise.reportFinished();
+        }, token);
+    });
+    return promise.future();
+}
+
+#endif // ASYNC_H
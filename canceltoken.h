@@ -0,0 +1,23 @@
+// Shared flag telling the stages of a load (fetch, parse, aggregate) that the user cancelled it
+// copies share the same flag, the job owns one and its fetches and tasks carry copies of it
+
+#ifndef CANCELTOKEN_H
+#define CANCELTOKEN_H
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+
+class CancelToken
+{
+public:
+    CancelToken() : mCancelled(new QAtomicInt(0)) {}
+
+    void cancel() const            { mCancelled->storeRelease(1); }
+    bool isCancelled() const       { return mCancelled->loadAcquire() != 0; }
+    bool operator==(const CancelToken &other) const { return mCancelled == other.mCancelled; }
+
+private:
+    QSharedPointer<QAtomicInt> mCancelled; // set once, never reset
+};
+
+#endif // CANCELTOKEN_H
@@ -1,6 +1,7 @@
 // A console to be included in a mdi view
 // Y. Schutz November 2016 (Thanks Sacha)
 
+#include <QFontDatabase>
 #include <QPlainTextEdit>
 #include <QVBoxLayout>
 
@@ -13,7 +14,9 @@ ConsoleWidget::ConsoleWidget(QWidget *parent) : QWidget(parent)
 
     QVBoxLayout * vLayout = new QVBoxLayout();
     mTextEdit = new QPlainTextEdit();
+    mTextEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont)); // keeps the columns of the timing table aligned
 //    mTextEdit->setReadOnly(true);
+    mTextEdit->setMaximumBlockCount(kMaxLines); // the oldest lines go, the whole log is in the file of the logger
 
 
     vLayout->addWidget(mTextEdit);
@@ -25,7 +28,7 @@ ConsoleWidget::ConsoleWidget(QWidget *parent) : QWidget(parent)
 //===========================================================================
 void ConsoleWidget::setMessage(const QString &message)
 {
-    // writes out a message to the console
+    // writes out a message, or a batch of lines from the logger, to the console
 
     mTextEdit->appendPlainText(message);
 
@@ -19,6 +19,8 @@ public Q_SLOTS:
 
 
 private:
+    static const int kMaxLines = 10000; // the lines kept in the console
+
     QPlainTextEdit * mTextEdit;
 };
 
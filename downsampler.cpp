@@ -0,0 +1,109 @@
+// Reduces the number of points of a plotted series with the
+// Largest-Triangle-Three-Buckets algorithm (S. Steinarsson, 2013):
+// the first and last points are kept and from each bucket in between the point
+// making the largest triangle with its neighbours is selected
+
+#include <QApplication>
+#include <QDesktopWidget>
+#include <QWidget>
+#include <QtMath>
+
+#include "downsampler.h"
+
+//===========================================================================
+QVector<QPointF> Downsampler::downsample(const QVector<QPointF> &points, qint32 threshold)
+{
+    // the points selected by LTTB, the input if it is already small enough
+
+    if (threshold < 3 || points.size() <= threshold)
+        return points;
+    return select(points, indices(points, threshold));
+}
+
+//===========================================================================
+QVector<qint32> Downsampler::indices(const QVector<QPointF> &points, qint32 threshold)
+{
+    // the indices of the threshold points kept by LTTB, in increasing order
+    // points must be sorted in x; the indices can be applied to other series
+    // sharing the same x values (e.g. the layers of a stacked area plot)
+
+    qint32 size = points.size();
+    QVector<qint32> rv;
+    if (threshold < 3 || size <= threshold) {
+        rv.reserve(size);
+        for (qint32 index = 0; index < size; index++)
+            rv.append(index);
+        return rv;
+    }
+
+    rv.reserve(threshold);
+    rv.append(0);
+
+    // the buckets exclude the first and last points
+    double every = double(size - 2) / (threshold - 2);
+    qint32 a     = 0; // the point selected in the previous bucket
+
+    for (qint32 bucket = 0; bucket < threshold - 2; bucket++) {
+        // the average point of the next bucket
+        qint32 nextStart = qFloor((bucket + 1) * every) + 1;
+        qint32 nextEnd   = qMin(qFloor((bucket + 2) * every) + 1, size);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (qint32 index = nextStart; index < nextEnd; index++) {
+            avgX += points.at(index).x();
+            avgY += points.at(index).y();
+        }
+        qint32 nextCount = nextEnd - nextStart;
+        if (nextCount > 0) {
+            avgX /= nextCount;
+            avgY /= nextCount;
+        } else {
+            avgX = points.last().x();
+            avgY = points.last().y();
+        }
+
+        // the point of this bucket with the largest triangle
+        qint32 start = qFloor(bucket * every) + 1;
+        qint32 end   = qFloor((bucket + 1) * every) + 1;
+        double ax    = points.at(a).x();
+        double ay    = points.at(a).y();
+        double maxArea = -1.0;
+        qint32 selected = start;
+        for (qint32 index = start; index < end; index++) {
+            double area = qAbs((ax - avgX) * (points.at(index).y() - ay) -
+                               (ax - points.at(index).x()) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea  = area;
+                selected = index;
+            }
+        }
+        rv.append(selected);
+        a = selected;
+    }
+
+    rv.append(size - 1);
+    return rv;
+}
+
+//===========================================================================
+QVector<QPointF> Downsampler::select(const QVector<QPointF> &points, const QVector<qint32> &indices)
+{
+    // the points at indices
+
+    QVector<QPointF> rv;
+    rv.reserve(indices.size());
+    for (qint32 index : indices)
+        rv.append(points.at(index));
+    return rv;
+}
+
+//===========================================================================
+qint32 Downsampler::threshold(const QWidget *view)
+{
+    // one point per device pixel of the screen showing view:
+    // the chart can be resized up to that width without losing any visible detail
+
+    QRect screen = QApplication::desktop()->screenGeometry(view);
+    qreal ratio  = view ? view->devicePixelRatioF() : qApp->devicePixelRatio();
+    return qMax(qRound(screen.width() * ratio), 100);
+}
@@ -0,0 +1,26 @@
+// Reduces the number of points of a plotted series with the
+// Largest-Triangle-Three-Buckets algorithm (S. Steinarsson, 2013):
+// the first and last points are kept and from each bucket in between the point
+// making the largest triangle with its neighbours is selected
+
+#ifndef DOWNSAMPLER_H
+#define DOWNSAMPLER_H
+
+#include <QPointF>
+#include <QVector>
+
+class QWidget;
+
+class Downsampler
+{
+public:
+    static QVector<QPointF> downsample(const QVector<QPointF> &points, qint32 threshold);
+    static QVector<qint32>  indices(const QVector<QPointF> &points, qint32 threshold);
+    static QVector<QPointF> select(const QVector<QPointF> &points, const QVector<qint32> &indices);
+    static qint32           threshold(const QWidget *view);
+
+private:
+    Downsampler() {;}
+};
+
+#endif // DOWNSAMPLER_H
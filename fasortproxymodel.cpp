@@ -0,0 +1,125 @@
+// Sort and filter proxy for the funding agencies tables
+// sorts on the raw values of FATableModel, keeps the Total row at the bottom
+// and filters the funding agencies on their status (MS/NMS)
+
+#include <QtMath>
+
+#include "fasortproxymodel.h"
+#include "fatablemodel.h"
+
+//===========================================================================
+FASortProxyModel::FASortProxyModel(QObject *parent) : QSortFilterProxyModel(parent),
+    mStatusFilter(kAll)
+{
+    // ctor
+    setSortRole(FATableModel::kRawRole);
+    setDynamicSortFilter(false);
+}
+
+//===========================================================================
+qint32 FASortProxyModel::compare(const QVariant &left, const QVariant &right) const
+{
+    // compares numbers as numbers and names as strings; undefined values come first
+
+    if (left.type() == QVariant::String || right.type() == QVariant::String)
+        return QString::localeAwareCompare(left.toString(), right.toString());
+
+    bool lok = left.isValid();
+    bool rok = right.isValid();
+    double l = left.toDouble();
+    double r = right.toDouble();
+    if (lok && qIsNaN(l))
+        lok = false;
+    if (rok && qIsNaN(r))
+        rok = false;
+    if (!lok || !rok)
+        return (lok ? 1 : 0) - (rok ? 1 : 0);
+    if (l < r)
+        return -1;
+    if (l > r)
+        return 1;
+    return 0;
+}
+
+//===========================================================================
+bool FASortProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    // filters on the status of the funding agency, the Total row is always shown
+
+    if (mStatusFilter == kAll)
+        return true;
+
+    QModelIndex index = sourceModel()->index(sourceRow, FATableModel::kStatC, sourceParent);
+    if (sourceModel()->data(index, FATableModel::kTotalRole).toBool())
+        return true;
+
+    QString status = sourceModel()->data(index, FATableModel::kRawRole).toString();
+    if (mStatusFilter == kMSOnly)
+        return status == "MS";
+    return status == "NMS";
+}
+
+//===========================================================================
+bool FASortProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    // compares the rows on the sort keys in turn, equal rows keep their order
+    // QSortFilterProxyModel swaps left and right for a descending sort, the keys
+    // with the opposite order of the primary one are swapped back
+
+    bool ltotal = sourceModel()->data(left, FATableModel::kTotalRole).toBool();
+    bool rtotal = sourceModel()->data(right, FATableModel::kTotalRole).toBool();
+    if (ltotal != rtotal)
+        return sortOrder() == Qt::DescendingOrder ? ltotal : rtotal;
+
+    if (mSortKeys.isEmpty())
+        return compare(sourceModel()->data(left, sortRole()), sourceModel()->data(right, sortRole())) < 0;
+
+    for (const QPair<int, Qt::SortOrder> &key : mSortKeys) {
+        QVariant lvalue = sourceModel()->data(left.sibling(left.row(), key.first), sortRole());
+        QVariant rvalue = sourceModel()->data(right.sibling(right.row(), key.first), sortRole());
+        qint32 rv = compare(lvalue, rvalue);
+        if (key.second != sortOrder())
+            rv = -rv;
+        if (rv != 0)
+            return rv < 0;
+    }
+    return false;
+}
+
+//===========================================================================
+void FASortProxyModel::setStatusFilter(StatusFilter filter)
+{
+    // shows all, only MS or only NMS funding agencies
+
+    if (filter == mStatusFilter)
+        return;
+    mStatusFilter = filter;
+    invalidateFilter();
+}
+
+//===========================================================================
+void FASortProxyModel::sortBy(int column, bool append)
+{
+    // sorts on column; with append the column becomes an additional key
+    // clicking again on a key column reverses its order
+
+    qint32 key = -1;
+    for (qint32 index = 0; index < mSortKeys.size(); index++)
+        if (mSortKeys.at(index).first == column)
+            key = index;
+
+    if (append) {
+        if (key == -1)
+            mSortKeys.append(qMakePair(column, Qt::DescendingOrder));
+        else
+            mSortKeys[key].second = mSortKeys.at(key).second == Qt::DescendingOrder ? Qt::AscendingOrder : Qt::DescendingOrder;
+    } else {
+        Qt::SortOrder order = Qt::DescendingOrder;
+        if (key == 0)
+            order = mSortKeys.first().second == Qt::DescendingOrder ? Qt::AscendingOrder : Qt::DescendingOrder;
+        mSortKeys.clear();
+        mSortKeys.append(qMakePair(column, order));
+    }
+
+    sort(mSortKeys.first().first, mSortKeys.first().second);
+}
@@ -0,0 +1,37 @@
+// Sort and filter proxy for the funding agencies tables
+// sorts on the raw values of FATableModel, keeps the Total row at the bottom
+// and filters the funding agencies on their status (MS/NMS)
+
+#ifndef FASORTPROXYMODEL_H
+#define FASORTPROXYMODEL_H
+
+#include <QList>
+#include <QPair>
+#include <QSortFilterProxyModel>
+
+class FASortProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    enum StatusFilter {kAll, kMSOnly, kNMSOnly};
+    Q_ENUM (StatusFilter)
+
+    explicit FASortProxyModel(QObject *parent = 0);
+
+    void         setStatusFilter(StatusFilter filter);
+    void         sortBy(int column, bool append = false);
+    StatusFilter statusFilter() const { return mStatusFilter; }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+private:
+    qint32 compare(const QVariant &left, const QVariant &right) const;
+
+    QList<QPair<int, Qt::SortOrder> > mSortKeys;     // the sort columns, primary first
+    StatusFilter                      mStatusFilter; // which funding agencies are shown
+};
+
+#endif // FASORTPROXYMODEL_H
@@ -0,0 +1,307 @@
+// Table model for the funding agencies tables: requirements and pledges (the big table)
+// and due resources (the offenders table).
+// The values are kept as numbers and formatted only when a view asks for them.
+
+#include <QBrush>
+#include <QSet>
+#include <QtMath>
+
+#include "fatablemodel.h"
+
+//===========================================================================
+FATableModel::FATableModel(const UsageLedger *ledger, QObject *parent) : QAbstractTableModel(parent),
+    mLedger(ledger), mType(kReqAndPle)
+{
+    // ctor
+}
+
+//===========================================================================
+void FATableModel::addMonth(const QDate &month)
+{
+    // append the four usage columns (WLCG CPU, ML CPU, ML disk, ML tape) of month
+    // the values stay in the ledger and are read only for the cells a view displays
+    // a month already in the table is refreshed in place
+
+    QDate key = UsageLedger::key(month);
+    for (qint32 index = 0; index < mMonths.size(); index++) {
+        if (mMonths.at(index).month == key) {
+            // the month is already shown, only its values may have changed in the ledger
+            qint32 first = fixedColumns() + index;
+            if (!mRows.isEmpty())
+                emit dataChanged(createIndex(0, first), createIndex(mRows.size() - 1, first + UsageLedger::kNQuantities - 1));
+            return;
+        }
+    }
+
+    qint32 first = columnCount();
+    beginInsertColumns(QModelIndex(), first, first + UsageLedger::kNQuantities - 1);
+    for (qint32 value = 0; value < UsageLedger::kNQuantities; value++) {
+        MonthColumn column;
+        column.month = UsageLedger::key(month);
+        column.value = static_cast<UsageLedger::Quantity>(value);
+        mMonths.append(column);
+    }
+    endInsertColumns();
+}
+
+//===========================================================================
+int FATableModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return fixedColumns() + mMonths.size();
+}
+
+//===========================================================================
+QVariant FATableModel::data(const QModelIndex &index, int role) const
+{
+    // formats the cell only when asked for by the view
+
+    if (!index.isValid() || index.row() >= mRows.size())
+        return QVariant();
+
+    const Row &row = mRows.at(index.row());
+    qint32 col     = index.column();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    {
+        switch (col) {
+        case kStatC:
+            return row.status;
+        case kFAC:
+            return row.name;
+        case kMOC:
+            return QString("%1").arg(row.payers);
+        case kConC:
+            if (row.total)
+                return QString("");
+            if (row.name == "CERN")
+                return QString("-");
+            return QString("%1").arg(row.contrib, 4, 'f', 2);
+        default:
+            break;
+        }
+        if (col < fixedColumns()) {
+            qint32 vcol  = col - kConC - 1;
+            double value = row.values.at(vcol);
+            if (mType == kReqAndPle && vcol >= 6 && !row.total) // the difference in %
+                return QString("%1").arg(value, 5, 'f', 0);
+            return QString("%1").arg(value, 5, 'f', 2);
+        }
+        double value = monthValue(row, mMonths.at(col - fixedColumns()));
+        return QString("%1").arg(value, 5, 'f', 2);
+    }
+    case kRawRole:
+    {
+        // the unformatted value, used for sorting and exporting
+        switch (col) {
+        case kStatC:
+            return row.status;
+        case kFAC:
+            return row.name;
+        case kMOC:
+            return row.payers;
+        case kConC:
+            if (row.total)
+                return QVariant();
+            return row.contrib;
+        default:
+            break;
+        }
+        if (col < fixedColumns())
+            return row.values.at(col - kConC - 1);
+        return monthValue(row, mMonths.at(col - fixedColumns()));
+    }
+    case kTotalRole:
+        return row.total;
+    case Qt::TextAlignmentRole:
+        if (row.total && col == kFAC)
+            return int(Qt::AlignHCenter | Qt::AlignVCenter);
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    case Qt::ForegroundRole:
+        if (mType == kReqAndPle && col >= kConC + 7 && col < fixedColumns()) {
+            if (row.values.at(col - kConC - 1) < -20)
+                return QBrush(Qt::red);
+            else
+                return QBrush(Qt::green);
+        }
+        break;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+//===========================================================================
+QVariant FATableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    // the horizontal headers
+
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case kStatC:
+        return tr("Status");
+    case kFAC:
+        return tr("Funding Agency");
+    case kMOC:
+        return tr("M&O Payers");
+    case kConC:
+        return tr("Contribution(%)");
+    default:
+        break;
+    }
+
+    if (section < fixedColumns()) {
+        static const char *reqAndPle[] = {
+            QT_TR_NOOP("Required CPU (kHEPSPEC06)"), QT_TR_NOOP("Required Disk (PB)"), QT_TR_NOOP("Required Tape (PB)"),
+            QT_TR_NOOP("Pledged CPU (kHEPSPEC06)"),  QT_TR_NOOP("Pledged Disk (PB)"),  QT_TR_NOOP("Pledged Tape (PB)"),
+            QT_TR_NOOP("Diff CPU (%)"),              QT_TR_NOOP("Diff Disk (%)"),      QT_TR_NOOP("Diff Tape (%)")};
+        static const char *offenders[] = {
+            QT_TR_NOOP("Due CPU (kHEPSPEC06)"), QT_TR_NOOP("Due Disk (PB)"), QT_TR_NOOP("Due Tape (PB)")};
+        qint32 vcol = section - kConC - 1;
+        if (mType == kReqAndPle)
+            return tr(reqAndPle[vcol]);
+        return tr(offenders[vcol]);
+    }
+
+    const MonthColumn &month = mMonths.at(section - fixedColumns());
+    QString name = month.month.toString("MMMM yyyy");
+    switch (month.value) {
+    case UsageLedger::kCPU:
+        return QString("%1 \n Used CPU (kHEPSPEC06)").arg(name);
+    case UsageLedger::kCPUML:
+        return QString("%1 \n ML Used CPU (kHEPSPEC06)").arg(name);
+    case UsageLedger::kDiskML:
+        return QString("%1\n ML Used Disk (PB)").arg(name);
+    case UsageLedger::kTapeML:
+        return QString("%1 \n ML Used Tape (PB)").arg(name);
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+//===========================================================================
+double FATableModel::monthValue(const Row &row, const MonthColumn &column) const
+{
+    // the used resources of the funding agency of row during the month of column
+    // the ledger keeps the sums, the total row costs one lookup as the others
+
+    if (!mLedger)
+        return 0.0;
+    if (row.total)
+        return mLedger->total(column.month, column.value);
+    return mLedger->value(column.month, row.name, column.value);
+}
+
+//===========================================================================
+int FATableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return mRows.size();
+}
+
+//===========================================================================
+QString FATableModel::rowKey(const Row &row)
+{
+    // rows are matched on the name of the funding agency, the total row on its flag
+
+    return row.total ? QString() : row.name;
+}
+
+//===========================================================================
+bool FATableModel::sameValue(double left, double right)
+{
+    // equal values, a difference computed with no requirement (NaN) stays unchanged
+
+    return left == right || (qIsNaN(left) && qIsNaN(right));
+}
+
+//===========================================================================
+void FATableModel::setTable(TableType type, const QVector<Row> &rows)
+{
+    // replaces the content of the table
+    // for a new layout the model is reset and the monthly columns are dropped,
+    // otherwise the rows are diffed on the funding agency name and only the
+    // removed, moved, inserted and changed rows and cells are signalled
+
+    if (type != mType || mRows.isEmpty()) {
+        beginResetModel();
+        mType = type;
+        mRows = rows;
+        mMonths.clear();
+        endResetModel();
+        return;
+    }
+
+    QSet<QString> keys;
+    for (const Row &row : rows)
+        keys.insert(rowKey(row));
+
+    // the rows that disappeared, removed by contiguous blocks from the bottom
+
+    qint32 last = mRows.size() - 1;
+    while (last >= 0) {
+        if (keys.contains(rowKey(mRows.at(last)))) {
+            last--;
+            continue;
+        }
+        qint32 first = last;
+        while (first > 0 && !keys.contains(rowKey(mRows.at(first - 1))))
+            first--;
+        beginRemoveRows(QModelIndex(), first, last);
+        mRows.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    // put the remaining rows in the new order, insert the new ones and
+    // signal the cells of the fixed columns that changed
+
+    for (qint32 index = 0; index < rows.size(); index++) {
+        const Row &row = rows.at(index);
+        QString key    = rowKey(row);
+        qint32 current = -1;
+        for (qint32 search = index; search < mRows.size() && current == -1; search++)
+            if (rowKey(mRows.at(search)) == key)
+                current = search;
+
+        if (current == -1) {
+            beginInsertRows(QModelIndex(), index, index);
+            mRows.insert(index, row);
+            endInsertRows();
+            continue;
+        }
+        if (current != index) {
+            beginMoveRows(QModelIndex(), current, current, QModelIndex(), index);
+            mRows.move(current, index);
+            endMoveRows();
+        }
+
+        Row &old = mRows[index];
+        QVector<bool> changed(fixedColumns(), false);
+        changed[kStatC] = old.status != row.status;
+        changed[kMOC]   = old.payers != row.payers;
+        changed[kConC]  = old.contrib != row.contrib;
+        for (qint32 vcol = 0; vcol < row.values.size(); vcol++)
+            changed[kConC + 1 + vcol] = vcol >= old.values.size() || !sameValue(old.values.at(vcol), row.values.at(vcol));
+        old = row;
+
+        qint32 col = 0;
+        while (col < changed.size()) {
+            if (!changed.at(col)) {
+                col++;
+                continue;
+            }
+            qint32 end = col;
+            while (end + 1 < changed.size() && changed.at(end + 1))
+                end++;
+            emit dataChanged(createIndex(index, col), createIndex(index, end));
+            col = end + 1;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// Table model for the funding agencies tables: requirements and pledges (the big table)
+// and due resources (the offenders table).
+// The values are kept as numbers and formatted only when a view asks for them.
+
+#ifndef FATABLEMODEL_H
+#define FATABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDate>
+#include <QVector>
+
+#include "allocstats.h"
+#include "usageledger.h"
+
+class FATableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum TableType {kReqAndPle, kOffenders};
+    enum Column {kStatC, kFAC, kMOC, kConC};
+    enum Role {kRawRole = Qt::UserRole, kTotalRole};
+
+    struct Row {
+        Row() : payers(0), contrib(0.0), total(false) {}
+        QString         status;  // MS or NMS
+        QString         name;    // name of the funding agency
+        qint32          payers;  // number of M&O payers
+        double          contrib; // required contribution in %
+        QVector<double> values;  // required, pledged and difference, or due resources
+        bool            total;   // true for the last row with the sums
+        ALLOC_LIVE(AllocStats::kTableRow);
+    };
+
+    explicit FATableModel(const UsageLedger *ledger, QObject *parent = 0);
+
+    void      addMonth(const QDate &month);
+    int       columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant  data(const QModelIndex &index, int role) const;
+    QVariant  headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    int       rowCount(const QModelIndex &parent = QModelIndex()) const;
+    void      setTable(TableType type, const QVector<Row> &rows);
+    TableType tableType() const { return mType; }
+
+private:
+    struct MonthColumn {
+        QDate                 month; // the month, the key of the used resources in the ledger
+        UsageLedger::Quantity value; // the used resource displayed in the column
+    };
+
+    qint32         fixedColumns() const { return kConC + 1 + valueColumns(); }
+    double         monthValue(const Row &row, const MonthColumn &column) const;
+    static QString rowKey(const Row &row);
+    static bool    sameValue(double left, double right);
+    qint32         valueColumns() const { return mType == kReqAndPle ? 9 : 3; }
+
+    const UsageLedger    *mLedger; // the used resources, read when a month cell is displayed
+    QVector<MonthColumn> mMonths;  // the monthly usage columns appended after the fixed ones
+    QVector<Row>         mRows;    // the rows of the table, the last one holds the sums
+    TableType            mType;    // the layout of the table
+};
+
+#endif // FATABLEMODEL_H
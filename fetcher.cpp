@@ -0,0 +1,303 @@
+// Downloads files in a network thread and returns their content as a QFuture
+// no event loop is spun by the caller: it waits for the result in a worker thread, after starting all the files of a load at once
+// the downloads run at the same time up to a limit per host, the most urgent first
+// the downloads of a cancelled load are aborted and their buffers freed, their futures end empty
+// with a base URL set, the requests to the data servers go to a stand-in server instead (see tools/standin)
+// the responses are recorded or replayed from a file when a NetworkSession is started
+// singleton
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSslConfiguration>
+#include <QStringList>
+#include <QTimer>
+
+#include "fetcher.h"
+#include "logger.h"
+#include "networksession.h"
+#include "progressmodel.h"
+#include "tracer.h"
+
+QUrl Fetcher::mBaseURL;
+
+//===========================================================================
+Fetcher::Fetcher(QObject *parent) : QObject(parent),
+    mContext(Q_NULLPTR), mLastReplay(0), mManager(Q_NULLPTR), mStopped(false)
+{
+    // ctor
+    // the network thread lives as long as the application, it is stopped before the event loop ends
+
+    mThread.setObjectName("network");
+    mContext = new QObject;
+    mContext->moveToThread(&mThread);
+
+    connect(this, &Fetcher::requested, mContext, [this]{ send(); }, Qt::QueuedConnection);
+    connect(this, &Fetcher::abortRequested, mContext, [this]{ abort(); }, Qt::QueuedConnection);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &Fetcher::stop);
+
+    mThread.start();
+}
+
+//===========================================================================
+Fetcher::~Fetcher()
+{
+    // dtor
+
+    stop();
+}
+
+//===========================================================================
+void Fetcher::abort()
+{
+    // runs in the network thread: aborts the downloads of the cancelled loads and drops their waiting requests
+
+    QList<QNetworkReply*> replies;
+    for (QHash<QNetworkReply*, Request>::const_iterator it = mInFlight.constBegin(); it != mInFlight.constEnd(); ++it)
+        if (it.value().token.isCancelled())
+            replies.append(it.key());
+    for (QNetworkReply *reply : replies)
+        reply->abort(); // finish() is called at once and the buffer is released
+
+    for (qint32 index = 0; index < mWaiting.size(); ) {
+        if (mWaiting.at(index).token.isCancelled()) {
+            Request request = mWaiting.takeAt(index);
+            request.promise.reportResult(QByteArray());
+            request.promise.reportFinished();
+            ProgressModel::instance().add(ProgressModel::kFiles, 1, 0);
+        } else
+            index++;
+    }
+    dispatch();
+}
+
+//===========================================================================
+void Fetcher::abortCancelled()
+{
+    // aborts the downloads of the loads whose token is cancelled, can be called from any thread
+
+    emit abortRequested();
+}
+
+//===========================================================================
+void Fetcher::deliver(Request &request, const QByteArray &data)
+{
+    // runs in the network thread: fulfils the promise of request with data and sends the next request of its host
+
+    if (request.traceId)
+        Tracer::instance().asyncEnd("fetch", request.traceId);
+    request.promise.reportResult(data);
+    request.promise.reportFinished();
+    ProgressModel::instance().add(ProgressModel::kFiles, 1, 0);
+    mHostLoad[request.url.host()]--;
+    dispatch();
+}
+
+//===========================================================================
+void Fetcher::dispatch()
+{
+    // runs in the network thread: sends the most urgent waiting requests whose host has room
+
+    for (qint32 priority = TaskScheduler::kVisible; priority < TaskScheduler::kNPriorities; priority++) {
+        for (qint32 index = 0; index < mWaiting.size(); ) {
+            const Request &request = mWaiting.at(index);
+            QString host = request.url.host();
+            if (request.priority != priority || mHostLoad.value(host) >= hostLimit(host)) {
+                index++;
+                continue;
+            }
+            Request sent = mWaiting.takeAt(index);
+            mHostLoad[host]++;
+            if (Tracer::enabled()) {
+                sent.traceId = Tracer::instance().nextId();
+                Tracer::instance().asyncBegin("fetch", sent.traceId, sent.url.toString());
+            }
+            sent.asked = NetworkSession::instance().now();
+
+            if (NetworkSession::instance().replaying()) { // served from the recording, after its latency if asked
+                QByteArray data;
+                qint64 latency = 0;
+                NetworkSession::instance().lookup(sent.url, data, latency);
+                ProgressModel::instance().add(ProgressModel::kBytes, data.size(), data.size());
+                qint32 id = ++mLastReplay;
+                mReplays.insert(id, sent);
+                QTimer::singleShot(int(latency), mContext, [this, id, data]{
+                    Request request = mReplays.take(id);
+                    deliver(request, request.token.isCancelled() ? QByteArray() : data);
+                });
+                continue;
+            }
+
+            QNetworkRequest netRequest;
+            QSslConfiguration conf = netRequest.sslConfiguration();
+            conf.setPeerVerifyMode(QSslSocket::VerifyNone);
+            netRequest.setSslConfiguration(conf);
+            netRequest.setUrl(resolve(sent.url)); // the host limits stay those of the data server
+            QNetworkReply *reply = mManager->get(netRequest);
+            mInFlight.insert(reply, sent);
+            connect(reply, &QNetworkReply::downloadProgress, mContext, [this, reply](qint64 received, qint64 expected) {
+                Request &request = mInFlight[reply];
+                qint64 total = expected > 0 ? expected - request.expected : 0;
+                ProgressModel::instance().add(ProgressModel::kBytes, received - request.received, total);
+                request.received = received;
+                if (expected > 0)
+                    request.expected = expected;
+            });
+            connect(reply, &QNetworkReply::finished, mContext, [this, reply]{ finish(reply); });
+        }
+    }
+}
+
+//===========================================================================
+void Fetcher::finish(QNetworkReply *reply)
+{
+    // runs in the network thread: fulfils the promise of reply and sends the next request of its host
+
+    Request request = mInFlight.take(reply);
+    QByteArray data;
+    if (reply->error() == QNetworkReply::NoError)
+        data = reply->readAll();
+    else if (reply->error() != QNetworkReply::OperationCanceledError)
+        qCWarning(lcNetwork) << reply->url().toString() << reply->errorString();
+    if (!request.token.isCancelled())
+        NetworkSession::instance().record(request.url, request.asked, NetworkSession::instance().now() - request.asked, data);
+    reply->deleteLater();
+    deliver(request, data);
+}
+
+//===========================================================================
+QFuture<QByteArray> Fetcher::get(const QUrl &url, TaskScheduler::Priority priority, const CancelToken &token)
+{
+    // queues the download of url, can be called from any thread
+    // by default the download is as urgent as the task asking for it and is cancelled with its load
+
+    Request request;
+    request.url      = url;
+    request.priority = priority;
+    request.token    = token;
+    request.promise.reportStarted();
+    {
+        QMutexLocker locker(&mMutex);
+        if (mStopped || token.isCancelled()) {
+            request.promise.reportResult(QByteArray());
+            request.promise.reportFinished();
+            return request.promise.future();
+        }
+        mRequests.enqueue(request);
+    }
+    ProgressModel::instance().add(ProgressModel::kFiles, 0, 1);
+    emit requested();
+    return request.promise.future();
+}
+
+//===========================================================================
+qint32 Fetcher::hostLimit(const QString &host)
+{
+    // the number of downloads sent at the same time to host, the servers of the reports are small
+
+    if (host == "alicecrm.web.cern.ch")
+        return 4;
+    else if (host == "alimonitor.cern.ch")
+        return 2;
+    else if (host == "accounting-support.egi.eu")
+        return 2;
+    return 6; // as QNetworkAccessManager
+}
+
+//===========================================================================
+Fetcher &Fetcher::instance()
+{
+    // created at first use, when the application object exists
+
+    static Fetcher instance;
+    return instance;
+}
+
+//===========================================================================
+QUrl Fetcher::resolve(const QUrl &url)
+{
+    // url, or the same path and query on the base URL if it is set and url is on one of the data servers
+    // the stand-in server tells the servers apart by the path: /data/..., /display, /custom_xml.php, /production/...
+
+    static const QStringList kHosts = QStringList() << "alicecrm.web.cern.ch" << "alimonitor.cern.ch"
+                                                    << "accounting-support.egi.eu";
+    if (!mBaseURL.isValid() || !kHosts.contains(url.host()))
+        return url;
+    QUrl rv(url);
+    rv.setScheme(mBaseURL.scheme());
+    rv.setHost(mBaseURL.host());
+    rv.setPort(mBaseURL.port());
+    QString prefix = mBaseURL.path();
+    if (prefix.endsWith('/'))
+        prefix.chop(1);
+    rv.setPath(prefix + url.path());
+    return rv;
+}
+
+//===========================================================================
+void Fetcher::send()
+{
+    // runs in the network thread: takes the new requests and sends what the hosts accept
+
+    if (!mManager)
+        mManager = new QNetworkAccessManager(mContext);
+
+    QQueue<Request> requests;
+    {
+        QMutexLocker locker(&mMutex);
+        requests.swap(mRequests);
+    }
+    mWaiting.append(requests);
+    dispatch();
+}
+
+//===========================================================================
+void Fetcher::setBaseURL(const QUrl &url)
+{
+    // sends the requests to the data servers to url, e.g. http://localhost:8080, to be set before the first download
+
+    mBaseURL = url;
+}
+
+//===========================================================================
+void Fetcher::stop()
+{
+    // the pending downloads are abandonned, their futures end with an empty content
+
+    {
+        QMutexLocker locker(&mMutex);
+        mStopped = true;
+    }
+    if (!mThread.isRunning())
+        return;
+    mThread.quit();
+    mThread.wait();
+
+    QList<Promise> promises;
+    for (const Request &request : mInFlight)
+        promises.append(request.promise);
+    mInFlight.clear();
+    for (const Request &request : mReplays)
+        promises.append(request.promise);
+    mReplays.clear();
+    for (const Request &request : mWaiting)
+        promises.append(request.promise);
+    mWaiting.clear();
+    {
+        QMutexLocker locker(&mMutex);
+        for (const Request &request : mRequests)
+            promises.append(request.promise);
+        mRequests.clear();
+    }
+    for (Promise &promise : promises) {
+        promise.reportResult(QByteArray());
+        promise.reportFinished();
+    }
+
+    delete mContext;
+    mContext = Q_NULLPTR;
+    mManager = Q_NULLPTR;
+}
@@ -0,0 +1,83 @@
+// Downloads files in a network thread and returns their content as a QFuture
+// no event loop is spun by the caller: it waits for the result in a worker thread, after starting all the files of a load at once
+// the downloads run at the same time up to a limit per host, the most urgent first
+// the downloads of a cancelled load are aborted and their buffers freed, their futures end empty
+// with a base URL set, the requests to the data servers go to a stand-in server instead (see tools/standin)
+// the responses are recorded or replayed from a file when a NetworkSession is started
+// singleton
+
+#ifndef FETCHER_H
+#define FETCHER_H
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QThread>
+#include <QUrl>
+
+#include "taskscheduler.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class Fetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    static Fetcher &instance();
+
+    void                abortCancelled();
+    QFuture<QByteArray> get(const QUrl &url, TaskScheduler::Priority priority = TaskScheduler::currentPriority(),
+                            const CancelToken &token = TaskScheduler::currentToken());
+    static qint32       hostLimit(const QString &host);
+    static QUrl         resolve(const QUrl &url);
+    static void         setBaseURL(const QUrl &url);
+    void                stop();
+
+signals:
+    void                abortRequested();
+    void                requested();
+
+private:
+    typedef QFutureInterface<QByteArray> Promise; // reports the content, empty if the download failed
+
+    struct Request {
+        Request() : priority(TaskScheduler::kNormal), received(0), expected(0), traceId(0), asked(0) {}
+        QUrl                    url;      // what to download
+        TaskScheduler::Priority priority; // the waiting requests of a host are sent by priority
+        Promise                 promise;  // fulfilled when the download is finished
+        CancelToken             token;    // the token of the load asking for the download
+        qint64                  received; // the bytes received so far
+        qint64                  expected; // the size announced by the server, 0 if unknown
+        quint64                 traceId;  // pairs the begin and end of the download in the trace, 0 if not traced
+        qint64                  asked;    // when it was sent in the time base of the NetworkSession
+    };
+
+    Fetcher(QObject *parent = 0);
+    ~Fetcher();
+    void abort();
+    void deliver(Request &request, const QByteArray &data);
+    void dispatch();
+    void finish(QNetworkReply *reply);
+    void send();
+
+    static QUrl                     mBaseURL;   // replaces the scheme, host and port of the data servers when valid
+
+    QObject                         *mContext;  // lives in mThread, the replies are handled in its context
+    QHash<QString, qint32>          mHostLoad;  // the number of downloads in flight per host
+    QHash<QNetworkReply*, Request>  mInFlight;  // the requests of the replies not yet finished
+    qint32                          mLastReplay; // the last key given in mReplays
+    QNetworkAccessManager           *mManager;  // the network manager, created in mThread
+    QMutex                          mMutex;     // protects mRequests and mStopped
+    QHash<qint32, Request>          mReplays;   // the requests served from the recorded session, waiting their latency
+    QQueue<Request>                 mRequests;  // the requests waiting for the network thread
+    bool                            mStopped;   // no more download once set
+    QThread                         mThread;    // the network thread
+    QList<Request>                  mWaiting;   // the requests waiting for their host, used in mThread only
+};
+
+#endif // FETCHER_H
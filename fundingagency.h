@@ -7,6 +7,7 @@
 #include <QHash>
 #include <QList>
 #include <QObject>
+#include "allocstats.h"
 #include "resources.h"
 
 class Tier;
@@ -53,12 +54,11 @@ public:
     void       setContribT(double val);
     void       setRequired(double cpu, double disk, double tape);
     QString    status() const         { if (mStatus == kMS) return "MS"; else return "NMS"; }
+    QList<Tier*> tiers() const        { return mTiers; }
 
     QString list() const;
 
 private:
-    QList<Tier*> tiers()     { return mTiers; }
-
 
     double                     mContrib;                 // required contribution, fraction of total required in %
     double                     mContribT;                // required contribution for tape, T1 only
@@ -69,6 +69,7 @@ private:
     QHash<QString, Resources*> mUsedResourcesML;         // monthly used resources reported by MonALISA
     QList<Tier*>               mTiers;                   // the list of sites for this FA
     qint32                     mStatus;                  // member state or non member state
+    ALLOC_LIVE(AllocStats::kFundingAgency);
 };
 
 #endif // FUNDINGAGENCY_H
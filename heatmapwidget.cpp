@@ -0,0 +1,229 @@
+// Heatmap of the used over pledged resources: one row per funding agency, one column per month
+// the cells are painted into cached tiles, only the tiles made dirty by a change of the ledger are repainted
+
+#include <QHelpEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QToolTip>
+
+#include "heatmapwidget.h"
+#include "timing.h"
+
+//===========================================================================
+HeatmapWidget::HeatmapWidget(const UsageLedger *ledger, UsageLedger::Quantity quantity, QWidget *parent) :
+    QAbstractScrollArea(parent),
+    mHeaderHeight(0), mLabelWidth(0), mLedger(ledger), mQuantity(quantity)
+{
+    // ctor
+
+    mHeaderHeight = fontMetrics().height() + 6;
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    horizontalScrollBar()->setSingleStep(kCellWidth);
+    verticalScrollBar()->setSingleStep(kCellHeight);
+}
+
+//===========================================================================
+bool HeatmapWidget::cellAt(const QPoint &pos, qint32 &row, qint32 &column) const
+{
+    // the cell under the viewport position pos
+
+    if (pos.x() < mLabelWidth || pos.y() < mHeaderHeight)
+        return false;
+    column = (pos.x() - mLabelWidth + horizontalScrollBar()->value()) / kCellWidth;
+    row    = (pos.y() - mHeaderHeight + verticalScrollBar()->value()) / kCellHeight;
+    return row < mRows.size() && column < mMonths.size();
+}
+
+//===========================================================================
+QColor HeatmapWidget::color(double ratio) const
+{
+    // from red (nothing used) to green (the pledge is used), gray when nothing is pledged
+
+    if (ratio < 0)
+        return QColor(Qt::lightGray);
+    return QColor::fromHsv(qRound(120 * qMin(ratio, 1.0)), 200, 230);
+}
+
+//===========================================================================
+void HeatmapWidget::invalidate(const QDate &month)
+{
+    // marks dirty the tiles of the column of month, all the tiles for an invalid month
+
+    if (!month.isValid()) {
+        mTiles.clear();
+        mDirty.clear();
+    } else {
+        qint32 column = mMonths.indexOf(UsageLedger::key(month));
+        if (column == -1)
+            return;
+        qint32 tileColumn = column / kTileCells;
+        qint32 tileRows   = (mRows.size() + kTileCells - 1) / kTileCells;
+        for (qint32 tileRow = 0; tileRow < tileRows; tileRow++)
+            mDirty.insert(tileKey(tileRow, tileColumn));
+    }
+    viewport()->update();
+}
+
+//===========================================================================
+void HeatmapWidget::paintEvent(QPaintEvent *event)
+{
+    // draws the visible tiles, rendering only the missing or dirty ones, and the labels
+
+    Q_UNUSED(event)
+    TIMED_SCOPE("heatmap render");
+
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().base());
+
+    qint32 dx     = horizontalScrollBar()->value();
+    qint32 dy     = verticalScrollBar()->value();
+    qint32 width  = viewport()->width() - mLabelWidth;
+    qint32 height = viewport()->height() - mHeaderHeight;
+    if (width <= 0 || height <= 0 || mRows.isEmpty() || mMonths.isEmpty())
+        return;
+
+    // the tiles
+    qint32 tileWidth  = kTileCells * kCellWidth;
+    qint32 tileHeight = kTileCells * kCellHeight;
+    qint32 lastTileColumn = qMin(dx + width, mMonths.size() * kCellWidth - 1) / tileWidth;
+    qint32 lastTileRow    = qMin(dy + height, mRows.size() * kCellHeight - 1) / tileHeight;
+    painter.save();
+    painter.setClipRect(mLabelWidth, mHeaderHeight, width, height);
+    for (qint32 tileRow = dy / tileHeight; tileRow <= lastTileRow; tileRow++)
+        for (qint32 tileColumn = dx / tileWidth; tileColumn <= lastTileColumn; tileColumn++) {
+            quint64 key = tileKey(tileRow, tileColumn);
+            if (!mTiles.contains(key) || mDirty.contains(key)) {
+                mTiles.insert(key, renderTile(tileRow, tileColumn));
+                mDirty.remove(key);
+            }
+            painter.drawPixmap(mLabelWidth + tileColumn * tileWidth - dx, mHeaderHeight + tileRow * tileHeight - dy, mTiles.value(key));
+        }
+    painter.restore();
+
+    // the funding agencies
+    painter.save();
+    painter.setClipRect(0, mHeaderHeight, mLabelWidth, height);
+    qint32 lastRow = qMin(mRows.size() - 1, (dy + height) / kCellHeight);
+    for (qint32 row = dy / kCellHeight; row <= lastRow; row++)
+        painter.drawText(QRect(2, mHeaderHeight + row * kCellHeight - dy, mLabelWidth - 4, kCellHeight),
+                         Qt::AlignRight | Qt::AlignVCenter, mRows.at(row));
+    painter.restore();
+
+    // the months
+    painter.save();
+    painter.setClipRect(mLabelWidth, 0, width, mHeaderHeight);
+    qint32 lastColumn = qMin(mMonths.size() - 1, (dx + width) / kCellWidth);
+    for (qint32 column = dx / kCellWidth; column <= lastColumn; column++)
+        painter.drawText(QRect(mLabelWidth + column * kCellWidth - dx, 0, kCellWidth, mHeaderHeight),
+                         Qt::AlignCenter, mMonths.at(column).toString("MM-yy"));
+    painter.restore();
+}
+
+//===========================================================================
+double HeatmapWidget::ratio(qint32 row, qint32 column) const
+{
+    // used over pledged resources of a funding agency during a month, -1 if nothing is pledged or used
+
+    const QDate &month = mMonths.at(column);
+    const QString &fa  = mRows.at(row);
+    double pledged = mLedger->pledged(month.year(), fa, mQuantity);
+    if (pledged <= 0 || !mLedger->contains(month))
+        return -1;
+    return mLedger->value(month, fa, mQuantity) / pledged;
+}
+
+//===========================================================================
+QPixmap HeatmapWidget::renderTile(qint32 tileRow, qint32 tileColumn) const
+{
+    // paints the cells of a tile
+
+    QPixmap tile(kTileCells * kCellWidth, kTileCells * kCellHeight);
+    tile.fill(palette().color(QPalette::Base));
+    QPainter painter(&tile);
+    for (qint32 r = 0; r < kTileCells; r++) {
+        qint32 row = tileRow * kTileCells + r;
+        if (row >= mRows.size())
+            break;
+        for (qint32 c = 0; c < kTileCells; c++) {
+            qint32 column = tileColumn * kTileCells + c;
+            if (column >= mMonths.size())
+                break;
+            painter.fillRect(c * kCellWidth, r * kCellHeight, kCellWidth - 1, kCellHeight - 1, color(ratio(row, column)));
+        }
+    }
+    return tile;
+}
+
+//===========================================================================
+void HeatmapWidget::resizeEvent(QResizeEvent *event)
+{
+    // the scroll ranges depend on the size of the viewport
+
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+//===========================================================================
+void HeatmapWidget::setMonths(const QList<QDate> &months)
+{
+    // the columns of the heatmap
+
+    mMonths.clear();
+    for (const QDate &month : months)
+        mMonths.append(UsageLedger::key(month));
+    invalidate();
+    updateScrollBars();
+}
+
+//===========================================================================
+void HeatmapWidget::setRows(const QStringList &rows)
+{
+    // the funding agencies, the label column fits the longest name
+
+    mRows = rows;
+    mLabelWidth = 0;
+    for (const QString &row : mRows)
+        mLabelWidth = qMax(mLabelWidth, fontMetrics().width(row));
+    mLabelWidth += 8;
+    invalidate();
+    updateScrollBars();
+}
+
+//===========================================================================
+void HeatmapWidget::updateScrollBars()
+{
+    // the scrolled area is the grid of cells, the labels stay in place
+
+    qint32 width  = viewport()->width() - mLabelWidth;
+    qint32 height = viewport()->height() - mHeaderHeight;
+    horizontalScrollBar()->setPageStep(qMax(width, kCellWidth));
+    horizontalScrollBar()->setRange(0, qMax(0, mMonths.size() * kCellWidth - width));
+    verticalScrollBar()->setPageStep(qMax(height, kCellHeight));
+    verticalScrollBar()->setRange(0, qMax(0, mRows.size() * kCellHeight - height));
+}
+
+//===========================================================================
+bool HeatmapWidget::viewportEvent(QEvent *event)
+{
+    // the tool tip gives the numbers behind the color of a cell
+
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *help = static_cast<QHelpEvent*>(event);
+        qint32 row, column;
+        if (!cellAt(help->pos(), row, column)) {
+            QToolTip::hideText();
+            return true;
+        }
+        const QDate &month = mMonths.at(column);
+        const QString &fa  = mRows.at(row);
+        double used    = mLedger->value(month, fa, mQuantity);
+        double pledged = mLedger->pledged(month.year(), fa, mQuantity);
+        QString text = QString("%1 %2\nused %3 / pledged %4").arg(fa, month.toString("MMMM yyyy"))
+                .arg(used, 0, 'f', 2).arg(pledged, 0, 'f', 2);
+        if (pledged > 0)
+            text += QString(" (%1%)").arg(100 * used / pledged, 0, 'f', 0);
+        QToolTip::showText(help->globalPos(), text, viewport());
+        return true;
+    }
+    return QAbstractScrollArea::viewportEvent(event);
+}
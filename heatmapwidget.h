@@ -0,0 +1,57 @@
+// Heatmap of the used over pledged resources: one row per funding agency, one column per month
+// the cells are painted into cached tiles, only the tiles made dirty by a change of the ledger are repainted
+
+#ifndef HEATMAPWIDGET_H
+#define HEATMAPWIDGET_H
+
+#include <QAbstractScrollArea>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QSet>
+#include <QStringList>
+
+#include "usageledger.h"
+
+class HeatmapWidget : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapWidget(const UsageLedger *ledger, UsageLedger::Quantity quantity, QWidget *parent = 0);
+
+    void   setMonths(const QList<QDate> &months);
+    void   setRows(const QStringList &rows);
+
+public slots:
+    void   invalidate(const QDate &month = QDate());
+
+protected:
+    void   paintEvent(QPaintEvent *event);
+    void   resizeEvent(QResizeEvent *event);
+    bool   viewportEvent(QEvent *event);
+
+private:
+    static const qint32 kCellHeight = 18; // the size of a cell in pixels
+    static const qint32 kCellWidth  = 40;
+    static const qint32 kTileCells  = 16; // number of cells per tile side
+
+    bool    cellAt(const QPoint &pos, qint32 &row, qint32 &column) const;
+    QColor  color(double ratio) const;
+    double  ratio(qint32 row, qint32 column) const;
+    QPixmap renderTile(qint32 tileRow, qint32 tileColumn) const;
+    static quint64 tileKey(qint32 tileRow, qint32 tileColumn) { return (quint64(quint32(tileRow)) << 32) | quint32(tileColumn); }
+    void    updateScrollBars();
+
+    QSet<quint64>           mDirty;        // the tiles to be repainted
+    qint32                  mHeaderHeight; // height of the month labels
+    qint32                  mLabelWidth;   // width of the funding agency labels
+    const UsageLedger       *mLedger;      // the used and pledged resources
+    QList<QDate>            mMonths;       // the columns
+    UsageLedger::Quantity   mQuantity;     // the resource shown
+    QStringList             mRows;         // the funding agencies
+    QHash<quint64, QPixmap> mTiles;        // the cached tiles
+};
+
+#endif // HEATMAPWIDGET_H
@@ -0,0 +1,251 @@
+// Runs the long data loads (fetch, parse, aggregate) in a worker thread so that the GUI stays responsive
+// a job is a list of steps run in order, the jobs are run one after the other which serializes the changes they make to ALICE
+// the most urgent job waiting runs next, the jobs of the window the user looks at are promoted
+// cancel() stops the running job after its current stage and drops the waiting ones
+// the progress and the end of a job are posted back to the GUI thread with queued signals
+// submit() returns the end of a job as a future instead, to chain continuations to it (see async.h)
+// singleton
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+#include "allocstats.h"
+#include "fetcher.h"
+#include "ingestpipeline.h"
+#include "progressmodel.h"
+#include "tracer.h"
+
+//===========================================================================
+IngestPipeline::IngestPipeline(QObject *parent) : QObject(parent),
+    mLastId(0), mStopped(false), mWorker(Q_NULLPTR)
+{
+    // ctor
+    // the worker thread lives as long as the application, it is stopped before the event loop ends
+
+    mThread.setObjectName("ingest");
+    mWorker = new QObject;
+    mWorker->moveToThread(&mThread);
+
+    connect(this, &IngestPipeline::jobQueued, mWorker, [this]{ execute(); }, Qt::QueuedConnection);
+    connect(this, &IngestPipeline::jobFinished, this, &IngestPipeline::complete, Qt::QueuedConnection);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &IngestPipeline::stop);
+
+    mThread.start();
+}
+
+//===========================================================================
+IngestPipeline::~IngestPipeline()
+{
+    // dtor
+
+    stop();
+}
+
+//===========================================================================
+IngestPipeline &IngestPipeline::instance()
+{
+    // created at first use, when the application object exists
+
+    static IngestPipeline instance;
+    return instance;
+}
+
+//===========================================================================
+void IngestPipeline::cancel()
+{
+    // cancels the running job and drops the waiting ones, their completions are called with ok false
+    // the downloads of the running job are aborted
+
+    QList<Job> dropped;
+    {
+        QMutexLocker locker(&mMutex);
+        mRunning.cancel();
+        dropped.swap(mJobs);
+    }
+    Fetcher::instance().abortCancelled();
+    for (Job &job : dropped) {
+        finish(job, false);
+        emit jobFinished(job.id, false);
+    }
+}
+
+//===========================================================================
+void IngestPipeline::complete(qint32 job, bool ok)
+{
+    // a job is done, its completion runs now in the GUI thread
+
+    Done done = mDone.take(job);
+    if (done)
+        done(ok);
+}
+
+//===========================================================================
+void IngestPipeline::execute()
+{
+    // runs in the worker thread the next job in the queue, one step after the other
+
+    Job job;
+    {
+        QMutexLocker locker(&mMutex);
+        if (mJobs.isEmpty())
+            return;
+        qint32 next = 0;
+        for (qint32 index = 1; index < mJobs.size(); index++)
+            if (mJobs.at(index).priority < mJobs.at(next).priority)
+                next = index;
+        job = mJobs.takeAt(next);
+        mRunning = job.token;
+    }
+    TaskScheduler::setCurrent(job.priority, job.owner, job.token);
+
+    TracedScope scope("job", job.title);
+    ALLOC_SCOPE(AllocStats::kIngest);
+    emit jobStarted(job.id, job.title);
+    ProgressModel::instance().add(ProgressModel::kSteps, 0, job.steps.size());
+    bool ok = true;
+    qint32 done = 0;
+    for (const Step &step : job.steps) {
+        if (mThread.isInterruptionRequested() || job.token.isCancelled()) {
+            ok = false;
+            break;
+        }
+        {
+            static const char *const kStages[] = {"fetch step", "parse step", "aggregate step"};
+            TracedScope stepScope(kStages[step.stage], step.text);
+            ok = step.work() && !job.token.isCancelled();
+        }
+        QString text;
+        switch (step.stage) {
+        case kFetch:
+            text = QString("Fetching %1").arg(step.text);
+            break;
+        case kParse:
+            text = QString("Parsing %1").arg(step.text);
+            break;
+        case kAggregate:
+            text = QString("Aggregating %1").arg(step.text);
+            break;
+        default:
+            break;
+        }
+        ProgressModel::instance().add(ProgressModel::kSteps, 1, 0);
+        emit stepDone(job.id, ++done, job.steps.size(), text);
+        if (!ok)
+            break;
+    }
+    TaskScheduler::setCurrent(TaskScheduler::kNormal, Q_NULLPTR);
+    finish(job, ok);
+    emit jobFinished(job.id, ok);
+}
+
+//===========================================================================
+void IngestPipeline::finish(Job &job, bool ok)
+{
+    // reports the end of job to the future returned by submit()
+
+    job.promise.reportResult(ok);
+    job.promise.reportFinished();
+}
+
+//===========================================================================
+void IngestPipeline::promote(QObject *owner)
+{
+    // the waiting jobs of owner, the window the user now looks at, pass before the others
+
+    if (!owner)
+        return;
+    QMutexLocker locker(&mMutex);
+    for (Job &job : mJobs)
+        if (job.owner == owner)
+            job.priority = TaskScheduler::kVisible;
+}
+
+//===========================================================================
+qint32 IngestPipeline::run(const QString &title, const QList<Step> &steps, Done done, QObject *owner,
+                           TaskScheduler::Priority priority)
+{
+    // queues a job for the worker thread, done is called in the GUI thread when the job is over
+    // owner is the window showing the result, if any
+
+    QFutureInterface<bool> promise;
+    promise.reportStarted();
+    qint32 id = queue(title, steps, owner, priority, promise);
+    mDone.insert(id, done);
+    return id;
+}
+
+//===========================================================================
+qint32 IngestPipeline::queue(const QString &title, const QList<Step> &steps, QObject *owner, TaskScheduler::Priority priority,
+                             const QFutureInterface<bool> &promise)
+{
+    // appends a job to the waiting ones, or drops it at once when the worker is stopped
+
+    Job job;
+    job.title    = title;
+    job.steps    = steps;
+    job.owner    = owner;
+    job.priority = priority;
+    job.promise  = promise;
+    {
+        QMutexLocker locker(&mMutex);
+        job.id = ++mLastId;
+        if (!mStopped) {
+            mJobs.append(job);
+            locker.unlock();
+            emit jobQueued();
+            return job.id;
+        }
+    }
+    finish(job, false);
+    emit jobFinished(job.id, false);
+    return job.id;
+}
+
+//===========================================================================
+IngestPipeline::Step IngestPipeline::step(Stage stage, const QString &text, std::function<bool()> work)
+{
+    // a step of a job
+
+    Step rv;
+    rv.stage = stage;
+    rv.text  = text;
+    rv.work  = work;
+    return rv;
+}
+
+//===========================================================================
+QFuture<bool> IngestPipeline::submit(const QString &title, const QList<Step> &steps, QObject *owner,
+                                     TaskScheduler::Priority priority)
+{
+    // queues a job for the worker thread and returns its end, true if all its steps succeeded
+    // can be called from any thread, the future is finished in the worker thread (see Async::then to chain to it)
+    // a step must not wait for the future of another job: the jobs run one after the other
+    // owner and priority are by default the ones of the calling task
+
+    QFutureInterface<bool> promise;
+    promise.reportStarted();
+    queue(title, steps, owner, priority, promise);
+    return promise.future();
+}
+
+//===========================================================================
+void IngestPipeline::stop()
+{
+    // the running job ends after its current step, the waiting ones are dropped and their futures end with false
+
+    QList<Job> dropped;
+    {
+        QMutexLocker locker(&mMutex);
+        mStopped = true;
+        dropped.swap(mJobs);
+    }
+    for (Job &job : dropped)
+        finish(job, false);
+    if (!mThread.isRunning())
+        return;
+    mThread.requestInterruption();
+    mThread.quit();
+    mThread.wait();
+    delete mWorker;
+    mWorker = Q_NULLPTR;
+}
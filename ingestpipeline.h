@@ -0,0 +1,87 @@
+// Runs the long data loads (fetch, parse, aggregate) in a worker thread so that the GUI stays responsive
+// a job is a list of steps run in order, the jobs are run one after the other which serializes the changes they make to ALICE
+// the most urgent job waiting runs next, the jobs of the window the user looks at are promoted
+// cancel() stops the running job after its current stage and drops the waiting ones
+// the progress and the end of a job are posted back to the GUI thread with queued signals
+// submit() returns the end of a job as a future instead, to chain continuations to it (see async.h)
+// singleton
+
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include <functional>
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+#include "taskscheduler.h"
+
+class IngestPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Stage {kFetch, kParse, kAggregate};
+    Q_ENUM (Stage)
+
+    struct Step {
+        Stage                 stage; // what the step does
+        QString               text;  // what the step works on, shown in the progress window
+        std::function<bool()> work;  // runs in the worker thread, false stops the job
+    };
+    typedef std::function<void(bool ok)> Done; // runs in the GUI thread, ok is false if a step stopped the job
+
+    static IngestPipeline &instance();
+
+    void              cancel();
+    void              promote(QObject *owner);
+    qint32            run(const QString &title, const QList<Step> &steps, Done done, QObject *owner = Q_NULLPTR,
+                          TaskScheduler::Priority priority = TaskScheduler::kNormal);
+    static Step       step(Stage stage, const QString &text, std::function<bool()> work);
+    void              stop();
+    QFuture<bool>     submit(const QString &title, const QList<Step> &steps, QObject *owner = TaskScheduler::currentOwner(),
+                             TaskScheduler::Priority priority = TaskScheduler::currentPriority());
+
+signals:
+    void jobFinished(qint32 job, bool ok);
+    void jobQueued();
+    void jobStarted(qint32 job, const QString &title);
+    void stepDone(qint32 job, qint32 done, qint32 total, const QString &text);
+
+private slots:
+    void complete(qint32 job, bool ok);
+
+private:
+    struct Job {
+        qint32                  id;       // the number given by run()
+        QString                 title;    // what the job does
+        QList<Step>             steps;    // the steps run in order
+        QObject                 *owner;   // the window waiting for the job, never dereferenced
+        TaskScheduler::Priority priority; // the most urgent waiting job runs first, its fetches and tasks inherit it
+        CancelToken             token;    // cancels the job, its fetches and its tasks
+        QFutureInterface<bool>  promise;  // finished with the result of the job, false if it is dropped
+    };
+
+    IngestPipeline(QObject *parent = 0);
+    ~IngestPipeline();
+    void execute();
+    static void finish(Job &job, bool ok);
+    qint32 queue(const QString &title, const QList<Step> &steps, QObject *owner, TaskScheduler::Priority priority,
+                 const QFutureInterface<bool> &promise);
+
+    QHash<qint32, Done> mDone;    // the completions of the pending jobs, used in the GUI thread only
+    QList<Job>          mJobs;    // the jobs waiting for the worker, in the order of run() and submit()
+    qint32              mLastId;  // the number of the last job
+    QMutex              mMutex;   // protects mJobs, mLastId, mRunning and mStopped
+    CancelToken         mRunning; // the token of the running job
+    bool                mStopped; // no more job once set
+    QThread             mThread;  // the worker thread
+    QObject             *mWorker; // lives in mThread, the jobs run in its context
+};
+
+#endif // INGESTPIPELINE_H
@@ -1,25 +1,86 @@
 // Author: Yves Schutz 23 novembre 2016
 //
 // Object to redefine logging. Singleton
+// the messages of qDebug, qInfo, qWarning and qCritical are pushed on a lock-free queue by the thread logging them
+// and drained by a writer thread into a rotating file and, in batches at a limited rate, into the console
+// each subsystem logs in its own category (cr.ingest, cr.network, ...), their debug messages are off unless
+// the debug mode is on, and a qCDebug of a disabled category does not even format its arguments
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
 
 #include "logger.h"
 
+Q_LOGGING_CATEGORY(lcIngest,  "cr.ingest")
+Q_LOGGING_CATEGORY(lcNaming,  "cr.naming")
+Q_LOGGING_CATEGORY(lcNetwork, "cr.network")
+Q_LOGGING_CATEGORY(lcUi,      "cr.ui")
+
 Logger *Logger::mInstance = Q_NULLPTR;
 
 //__________________________________________________________________________
-Logger::Logger(QObject *parent) :QObject(parent)
+Logger::Logger(QObject *parent) :QObject(parent),
+    mDropped(0), mHead(&mStub), mRunning(0), mTail(&mStub), mWriter(Q_NULLPTR)
 {
     // ctor (private)
+    // the writer thread is started by start(), its timer drains the queue
+
     setObjectName("Logger");
+
+    mThread.setObjectName("logger");
+    mWriter = new QObject;
+    QTimer *timer = new QTimer(mWriter);
+    timer->setInterval(kDrainInterval);
+    connect(timer, &QTimer::timeout, mWriter, [this]{ drain(false); });
+    connect(&mThread, &QThread::started, timer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    mWriter->moveToThread(&mThread);
 }
 
 //__________________________________________________________________________
-void Logger::writeMessage(const QString &message)
+Logger::~Logger()
+{
+    // dtor
+
+    stop();
+    delete mWriter;
+}
+
+//__________________________________________________________________________
+void Logger::drain(bool force)
 {
-    // tells that message is available for writing
+    // runs in the writer thread: writes the queued messages in the file and sends them to the console
+    // at most every kConsoleInterval ms, or at once if force is set
 
-    mMessage = message;
-    emit messageReceived(message);
+    Node *node;
+    while ((node = pop())) {
+        if (mFile.isOpen()) {
+            mFile.write(node->message.toUtf8());
+            mFile.write("\n");
+        }
+        if (mBatch.size() < kConsoleLines)
+            mBatch.append(node->message);
+        else
+            mDropped++;
+        delete node;
+    }
+    if (mFile.isOpen()) {
+        mFile.flush();
+        if (mFile.size() > kFileSize)
+            rotate();
+    }
+
+    if (mBatch.isEmpty() || (!force && mClock.elapsed() < kConsoleInterval))
+        return;
+    if (mDropped)
+        mBatch.append(QString("... %1 lines not shown, see %2").arg(mDropped).arg(mFile.fileName()));
+    emit messageReceived(mBatch.join('\n'));
+    mBatch.clear();
+    mDropped = 0;
+    mClock.restart();
 }
 
 //__________________________________________________________________________
@@ -32,6 +93,140 @@ Logger *Logger::instance()
     return mInstance;
 }
 
+//__________________________________________________________________________
+void Logger::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    // formats a message of qDebug and the like and queues it, a fatal message is written at once before aborting
+
+    QString where = QString(context.function);
+    if (context.category && qstrcmp(context.category, "default") != 0)
+        where = QString("%1 %2").arg(context.category, where);
+
+    QString txt;
+    switch (type) {
+    case QtDebugMsg:
+        txt = QString("Debug<%1-%2>: %3").arg(where).arg(context.line).arg(message);
+        break;
+    case QtInfoMsg:
+        txt = QString("Info<%1>: %2").arg(where).arg(message);
+        break;
+    case QtWarningMsg:
+        txt = QString("Warning<%1-%2>: %3").arg(where).arg(context.line).arg(message);
+        break;
+    case QtCriticalMsg:
+        txt = QString("Critical:<%1-%2>: %3").arg(where).arg(context.line).arg(message);
+        break;
+    case QtFatalMsg:
+        txt = QString("Fatal:<%1-%2>: %3").arg(where).arg(context.line).arg(message);
+        fprintf(stderr, "%s\n", txt.toLocal8Bit().constData());
+        abort();
+    }
+
+    Logger *logger = instance();
+    if (!logger->mRunning.loadAcquire()) {
+        fprintf(stderr, "%s\n", txt.toLocal8Bit().constData());
+        return;
+    }
+    Node *node = new Node;
+    node->message = txt;
+    logger->push(node);
+}
+
+//__________________________________________________________________________
+Logger::Node *Logger::pop()
+{
+    // runs in the writer thread: the oldest message pushed, null if there is none yet
+    // the queue of D. Vyukov, intrusive multiple producers single consumer: a push is one exchange and one store
+
+    Node *tail = mTail;
+    Node *next = tail->next.loadAcquire();
+    if (tail == &mStub) {
+        if (!next)
+            return Q_NULLPTR;
+        mTail = next;
+        tail  = next;
+        next  = next->next.loadAcquire();
+    }
+    if (next) {
+        mTail = next;
+        return tail;
+    }
+    if (tail != mHead.loadAcquire())
+        return Q_NULLPTR; // a producer is between its exchange and its store, the message comes at the next drain
+    push(&mStub);
+    next = tail->next.loadAcquire();
+    if (next) {
+        mTail = next;
+        return tail;
+    }
+    return Q_NULLPTR;
+}
+
+//__________________________________________________________________________
+void Logger::push(Node *node)
+{
+    // queues node, can be called from any thread without lock
+
+    node->next.store(Q_NULLPTR);
+    Node *previous = mHead.fetchAndStoreOrdered(node);
+    previous->next.storeRelease(node);
+}
+
+//__________________________________________________________________________
+void Logger::rotate()
+{
+    // runs in the writer thread: name becomes name.1, name.1 name.2, etc., the oldest is removed
+
+    QString name = mFile.fileName();
+    mFile.close();
+    QFile::remove(QString("%1.%2").arg(name).arg(kFiles));
+    for (qint32 index = kFiles - 1; index >= 1; index--)
+        QFile::rename(QString("%1.%2").arg(name).arg(index), QString("%1.%2").arg(name).arg(index + 1));
+    QFile::rename(name, QString("%1.1").arg(name));
+    mFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+//__________________________________________________________________________
+void Logger::setDebug(bool on)
+{
+    // the debug messages of the categories of the application are on or off, the other levels stay on
+
+    QLoggingCategory::setFilterRules(on ? "cr.*.debug=true" : "cr.*.debug=false");
+}
+
+//__________________________________________________________________________
+void Logger::start(const QString &fileName)
+{
+    // routes the messages to the writer thread, to fileName and to the console
+
+    if (mRunning.loadAcquire())
+        return;
+    QDir().mkpath(QFileInfo(fileName).path());
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        fprintf(stderr, "%s cannot be written, the messages go to the console only\n", qPrintable(fileName));
+    mClock.start();
+    setDebug(false);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &Logger::stop, Qt::UniqueConnection);
+    mThread.start();
+    mRunning.storeRelease(1);
+    qInstallMessageHandler(messageHandler);
+}
+
+//__________________________________________________________________________
+void Logger::stop()
+{
+    // writes what is still queued, the messages logged from now on go to stderr
+
+    if (!mRunning.fetchAndStoreOrdered(0))
+        return;
+    qInstallMessageHandler(Q_NULLPTR);
+    mThread.quit();
+    mThread.wait();
+    drain(true); // the writer thread is over
+    mFile.close();
+}
+
 //__________________________________________________________________________
 void Logger::write(const QString &message)
 {
@@ -39,3 +234,17 @@ void Logger::write(const QString &message)
 
     Logger::instance()->writeMessage(message);
 }
+
+//__________________________________________________________________________
+void Logger::writeMessage(const QString &message)
+{
+    // tells that message is available for writing, through the writer thread once started
+
+    if (!mRunning.loadAcquire()) {
+        emit messageReceived(message);
+        return;
+    }
+    Node *node = new Node;
+    node->message = message;
+    push(node);
+}
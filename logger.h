@@ -1,30 +1,75 @@
 // Author: Yves Schutz 23 novembre 2016
 //
 // Object to redefine logging. Singleton
+// the messages of qDebug, qInfo, qWarning and qCritical are pushed on a lock-free queue by the thread logging them
+// and drained by a writer thread into a rotating file and, in batches at a limited rate, into the console
+// each subsystem logs in its own category (cr.ingest, cr.network, ...), their debug messages are off unless
+// the debug mode is on, and a qCDebug of a disabled category does not even format its arguments
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLoggingCategory>
 #include <QObject>
+#include <QStringList>
+#include <QThread>
+
+Q_DECLARE_LOGGING_CATEGORY(lcIngest)  // the downloads of the reports and their parsing into ALICE
+Q_DECLARE_LOGGING_CATEGORY(lcNaming)  // the lookups of the CEs, SEs and sites
+Q_DECLARE_LOGGING_CATEGORY(lcNetwork) // the fetcher and the recorded sessions
+Q_DECLARE_LOGGING_CATEGORY(lcUi)      // the windows, the tables and the exports
 
 class Logger : public QObject
 {
     Q_OBJECT
 public:
     static Logger* instance();
+    static void    messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message);
+    static void    setDebug(bool on);
+    void           start(const QString &fileName);
+    void           stop();
     static void    write(const QString& message);
 
 Q_SIGNALS:
-    void messageReceived(const QString& message);
+    void messageReceived(const QString& message); // a batch of lines for the console
 
 private:
+    struct Node {
+        Node() : next(Q_NULLPTR) {}
+        QAtomicPointer<Node> next;    // the next message pushed
+        QString              message; // the formatted message
+    };
+
    Logger(QObject *parent = 0);
-   ~Logger() {}
+   ~Logger();
    Logger (const Logger&):QObject() {}
 
-   void writeMessage(const QString& message);
+    void drain(bool force);
+    Node *pop();
+    void push(Node *node);
+    void rotate();
+    void writeMessage(const QString& message);
+
+    static const qint32  kConsoleInterval = 100;     // the minimum time in ms between two batches sent to the console
+    static const qint32  kConsoleLines    = 500;     // the maximum lines of a batch, the others are counted as dropped
+    static const qint32  kDrainInterval   = 20;      // the period in ms of the writer thread
+    static const qint64  kFileSize        = 5 << 20; // the size in bytes after which the file is rotated
+    static const qint32  kFiles           = 3;       // the rotated files kept, name.1 being the most recent
 
-    static Logger* mInstance; // the unique instance
-    QString        mMessage;  // the message to be displayed
+    static Logger*        mInstance;  // the unique instance
+    QStringList           mBatch;     // the lines waiting for the console, used in mThread only
+    QElapsedTimer         mClock;     // the time since the last batch sent to the console
+    qint32                mDropped;   // the lines not shown in the console since the last batch
+    QFile                 mFile;      // the log file, used in mThread only
+    QAtomicPointer<Node>  mHead;      // the last message pushed, the producers only touch this end
+    QAtomicInt            mRunning;   // the messages go to the queue only when set, to stderr otherwise
+    Node                  mStub;      // keeps the queue never empty
+    Node                  *mTail;     // the next message to pop, used in mThread only
+    QThread               mThread;    // the writer thread
+    QObject               *mWriter;   // lives in mThread, drains the queue
 };
 
 #endif // LOGGER_H
@@ -1,16 +1,61 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
 
 #include "alice.h"
+#include "fetcher.h"
+#include "naming.h"
+#include "networksession.h"
 #include "qfonticon.h"
+#include "timing.h"
 
 int main(int argc, char *argv[])
 {
+    // the startup is timed up to the first paint of the window, the collaboration and the dictionary are made after it
+    QElapsedTimer startup;
+    startup.start();
+
     QApplication a(argc, argv);
 
     QFontIcon::addFont(":/fontawesome.ttf");
 
+    // --naming <file> reads the dictionary of the CEs and SEs from file, e.g. the one written with the synthetic data of tools/datagen
+    // --base-url <url> sends the requests to the data servers to url, e.g. the stand-in server of tools/standin
+    // --record <file> saves the responses of the data servers in file, --replay <file> serves them from file without the network
+    // and --replay-latencies waits as long as the recorded responses took
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption namingOption("naming", "Reads the naming dictionary from <file>.", "file");
+    parser.addOption(namingOption);
+    QCommandLineOption baseURLOption("base-url", "Sends the requests to the data servers to <url>.", "url");
+    parser.addOption(baseURLOption);
+    QCommandLineOption recordOption("record", "Records the responses of the data servers in <file>.", "file");
+    parser.addOption(recordOption);
+    QCommandLineOption replayOption("replay", "Replays the responses recorded in <file> instead of downloading.", "file");
+    parser.addOption(replayOption);
+    QCommandLineOption latenciesOption("replay-latencies", "Replays the responses after their recorded latencies.");
+    parser.addOption(latenciesOption);
+    parser.process(a);
+    if (parser.isSet(recordOption) || parser.isSet(replayOption)) {
+        bool ok = parser.isSet(replayOption)
+                ? NetworkSession::instance().replay(parser.value(replayOption), parser.isSet(latenciesOption))
+                : NetworkSession::instance().record(parser.value(recordOption));
+        if (!ok) {
+            QTextStream(stderr) << NetworkSession::instance().error() << endl;
+            return 1;
+        }
+    }
+    if (parser.isSet(baseURLOption))
+        Fetcher::setBaseURL(QUrl(parser.value(baseURLOption)));
+    if (parser.isSet(namingOption))
+        Naming::setFileName(parser.value(namingOption));
+
+    qint64 window = startup.nsecsElapsed();
     MainWindow w;
+    Timing::instance().record("startup: main window", startup.nsecsElapsed() - window);
+    w.setStartup(startup);
     w.show();
 
 
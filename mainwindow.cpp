@@ -1,6 +1,8 @@
 // Y. Schutz November 2016
 
 #include <QAction>
+#include <QActionGroup>
+#include <QApplication>
 #include <QAreaSeries>
 #include <QBarCategoryAxis>
 #include <QBarSeries>
@@ -15,6 +17,7 @@
 #include <QDateTimeAxis>
 #include <QDebug>
 #include <QDir>
+#include <QFileDialog>
 #include <QHeaderView>
 #include <QLabel>
 #include <QLegendMarker>
@@ -31,22 +34,34 @@
 #include <QPrinter>
 #include <QProgressBar>
 #include <QSplitter>
+#include <QStandardPaths>
 #include <QScatterSeries>
-#include <QSortFilterProxyModel>
 #include <QSslConfiguration>
 #include <QStatusBar>
 #include <QToolBar>
 #include <QValueAxis>
-#include <QVBarModelMapper>
 #include <QVBoxLayout>
-#include <QVXYModelMapper>
 
+#include "allocstats.h"
 #include "consolewidget.h"
+#include "downsampler.h"
+#include "fasortproxymodel.h"
+#include "fetcher.h"
+#include "heatmapwidget.h"
+#include "ingestpipeline.h"
 #include "logger.h"
 #include "mainwindow.h"
 #include "mymdiarea.h"
+#include "naming.h"
+#include "networksession.h"
 #include "pltablemodel.h"
+#include "progressmodel.h"
 #include "qfonticon.h"
+#include "seriesbuilder.h"
+#include "taskscheduler.h"
+#include "timeseriespyramid.h"
+#include "timing.h"
+#include "zoomchartview.h"
 
 QT_CHARTS_USE_NAMESPACE
 
@@ -59,12 +74,19 @@ MainWindow::MainWindow(QWidget *parent)
     // ctor
 
     mDebug = false;
+    mCancelled         = false;
     mDownLoadText      = Q_NULLPTR;
+    mIngesting         = 0;
     mNetworkManager    = Q_NULLPTR;
     mProgressBar       = Q_NULLPTR;
     mProgressBarWidget = Q_NULLPTR;
+    mProgressText      = Q_NULLPTR;
     mOffTableConsol    = Q_NULLPTR;
+    mOffProxy          = Q_NULLPTR;
+    mTableProxy        = Q_NULLPTR;
     mTableConsol       = Q_NULLPTR;
+    mTimingAction      = Q_NULLPTR;
+    mTracingAction     = Q_NULLPTR;
     mURL            = "";
     setGeometry(0,0, 50, 25);
 
@@ -94,6 +116,16 @@ MainWindow::MainWindow(QWidget *parent)
     createActions();
     createMenu();
 
+    // the progress of the loads running in the ingestion thread
+    connect(&IngestPipeline::instance(), &IngestPipeline::stepDone, this, &MainWindow::stepDone);
+    connect(&ProgressModel::instance(), &ProgressModel::changed, this, &MainWindow::showProgress);
+
+    // the loads of the window the user looks at pass before the others
+    connect(mMdiArea, &QMdiArea::subWindowActivated, this, [](QMdiSubWindow *window) {
+        IngestPipeline::instance().promote(window);
+        TaskScheduler::instance().promote(window);
+    });
+
     QString message = tr("Welcome to ALICE Computing Resources tool");
     statusBar()->showMessage(message);
 
@@ -142,7 +174,32 @@ void MainWindow::list(ALICE::ListOptions val)
 //===========================================================================
 void MainWindow::paintEvent(QPaintEvent *event)
 {
+    // the first paint ends the startup: its time is reported and what the loads need is prepared
+
     QMainWindow::paintEvent(event);
+    if (!mStartup.isValid())
+        return;
+    qint64 nsecs = mStartup.nsecsElapsed();
+    mStartup.invalidate();
+    Timing::instance().record("startup: first window", nsecs);
+    qCInfo(lcUi) << "First window shown" << nsecs / 1000000 << "ms after start";
+    warmUp();
+}
+
+//===========================================================================
+void MainWindow::cancelLoads()
+{
+    // the Cancel button of the progress window: stops the ingestion jobs and aborts their downloads
+    // and the downloads started here
+
+    mCancelled = mIngesting > 0; // reset by the last load to end (see loadDone), nothing waits for it otherwise
+    IngestPipeline::instance().cancel();
+    if (mNetworkManager)
+        for (QNetworkReply *reply : mNetworkManager->findChildren<QNetworkReply*>())
+            reply->abort();
+    if (mDownLoadText)
+        mDownLoadText->setText("Cancelling...");
+    setProgressBar(false);
 }
 
 //===========================================================================
@@ -164,6 +221,23 @@ void MainWindow::doit(qint32 opt)
     }
 }
 
+//===========================================================================
+void MainWindow::exportTable()
+{
+    // save the current funding agencies table in a file chosen by the user, sorted and filtered as in its view
+
+    QString name = ALICE::instance().getModel()->tableType() == FATableModel::kReqAndPle ? "PleAndReq.csv" : "Offenders.csv";
+    QString dir  = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString filter;
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export table"), QString("%1/%2").arg(dir, name),
+                                                    TableExporter::filters(), &filter);
+    if (fileName.isEmpty())
+        return;
+
+    if (!ALICE::instance().exportTable(fileName, TableExporter::formatOf(filter), tableProxy()))
+        QMessageBox::warning(this, tr("Export table"), QString(tr("Could not write %1")).arg(fileName));
+}
+
 //===========================================================================
 void MainWindow::findAName()
 {   //FIXME: Find a suitable name for this method
@@ -172,14 +246,14 @@ void MainWindow::findAName()
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     QByteArray data = reply->readAll();
     if (data.isEmpty()) {
-        qCritical() << Q_FUNC_INFO << "no data found";
+        qCCritical(lcNetwork) << Q_FUNC_INFO << "no data found";
         return;
     }
 
     QTextStream instream(&data);
     QString line;
     while (instream.readLineInto(&line)) {
-        qDebug() << Q_FUNC_INFO << line;
+        qCDebug(lcNetwork) << Q_FUNC_INFO << line;
     }
 }
 
@@ -189,36 +263,32 @@ void MainWindow::onTableClicked(const QModelIndex & index)
     // do something when cell is clicked
 
     if (index.isValid()) {
-        qDebug() << Q_FUNC_INFO << index.column() << index.row();
+        qCDebug(lcUi) << Q_FUNC_INFO << index.column() << index.row();
          QString cellText = index.data().toString();
          if (index.column() == 1) {
-             FundingAgency * fa =  ALICE::instance().searchFA(cellText);
-             QMessageBox::about(this, cellText, fa->list());
+             ModelSnapshotPtr model = ALICE::instance().snapshot();
+             const ModelSnapshot::Agency *fa = model->agency(cellText);
+             if (fa)
+                 QMessageBox::about(this, cellText, fa->listing);
          }
     }
 }
 
 //===========================================================================
-void MainWindow::parsePlotUrlFile(PlotOptions opt)
+void MainWindow::parsePlotUrlFile(PlotOptions opt, const QByteArray &data, QList<QVector<double>*> &plData, QList<QString> &plDataName)
 {
-    // read the csv file collected from MonALISA
+    // read the csv file collected from MonALISA into plData and plDataName
+    // runs in the ingestion thread, touches no member
+
+    TIMED_SCOPE("parsePlotUrlFile");
+    ALLOC_SCOPE(AllocStats::kPlot);
 
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    QByteArray data = reply->readAll();
     if (data.isEmpty())
         return;
 
-    mDownLoadText->setText("DONE");
-
-    setProgressBar(false);
-
-    QTextStream stream(&data);
+    QTextStream stream(data);
     QString line;
 
-    qDeleteAll(mPlData.begin(), mPlData.end());
-    mPlData.clear();
-    mPlDataName.clear();
-
     QVector<qint64> dates;
     stream.readLineInto(&line); //the header line
     QStringList strList = line.split(",");
@@ -229,25 +299,25 @@ void MainWindow::parsePlotUrlFile(PlotOptions opt)
     for (QString str : strList) {
         if (opt == kCPUUserShareProfile) {
             if (str == "alidaq") {
-                mPlDataName.insert(0, "");
-                mPlDataName.insert(ALICE::kAliDaq + 1, str);
+                plDataName.insert(0, "");
+                plDataName.insert(ALICE::kAliDaq + 1, str);
                 alidaqCol = col;
             }
             else if (str == "aliprod") {
-                mPlDataName.insert(ALICE::kAliProd + 1, str);
+                plDataName.insert(ALICE::kAliProd + 1, str);
                 aliprodCol = col;
             }
             else if (str == "alitrain") {
-                mPlDataName.insert(ALICE::kAliTrain + 1, str);
+                plDataName.insert(ALICE::kAliTrain + 1, str);
                 alitrainCol = col;
             }
             col++;
         } else {
-            mPlDataName.append(str);
+            plDataName.append(str);
         }
     }
     if (opt == kCPUUserShareProfile) {
-        mPlDataName.insert(ALICE::kAliUsers + 1,"aliusers");
+        plDataName.insert(ALICE::kAliUsers + 1,"aliusers");
         while (stream.readLineInto(&line)) {
             QVector<double> *dataVec = new QVector<double>(ALICE::kAliUsers + 2);
             QStringList strlist = line.split(",");
@@ -273,7 +343,7 @@ void MainWindow::parsePlotUrlFile(PlotOptions opt)
                     dataVec->at(ALICE::kAliUsers + 1);
             for (qint32 index = 1; index < dataVec->size(); index++)
                 dataVec->replace(index, 100 * dataVec->at(index) / sum);
-            mPlData.append(dataVec);
+            plData.append(dataVec);
         }
     } else {
         while (stream.readLineInto(&line)) {
@@ -286,7 +356,7 @@ void MainWindow::parsePlotUrlFile(PlotOptions opt)
                 double data   = sdata.toDouble();
                 dataVec->replace(index, data);
             }
-            mPlData.append(dataVec);
+            plData.append(dataVec);
         }
     }
     stream.reset();
@@ -296,32 +366,9 @@ void MainWindow::parsePlotUrlFile(PlotOptions opt)
     for (qint64 date : dates) {
         qint64 days = (dates.last() - date) / 3600. / 24.;
         QDateTime ddate(today.addDays(-days));
-        QVector<double> *dataVec = mPlData.at(index++);
+        QVector<double> *dataVec = plData.at(index++);
         dataVec->replace(0, (double)ddate.toMSecsSinceEpoch());
     }
-
-    switch (opt) {
-    case kRegisteredDataProfile:
-        plRegisteredData(opt);
-        break;
-    case kTierEfficiencyProfile:
-        plTierEfficiency(kTierEfficiencyProfile);
-        break;
-    case kUserEfficiencyProfile:
-        plUserEfficiency(kUserEfficiencyProfile);
-        break;
-    case kPledgesProfile:
-        saveData(opt);
-        break;
-    case kEventSizeProfile:
-        plProfileEventSize();
-        break;
-    case kCPUUserShareProfile:
-        plUserEfficiency(kCPUUserShareProfile);
-        break;
-    default:
-        break;
-    }
 }
 
 //===========================================================================
@@ -331,33 +378,76 @@ void MainWindow::showNetworkError(QNetworkReply::NetworkError er)
     Q_UNUSED(er);
 
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    mDownLoadText->setText(QString("%1").arg(reply->errorString()));
+    if (mDownLoadText)
+        mDownLoadText->setText(QString("%1").arg(reply->errorString()));
+}
+
+//===========================================================================
+void MainWindow::showProgress()
+{
+    // the progress of all the loads, called at most every 100 ms by ProgressModel
+
+    if (!mProgressBar)
+        return;
+    mProgressBar->setMaximum(1000);
+    mProgressBar->setValue(qRound(ProgressModel::instance().fraction() * 1000));
+    mProgressText->setText(ProgressModel::instance().text());
 }
 
 //===========================================================================
 void MainWindow::sortColumn(int col)
 {
-   // sort table according to column col
-   static bool kUp = true;
+   // sort the table whose header was clicked according to column col, with shift col is added as a secondary sort column
+
+   QHeaderView *header = qobject_cast<QHeaderView*>(sender());
+   FASortProxyModel *proxy = header ? qobject_cast<FASortProxyModel*>(header->model()) : Q_NULLPTR;
+   if (!proxy)
+       return;
+   bool append = QApplication::keyboardModifiers() & Qt::ShiftModifier;
+   proxy->sortBy(col, append);
+   header->setSortIndicator(proxy->sortColumn(), proxy->sortOrder());
+}
 
-   if (kUp)
-       mOffTableConsol->sortByColumn(col, Qt::DescendingOrder);
-   else
-       mOffTableConsol->sortByColumn(col, Qt::AscendingOrder);
+//===========================================================================
+void MainWindow::stepDone(qint32 job, qint32 done, qint32 total, const QString &text)
+{
+    // shows the last step done, the progress bar follows all the loads (see showProgress)
 
-   kUp = !kUp;
+    Q_UNUSED(job)
+    Q_UNUSED(done)
+    Q_UNUSED(total)
+    if (!mDownLoadText || mCancelled)
+        return;
+    mDownLoadText->setText(text);
+}
 
-   mOffTableConsol->reset();
-   mOffTableConsol->show();
+//===========================================================================
+FASortProxyModel *MainWindow::tableProxy() const
+{
+    // the sort and filter proxy of the funding agencies table activated last, null if none is shown
 
+    QList<QMdiSubWindow*> windows = mMdiArea->subWindowList(QMdiArea::ActivationHistoryOrder);
+    for (qint32 index = windows.size() - 1; index >= 0; index--) {
+        QTableView *view = qobject_cast<QTableView*>(windows.at(index)->widget());
+        FASortProxyModel *proxy = view ? qobject_cast<FASortProxyModel*>(view->model()) : Q_NULLPTR;
+        if (proxy)
+            return proxy;
+    }
+    return Q_NULLPTR;
 }
 
 //===========================================================================
 void MainWindow::transferProgress(qint64 readBytes, qint64 totalBytes)
 {
-    // update the progress bar while transferring data
-      mProgressBar->setMaximum(totalBytes);
-      mProgressBar->setValue(readBytes);
+    // adds the bytes of a download started here to the progress of all the loads
+
+    QObject *reply = sender();
+    qint64 lastRead  = reply->property("readBytes").toLongLong();
+    qint64 lastTotal = reply->property("totalBytes").toLongLong();
+    ProgressModel::instance().add(ProgressModel::kBytes, readBytes - lastRead, totalBytes > 0 ? totalBytes - lastTotal : 0);
+    reply->setProperty("readBytes", readBytes);
+    if (totalBytes > 0)
+        reply->setProperty("totalBytes", totalBytes);
 }
 
 //===========================================================================
@@ -484,6 +574,15 @@ void MainWindow::validateDates(PlotOptions opt)
     {
         mURL = QString("http://alimonitor.cern.ch/display?imgsize=1280x700&interval.max=%1&interval.min=%2&page=jpu/jpu_RUNNING&download_data_csv=true").arg(diffS).arg(diffE);
         getDataFromWeb(opt);
+        break;
+    }
+    case kUsage_PledgesHeatmap:
+    {
+        mURL = ALICE::instance().dataURL();
+        plHeatmap(Resources::kCPU);
+        plHeatmap(Resources::kDISK);
+        plHeatmap(Resources::kTAPE);
+        break;
     }
 
     default:
@@ -540,6 +639,26 @@ void MainWindow::validateDates(LoadOptions opt)
     }
 }
 
+//===========================================================================
+void MainWindow::addStatusFilterActions(QTableView *view, FASortProxyModel *proxy)
+{
+    // context menu of the table to show all, MS only or NMS only funding agencies
+
+    QActionGroup *group = new QActionGroup(view);
+    QMetaEnum me = QMetaEnum::fromType<FASortProxyModel::StatusFilter>();
+    for (qint32 index = 0; index < me.keyCount(); index++) {
+        QString swhat = me.key(index);
+        swhat.remove(0, 1); // removes the "k"
+        FASortProxyModel::StatusFilter what = static_cast<FASortProxyModel::StatusFilter>(me.value(index));
+        QAction *act = new QAction(QString("show %1").arg(swhat), group);
+        act->setCheckable(true);
+        act->setChecked(what == proxy->statusFilter());
+        connect(act, &QAction::triggered, proxy, [proxy, what]{ proxy->setStatusFilter(what); });
+        view->addAction(act);
+    }
+    view->setContextMenuPolicy(Qt::ActionsContextMenu);
+}
+
 //===========================================================================
 void MainWindow::createActions()
 {
@@ -562,6 +681,20 @@ void MainWindow::createActions()
     connect(mDebugOnAction, &QAction::triggered, this, [this]{ setDebugMode(true); });
     connect(mDebugOffAction, &QAction::triggered, this, [this]{ setDebugMode(false); });
 
+    // timing of the stages on/off
+    mTimingAction = new QAction(tr("Timing"), this);
+    mTimingAction->setCheckable(true);
+    mTimingAction->setChecked(Timing::enabled());
+    mTimingAction->setStatusTip(tr("Time the stages of the loads and plots"));
+    connect(mTimingAction, &QAction::toggled, this, &MainWindow::setTimingMode);
+
+    // trace of the session on/off
+    mTracingAction = new QAction(tr("Tracing"), this);
+    mTracingAction->setCheckable(true);
+    mTracingAction->setChecked(Tracer::enabled());
+    mTracingAction->setStatusTip(tr("Record the fetches, parses, lookups, model builds and renders of all threads"));
+    connect(mTracingAction, &QAction::toggled, this, &MainWindow::setTracingMode);
+
     // actions
     QMetaEnum me = QMetaEnum::fromType<ActionOptions>();
     for (qint32 index = 0; index < me.keyCount(); index++) {
@@ -613,8 +746,9 @@ void MainWindow::createConsol()
     mLogConsolView->setWindowTitle("Debugger Consol");
     connect(Logger::instance(), SIGNAL(messageReceived(QString)), mLogConsol,SLOT(setMessage(QString)));
 
-    // direct the log info to the console
-//     qInstallMessageHandler(customMessageHandler);
+    // direct the log info to the console and to a rotating file, through the writer thread of the logger
+    Logger::instance()->start(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+                              "/ComputingResources.log");
 
     // wrap up
     setCentralWidget(mMdiArea);
@@ -630,12 +764,25 @@ void MainWindow::createMenu()
     // Create file Menu
        QMenu * fileMenu = menuBar()->addMenu(tr("&File"));
 
+       fileMenu->addAction(tr("&Export table..."), this, SLOT(exportTable()));
        fileMenu->addAction(tr("&Quit"), qApp, SLOT(closeAllWindows()), QKeySequence::Quit);
 
     // Debug
     mDebugMenu = menuBar()->addMenu(tr("&Debug"));
     mDebugMenu->addAction(mDebugOnAction);
     mDebugMenu->addAction(mDebugOffAction);
+    mDebugMenu->addSeparator();
+    mDebugMenu->addAction(mTimingAction);
+    mDebugMenu->addAction(tr("Print timing statistics"), this, SLOT(printTiming()));
+    mDebugMenu->addAction(tr("Reset timing statistics"), this, [] { Timing::instance().reset(); });
+    mDebugMenu->addSeparator();
+    mDebugMenu->addAction(mTracingAction);
+    mDebugMenu->addAction(tr("Save trace..."), this, SLOT(saveTrace()));
+    mDebugMenu->addSeparator();
+    mDebugMenu->addAction(tr("Print allocation statistics"), this, [this] {
+        mLogConsolView->setVisible(true);
+        Logger::write(AllocStats::report());
+    });
 
     // Load data
     QMenu *loMenu = menuBar()->addMenu(tr("Do various loads"));
@@ -654,38 +801,32 @@ void MainWindow::createMenu()
 }
 
 //===========================================================================
-void MainWindow::customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+void MainWindow::setTracingMode(bool val)
 {
-    // redifinition on how to handle log messages
+    // records the events of all threads from now on, a new trace forgets the previous one
 
-    QString txt;
-    switch (type) {
-    case QtDebugMsg:
-        txt = QString("Debug<%1-%2>: %3").arg(context.function).arg(context.line).arg(msg);
-        break;
-    case QtInfoMsg:
-        txt = QString("Info<%1>: %2").arg(context.function).arg(msg);
-        break;
-    case QtWarningMsg:
-        txt = QString("Warning<%1-%2>: %3").arg(context.function).arg(context.line).arg(msg);
-        break;
-    case QtCriticalMsg:
-        txt = QString("Critical:<%1-%2>: %3").arg(context.function).arg(context.line).arg(msg);
-        break;
-    case QtFatalMsg:
-        txt = QString("Fatal:<%1-%2>: %3").arg(context.function).arg(context.line).arg(msg);
-        abort();
-    }
+    if (val)
+        Tracer::instance().start();
+    else
+        Tracer::instance().stop();
+}
 
-   Logger::write(txt);
+//===========================================================================
+void MainWindow::setTimingMode(bool val)
+{
+    // times the stages of the loads and plots, a summary line is written to the console after each operation
 
+    Timing::setEnabled(val);
+    if (val)
+        mLogConsolView->setVisible(true);
 }
 
 //===========================================================================
 void MainWindow::setDebugMode(bool val)
 {
-   // set debug mode on/off
+   // set debug mode on/off, the debug messages of the categories follow
     mDebug = val;
+    Logger::setDebug(val);
     if (mDebug) {
         mDebugOnAction->setText("✓ On");
         mDebugOffAction->setText("Off");
@@ -697,6 +838,23 @@ void MainWindow::setDebugMode(bool val)
     }
 }
 
+//===========================================================================
+void MainWindow::warmUp()
+{
+    // off the critical path of the startup: the dictionary is read by a worker,
+    // the collaboration and its model are made in the GUI thread they belong to, once the window is painted
+    // the network managers are made by their first download
+
+    TaskScheduler::instance().post(TaskScheduler::kPrefetch, Q_NULLPTR, [] {
+        TIMED_SCOPE("startup: naming");
+        Naming::instance();
+    });
+    QTimer::singleShot(0, this, [] {
+        TIMED_SCOPE("startup: model");
+        ALICE::instance();
+    });
+}
+
 //===========================================================================
 void MainWindow::doOffenders(const QString &year)
 {
@@ -708,32 +866,49 @@ void MainWindow::doOffenders(const QString &year)
         mOffTableConsolView->close();
     }
 
-    QSortFilterProxyModel *proxymodel = new QSortFilterProxyModel;
-    proxymodel->setSourceModel(ALICE::instance().getModel());
-
     mOffTableConsol = new QTableView(mMdiArea);
-    mOffTableConsol->setModel(proxymodel);
+
+    mOffProxy = new FASortProxyModel(mOffTableConsol);
+    mOffProxy->setSourceModel(ALICE::instance().getModel());
+    mOffTableConsol->setModel(mOffProxy);
 
     mOffTableConsol->setAttribute(Qt::WA_DeleteOnClose);
     mOffTableConsol->setWindowTitle(QString(tr("Due ressources in %1 (pledget-required)")).arg(year));
     mOffTableConsol->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    mOffTableConsol->setModel(ALICE::instance().getModel());
-    mOffTableConsol->resizeColumnsToContents();
+    resizeVisibleColumns(mOffTableConsol);
     mOffTableConsol->horizontalHeader()->setStretchLastSection(true);
     mOffTableConsol->activateWindow();
     mOffTableConsol->setAlternatingRowColors(true);
     mOffTableConsolView = mMdiArea->addSubWindow(mOffTableConsol);
     mOffTableConsolView->setVisible(true);
 
-    mOffTableConsol->setSortingEnabled(true);
+    mOffTableConsol->horizontalHeader()->setSortIndicatorShown(true);
 
     connect(mOffTableConsol, SIGNAL(clicked(QModelIndex)), this, SLOT(resizeViewOff()));
 
-    // sort the table following hit column when header is clicked
+    // sort the table following hit column when header is clicked, shift+click adds a sort column
     connect(mOffTableConsol->horizontalHeader(), SIGNAL(sectionClicked(int)), this, SLOT(sortColumn(int)));
 
-    // read M&O information from glance
-    ALICE::instance().doOffenders(year);
+    // show all, MS or NMS funding agencies
+    addStatusFilterActions(mOffTableConsol, mOffProxy);
+
+    // read M&O information from glance, the pledges and the requirements in the ingestion thread
+    QSharedPointer<ALICE::Table> table(new ALICE::Table);
+    QSharedPointer<ALICE::YearReports> reports(new ALICE::YearReports);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("the reports of %1").arg(year),
+                                  [year, reports]{ *reports = ALICE::instance().downloadYearReports(year); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "glance, REBUS and the requirements",
+                                  [year, reports]{ ALICE::instance().parseYearReports(year, *reports); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, QString("the due resources of %1").arg(year),
+                                  [table]{ *table = ALICE::instance().offendersTable(); return true; });
+    ingest(QString("Collecting the due resources of %1").arg(year), steps, [table](bool ok) {
+        if (!ok) // cancelled or failed, the model keeps the table it shows
+            return;
+        TIMED_SCOPE("doOffenders: model");
+        ALLOC_SCOPE(AllocStats::kTable);
+        ALICE::instance().getModel()->setTable(FATableModel::kOffenders, *table);
+    }, mOffTableConsolView);
 }
 
 //===========================================================================
@@ -750,8 +925,10 @@ void MainWindow::doeReqAndPle(const QString &year)
     mTableConsol->setAttribute(Qt::WA_DeleteOnClose);
     mTableConsol->setWindowTitle(QString(tr("Ressources in %1")).arg(year));
     mTableConsol->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    mTableConsol->setModel(ALICE::instance().getModel());
-    mTableConsol->resizeColumnsToContents();
+    mTableProxy = new FASortProxyModel(mTableConsol);
+    mTableProxy->setSourceModel(ALICE::instance().getModel());
+    mTableConsol->setModel(mTableProxy);
+    resizeVisibleColumns(mTableConsol);
     mTableConsol->horizontalHeader()->setStretchLastSection(true);
     mTableConsol->activateWindow();
     mTableConsol->setAlternatingRowColors(true);
@@ -759,8 +936,27 @@ void MainWindow::doeReqAndPle(const QString &year)
     mTableConsolView->setVisible(true);
     connect(mTableConsol, SIGNAL(clicked(QModelIndex)), this, SLOT(resizeView()));
 
-    // hide the column when header is clicked
-    connect(mTableConsol->horizontalHeader(), SIGNAL(sectionClicked(int)), mTableConsol, SLOT(hideColumn(int)));
+    // sort the table following hit column when header is clicked, shift+click adds a sort column
+    mTableConsol->horizontalHeader()->setSortIndicatorShown(true);
+    connect(mTableConsol->horizontalHeader(), SIGNAL(sectionClicked(int)), this, SLOT(sortColumn(int)));
+
+    // hide the column from the context menu of the header
+    QTableView *view = mTableConsol;
+    view->horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(view->horizontalHeader(), &QHeaderView::customContextMenuRequested, view, [view](const QPoint &pos) {
+        QHeaderView *header = view->horizontalHeader();
+        qint32 col = header->logicalIndexAt(pos);
+        QMenu menu;
+        if (col != -1) {
+            QString title = view->model()->headerData(col, Qt::Horizontal).toString();
+            menu.addAction(QString("hide %1").arg(title), view, [view, col]{ view->hideColumn(col); });
+        }
+        menu.addAction("show all columns", view, [view, header]{
+            for (qint32 index = 0; index < header->count(); index++)
+                view->showColumn(index);
+        });
+        menu.exec(header->mapToGlobal(pos));
+    });
 
     // hide the row when row number is clicked
     connect(mTableConsol->verticalHeader(), SIGNAL(sectionClicked(int)), mTableConsol, SLOT(hideRow(int)));
@@ -768,12 +964,59 @@ void MainWindow::doeReqAndPle(const QString &year)
     // popup a window with the clicked funding agency
     connect(mTableConsol, SIGNAL(clicked(const QModelIndex &)), this, SLOT(onTableClicked(const QModelIndex &)));
 
-    //FixME usefull or not ?
-    mTableConsol->addAction(new QAction("Salut"));
-    mTableConsol->setContextMenuPolicy(Qt::ActionsContextMenu);
+    // show all, MS or NMS funding agencies
+    addStatusFilterActions(mTableConsol, mTableProxy);
+
+    // read M&O information from glance, the pledges and the requirements in the ingestion thread
+    QSharedPointer<ALICE::Table> table(new ALICE::Table);
+    QSharedPointer<ALICE::YearReports> reports(new ALICE::YearReports);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("the reports of %1").arg(year),
+                                  [year, reports]{ *reports = ALICE::instance().downloadYearReports(year); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "glance, REBUS and the requirements",
+                                  [year, reports]{ ALICE::instance().parseYearReports(year, *reports); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, QString("the resources of %1").arg(year),
+                                  [table]{ *table = ALICE::instance().reqAndPleTable(); return true; });
+    ingest(QString("Collecting the resources of %1").arg(year), steps, [table](bool ok) {
+        if (!ok) // cancelled or failed, the model keeps the table it shows
+            return;
+        TIMED_SCOPE("doReqAndPle: model");
+        ALLOC_SCOPE(AllocStats::kTable);
+        ALICE::instance().getModel()->setTable(FATableModel::kReqAndPle, *table);
+    }, mTableConsolView);
+}
+
+//===========================================================================
+void MainWindow::ingest(const QString &title, const QList<IngestPipeline::Step> &steps, IngestPipeline::Done done, QObject *owner)
+{
+    // runs steps in the ingestion thread, the progress window follows their completion
+    // and done is called back in the GUI thread
+    // owner is the window showing the result, its job passes first while it is the active window
 
-    // read M&O information from glance
-    ALICE::instance().doReqAndPle(year);
+    setProgressBar(true);
+    mDownLoadText->setText(title);
+    mIngesting++;
+    TaskScheduler::Priority priority = owner && owner == mMdiArea->activeSubWindow() ? TaskScheduler::kVisible : TaskScheduler::kNormal;
+    QElapsedTimer elapsed;
+    elapsed.start();
+    Timing::Totals before = Timing::enabled() ? Timing::instance().totals() : Timing::Totals();
+    IngestPipeline::instance().run(title, steps, [this, done, title, elapsed, before](bool ok) {
+        done(ok);
+        if (Timing::enabled()) // the stages of the loads running at the same time are mixed
+            Logger::write(Timing::instance().summary(title, elapsed.nsecsElapsed(), before));
+        loadDone();
+    }, owner, priority);
+}
+
+//===========================================================================
+void MainWindow::loadDone()
+{
+    // an ingestion job or a download started here is over, the progress window closes with the last one
+
+    if (--mIngesting == 0) {
+        mCancelled = false;
+        setProgressBar(false);
+    }
 }
 
 //===========================================================================
@@ -908,6 +1151,8 @@ void MainWindow::plBarchart(Resources::Resources_type type)
 {
     // Draw a bar chart for Pledged/Required/Used per year
 
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
     QString swhat = me.key(type);
     swhat.remove(0, 1);
@@ -933,79 +1178,103 @@ void MainWindow::plBarchart(Resources::Resources_type type)
     headers.replace(colUsed, "Used");
     model->setHeader(headers);
 
-    setProgressBar();
-    int progressCount = 0;
-
-    QVector<double> *dataVec = new QVector<double>(columns - 2);
-    QStringList categories;
-    double valuemax = 0.0;
-    QDate date = mDEStart->date();
-    for (int year = mDEStart->date().year(); year <= mDEEnd->date().year(); year++) {
-        categories.append(QString::number(year));
-        double value = ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(year));
-        if (value > valuemax)
-            valuemax = value;
-        dataVec->replace(colPledged - 2, value);
-        value = ALICE::instance().getRequired(Tier::kTOTS, type, QString::number(year));
-        if (value > valuemax)
-            valuemax = value;
-        dataVec->replace(colRequired - 2, value);
-        double used = 0.01;
-        int    weight = 1;
-        int months = date.daysTo(mDEEnd->date()) / 30;
-        while (date < QDate(year+1, 4, 1) && date <= mDEEnd->date()) { // year goes from april year to march year+1
-//            while (date <= QDate(year, 12, 31) && date <= mDEEnd->date()) { // year goes from january to december
-            transferProgress(progressCount++, months);
-             value = ALICE::instance().getUsed(Tier::kT0,   type, date) +
-                     ALICE::instance().getUsed(Tier::kT1,   type, date) +
-                     ALICE::instance().getUsed(Tier::kT2,   type, date) +
-                     ALICE::instance().getDiskBuffer();
-            if(value < 0) {
-                setProgressBar(false);
-                QMessageBox message;
-                message.setText(QString("No report found for %1 %2").arg(swhat).arg(date.toString("MM.yyyy")));
-                message.exec();
-                break;
-            }
-            if (value > valuemax)
-                valuemax = value;
-
-            switch (type) {
-            case Resources::kCPU:
-            {
-                used += value;
-                weight++;
-                break;
-            }
-            case Resources::kDISK:
-            {
-                if (used < value)
-                    used = value;
-                break;
-            }
-            case Resources::kTAPE:
-            {
-                if (used < value)
-                    used = value;
-                break;
-            }
-            default:
-                break;
+    // the values are collected in the ingestion thread, one step per year, the chart is drawn when they are all there
+    QSharedPointer<QMap<qint32, QVector<double> > > values(new QMap<qint32, QVector<double> >);
+    QSharedPointer<double> valuemax(new double(0.0));
+    QSharedPointer<QDate> missing(new QDate);
+    QList<IngestPipeline::Step> steps;
+    QDate dateS = mDEStart->date();
+    QDate dateE = mDEEnd->date();
+    for (int year = dateS.year(); year <= dateE.year(); year++) {
+        steps << IngestPipeline::step(IngestPipeline::kAggregate, QString::number(year), [=]{
+            TIMED_SCOPE("plBarchart: year");
+            QVector<double> dataVec(columns - 2);
+            double value = ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(year));
+            if (value > *valuemax)
+                *valuemax = value;
+            dataVec.replace(colPledged - 2, value);
+            value = ALICE::instance().getRequired(Tier::kTOTS, type, QString::number(year));
+            if (value > *valuemax)
+                *valuemax = value;
+            dataVec.replace(colRequired - 2, value);
+            double used = 0.01;
+            int    weight = 1;
+            bool   found  = true;
+            QDate date = year == dateS.year() ? dateS : QDate(year, 4, 1);
+            while (date < QDate(year+1, 4, 1) && date <= dateE) { // year goes from april year to march year+1
+//            while (date <= QDate(year, 12, 31) && date <= dateE) { // year goes from january to december
+                 value = ALICE::instance().getUsed(Tier::kT0,   type, date) +
+                         ALICE::instance().getUsed(Tier::kT1,   type, date) +
+                         ALICE::instance().getUsed(Tier::kT2,   type, date) +
+                         ALICE::instance().getDiskBuffer();
+                if(value < 0) {
+                    *missing = date;
+                    found = false;
+                    break;
+                }
+                if (value > *valuemax)
+                    *valuemax = value;
+
+                switch (type) {
+                case Resources::kCPU:
+                {
+                    used += value;
+                    weight++;
+                    break;
+                }
+                case Resources::kDISK:
+                {
+                    if (used < value)
+                        used = value;
+                    break;
+                }
+                case Resources::kTAPE:
+                {
+                    if (used < value)
+                        used = value;
+                    break;
+                }
+                default:
+                    break;
+                }
+
+                date = date.addMonths(1);
             }
 
-            date = date.addMonths(1);
+            dataVec.replace(colUsed - 2, used/weight);
+            values->insert(year, dataVec);
+            return found;
+        });
+    }
+
+    ingest(QString("Collecting the %1 pledged, required and used").arg(swhat), steps, [=](bool ok) {
+        QStringList categories;
+        for (QMap<qint32, QVector<double> >::const_iterator it = values->constBegin(); it != values->constEnd(); ++it) {
+            categories.append(QString::number(it.key()));
+            model->addData(QString::number(it.key()), it.value());
         }
+        if (!ok && missing->isValid() && !mCancelled) {
+            QMessageBox message;
+            message.setText(QString("No report found for %1 %2").arg(swhat).arg(missing->toString("MM.yyyy")));
+            message.exec();
+        }
+        if (model->isEmpty()) // no data found
+            return;
+        drawBarchart(type, model, categories, *valuemax);
+    });
+}
 
-//        if (used != -1) {
-            dataVec->replace(colUsed - 2, used/weight);
-            model->addData(QString::number(year), dataVec);
-//        }
-    }
+//===========================================================================
+void MainWindow::drawBarchart(Resources::Resources_type type, PlTableModel *model, const QStringList &categories, double valuemax)
+{
+    // draws the bar chart collected by plBarchart
 
-    if (model->isEmpty()) // no data found
-        return;
+    TIMED_SCOPE("drawBarchart");
+    ALLOC_SCOPE(AllocStats::kPlot);
 
-    setProgressBar(false);
+    QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
+    QString swhat = me.key(type);
+    swhat.remove(0, 1);
 
     QTableView *tableView = new QTableView;
     tableView->setModel(model);
@@ -1035,14 +1304,13 @@ void MainWindow::plBarchart(Resources::Resources_type type)
     chart->setTitle(title);
 
     QBarSeries *series = new QBarSeries;
-    int first = 0;
-    QVBarModelMapper *mapper = new QVBarModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setFirstBarSetColumn(2);
-    mapper->setLastBarSetColumn(4);
-    mapper->setFirstRow(first);
-    mapper->setRowCount(rows);
-    mapper->setSeries(series);
+    QList<QBarSet*> sets;
+    for (qint32 col = 2; col <= 4; col++) {
+        QBarSet *set = new QBarSet(model->headerData(col, Qt::Horizontal).toString());
+        SeriesBuilder::bind(set, model, col);
+        sets.append(set);
+    }
+    series->append(sets);
     chart->addSeries(series);
 
      QBarCategoryAxis *xaxis = new QBarCategoryAxis();
@@ -1088,6 +1356,84 @@ void MainWindow::plBarchart(Resources::Resources_type type)
      allTogether->setStyleSheet("background-color:white");
 }
 
+//===========================================================================
+void MainWindow::plHeatmap(Resources::Resources_type type)
+{
+    // used over pledged resources per funding agency (rows) and per month (columns)
+    // the pledges and the monthly reports missing in the ledger are read first
+
+    ALLOC_SCOPE(AllocStats::kPlot);
+
+    QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
+    QString swhat = me.key(type);
+    swhat.remove(0, 1); // removes the "k"
+
+    UsageLedger::Quantity quantity = UsageLedger::kCPU;
+    if (type == Resources::kDISK)
+        quantity = UsageLedger::kDiskML;
+    else if (type == Resources::kTAPE)
+        quantity = UsageLedger::kTapeML;
+
+    // the ledger is filled in the ingestion thread, one step per month; the heatmap is shown when the months are known
+    QSharedPointer<QList<QDate> > months(new QList<QDate>);
+    QSharedPointer<QDate> missing(new QDate);
+    QList<IngestPipeline::Step> steps;
+    for (QDate date = QDate(mDEStart->date().year(), mDEStart->date().month(), 1); date <= mDEEnd->date(); date = date.addMonths(1)) {
+        steps << IngestPipeline::step(IngestPipeline::kAggregate, date.toString("MM.yyyy"), [=]{
+            TIMED_SCOPE("plHeatmap: month");
+            ALICE::instance().setDrawTable(false);
+            ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(date.year()));
+            bool found = ALICE::instance().ledger().contains(date) || ALICE::instance().getUsed(Tier::kTOTS, type, date) >= 0;
+            ALICE::instance().setDrawTable(true);
+            if (!found) {
+                *missing = date;
+                return false;
+            }
+            months->append(date);
+            return true;
+        });
+    }
+
+    ingest(QString("Collecting the %1 used and pledged").arg(swhat), steps, [=](bool ok) {
+        if (!ok && missing->isValid() && !mCancelled) {
+            QMessageBox message;
+            message.setText(QString("No report found for %1 %2").arg(swhat).arg(missing->toString("MM.yyyy")));
+            message.exec();
+        }
+        drawHeatmap(type, quantity, *months);
+    });
+}
+
+//===========================================================================
+void MainWindow::drawHeatmap(Resources::Resources_type type, UsageLedger::Quantity quantity, const QList<QDate> &months)
+{
+    // shows the heatmap collected by plHeatmap
+
+    TIMED_SCOPE("drawHeatmap");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
+    QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
+    QString swhat = me.key(type);
+    swhat.remove(0, 1); // removes the "k"
+
+    QString title = QString("%1 used/pledged per funding agency").arg(swhat);
+    for (QMdiSubWindow *sw : mMdiArea->subWindowList())
+        if(sw->windowTitle() == title) {
+            mMdiArea->removeSubWindow(sw);
+            sw->close();
+        }
+
+    HeatmapWidget *heatmap = new HeatmapWidget(&ALICE::instance().ledger(), quantity);
+    heatmap->setAttribute(Qt::WA_DeleteOnClose);
+    heatmap->setWindowTitle(title);
+    heatmap->setMinimumSize(640, 480);
+    heatmap->setRows(ALICE::instance().ledger().fundingAgencies());
+    heatmap->setMonths(months);
+    connect(&ALICE::instance(), &ALICE::ledgerChanged, heatmap, &HeatmapWidget::invalidate);
+
+    mMdiArea->addSubWindow(heatmap)->show();
+}
+
 //===========================================================================
 void MainWindow::plot(qint32 opt)
 {
@@ -1123,7 +1469,6 @@ void MainWindow::plot(qint32 opt)
         break;
     case kEventSizeProfile:
         getDataFromFile(kEventSizeProfile);
-        plProfileEventSize();
         break;
     case kPledgedRequiredUsed:
         selectDates(kPledgedRequiredUsed, QDate(2025, 1, 1));
@@ -1131,6 +1476,9 @@ void MainWindow::plot(qint32 opt)
     case kCPUUserShareProfile:
         selectDates(kCPUUserShareProfile);
         break;
+    case kUsage_PledgesHeatmap:
+        selectDates(kUsage_PledgesHeatmap);
+        break;
     default:
         break;
    }
@@ -1144,6 +1492,9 @@ void MainWindow::plRegisteredData(PlotOptions opt)
     //      column 0 is a date (imn ms since...) for x axis and
     //      colums 1,.... are the y values
 
+    TIMED_SCOPE("plRegisteredData");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     // the data are in mPLData
 
 
@@ -1175,23 +1526,38 @@ void MainWindow::plRegisteredData(PlotOptions opt)
 
     QDateTime today(QDate::currentDate());
     double xmin = today.toMSecsSinceEpoch();
+
+    // the stacked layers at full resolution, each one on top of the previous
+    QVector<QVector<QPointF> > layers(columns);
     for (qint32 col = 1; col < columns; col++) {
-        QLineSeries *upperSeries = new QLineSeries();
+        QVector<QPointF> &points = layers[col];
+        points.reserve(rows);
         for (qint32 irow = 0; irow < rows; irow++) {
             QVector<double> *row = mPlData.at(irow);
             double x = row->at(0);
             if (x < xmin)
                 xmin = x;
-            double y;
-            if (lowerSeries) {
-                const QVector<QPointF>& points = lowerSeries->pointsVector();
-                y = points[irow].y() + row->at(col) / 1E9; //change to PB
-            } else
-                y = row->at(col) / 1E9; //change to PB
-            if (y > ymax)
-                ymax = y;
-            upperSeries->append(x, y);
+            double y = row->at(col) / 1E9; //change to PB
+            if (col > 1)
+                y += layers.at(col - 1).at(irow).y();
+            points.append(QPointF(x, y));
         }
+    }
+
+    // the points are selected on the top layer and the same ones are kept in all layers
+    // so that the areas stay stacked
+    QVector<qint32> indices = Downsampler::indices(layers.last(), Downsampler::threshold(this));
+
+    QVector<QXYSeries*> uppers;
+    QVector<TimeSeriesPyramid> pyramids;
+    for (qint32 col = 1; col < columns; col++) {
+        QLineSeries *upperSeries = new QLineSeries();
+        upperSeries->replace(Downsampler::select(layers.at(col), indices));
+        uppers.append(upperSeries);
+        pyramids.append(TimeSeriesPyramid(layers.at(col)));
+        for (const QPointF &point : layers.at(col))
+            if (point.y() > ymax)
+                ymax = point.y();
 
         QAreaSeries *area = new QAreaSeries(upperSeries, lowerSeries);
         chart->addSeries(area);
@@ -1219,12 +1585,13 @@ void MainWindow::plRegisteredData(PlotOptions opt)
             mMdiArea->removeSubWindow(sw);
             sw->close();
         }
-    QChartView *chartView = new QChartView();
+    ZoomChartView *chartView = new ZoomChartView();
     chartView->setAttribute(Qt::WA_DeleteOnClose);
     chartView->setWindowTitle(title);
     chartView->setRenderHint(QPainter::Antialiasing);
     chartView->setMinimumSize(640, 480);
     chartView->setChart(chart);
+    chartView->addStack(uppers, pyramids);
 
     mMdiArea->addSubWindow(chartView)->show();
 }
@@ -1237,6 +1604,9 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
     //      column 0 is a date (imn ms since...) for x axis and
     //      colums 1,.... are the y values
 
+    TIMED_SCOPE("plTierEfficiency");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     // the data are in mPLData
     // the name of colums are in mPLDataName
 
@@ -1265,12 +1635,13 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
 
     QVector<Tier::TierCat> tcat(mPlDataName.size() - 1); // omit the time column
     qint32 colIndex = 0;
+    ModelSnapshotPtr model = ALICE::instance().snapshot(); // the sites loaded by getDataFromWeb
     for (QString ce : mPlDataName) {
-        Tier *t = ALICE::instance().search(ce);
-        if (!t) {
+        const ModelSnapshot::Site *site = model->site(ce);
+        if (!site) {
             tcat.insert(colIndex, Tier::kT2);
         } else {
-            Tier::TierCat cat = t->category();
+            Tier::TierCat cat = site->category;
             tcat.insert(colIndex, cat);
         }
         colIndex++;
@@ -1285,12 +1656,12 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
     QLineSeries *seriesT2 = new QLineSeries;
     seriesT2->setName("T2");
 
-    QVector<double> *avEffTiers = new QVector<double>(3);
+    QVector<double> avEffTiers(3);
     QVector<qint32> avNormTiers(3);
 
-    avEffTiers->replace(Tier::kT0, 0.0);
-    avEffTiers->replace(Tier::kT1, 0.0);
-    avEffTiers->replace(Tier::kT2, 0.0);
+    avEffTiers.replace(Tier::kT0, 0.0);
+    avEffTiers.replace(Tier::kT1, 0.0);
+    avEffTiers.replace(Tier::kT2, 0.0);
     avNormTiers.replace(Tier::kT0, 0);
     avNormTiers.replace(Tier::kT1, 0);
     avNormTiers.replace(Tier::kT2, 0);
@@ -1301,6 +1672,11 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
     QVector<double> effTiers(3);
     QVector<qint32> normTiers(3);
 
+    // the full resolution points, downsampled when given to the series
+    QVector<QPointF> pointsT0, pointsT1, pointsT2;
+    pointsT0.reserve(mPlData.size());
+    pointsT1.reserve(mPlData.size());
+    pointsT2.reserve(mPlData.size());
 
     for (QVector<double> *valVec : mPlData) {
         effTiers.replace(Tier::kT0, 0.0);
@@ -1318,27 +1694,32 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
             if ( val > 0.0) {
                 effTiers.replace(cat, effTiers.at(cat) + val);
                 normTiers.replace(cat, normTiers.at(cat) + 1);
-                avEffTiers->replace(cat, avEffTiers->at(cat) + val);
+                avEffTiers.replace(cat, avEffTiers.at(cat) + val);
                 avNormTiers.replace(cat, avNormTiers.at(cat) + 1);
             }
         }
         if (normTiers.at(Tier::kT0) > 0) {
             effTiers.replace(Tier::kT0, effTiers.at(Tier::kT0) / normTiers.at(Tier::kT0));
-            seriesT0->append(x, effTiers.at(Tier::kT0));
+            pointsT0.append(QPointF(x, effTiers.at(Tier::kT0)));
         }
         if (normTiers.at(Tier::kT1) > 0) {
             effTiers.replace(Tier::kT1, effTiers.at(Tier::kT1) / normTiers.at(Tier::kT1));
-            seriesT1->append(x, effTiers.at(Tier::kT1));
+            pointsT1.append(QPointF(x, effTiers.at(Tier::kT1)));
         }
         if (normTiers.at(Tier::kT1) > 1) {
             effTiers.replace(Tier::kT2, effTiers.at(Tier::kT2) / normTiers.at(Tier::kT2));
-            seriesT2->append((qint64)x, effTiers.at(Tier::kT2));
+            pointsT2.append(QPointF((qint64)x, effTiers.at(Tier::kT2)));
         }
     }
 
-    avEffTiers->replace(Tier::kT0, avEffTiers->at(Tier::kT0) / avNormTiers.at(Tier::kT0));
-    avEffTiers->replace(Tier::kT1, avEffTiers->at(Tier::kT1) / avNormTiers.at(Tier::kT1));
-    avEffTiers->replace(Tier::kT2, avEffTiers->at(Tier::kT2) / avNormTiers.at(Tier::kT2));
+    qint32 threshold = Downsampler::threshold(this);
+    seriesT0->replace(Downsampler::downsample(pointsT0, threshold));
+    seriesT1->replace(Downsampler::downsample(pointsT1, threshold));
+    seriesT2->replace(Downsampler::downsample(pointsT2, threshold));
+
+    avEffTiers.replace(Tier::kT0, avEffTiers.at(Tier::kT0) / avNormTiers.at(Tier::kT0));
+    avEffTiers.replace(Tier::kT1, avEffTiers.at(Tier::kT1) / avNormTiers.at(Tier::kT1));
+    avEffTiers.replace(Tier::kT2, avEffTiers.at(Tier::kT2) / avNormTiers.at(Tier::kT2));
 
     PlTableModel *model = new PlTableModel();
     model->setColRow(5, 1);
@@ -1367,12 +1748,15 @@ void MainWindow::plTierEfficiency(PlotOptions opt)
 
     QString title("Tier Efficiency Profile");
 
-    QChartView *chartView = new QChartView();
+    ZoomChartView *chartView = new ZoomChartView();
     chartView->setAttribute(Qt::WA_DeleteOnClose);
     chartView->setWindowTitle(title);
     chartView->setRenderHint(QPainter::Antialiasing);
     chartView->setMinimumSize(640, 480);
     chartView->setChart(chart);
+    chartView->addSeries(seriesT0, TimeSeriesPyramid(pointsT0));
+    chartView->addSeries(seriesT1, TimeSeriesPyramid(pointsT1));
+    chartView->addSeries(seriesT2, TimeSeriesPyramid(pointsT2));
 
     QTableView *tableView = new QTableView;
     tableView->setModel(model);
@@ -1411,6 +1795,9 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
     //      column 0 is a date (imn ms since...) for x axis and
     //      colums 1,.... are the y values
 
+    TIMED_SCOPE("plUserEfficiency");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     // the data are in mPLData
 
     QChart *chart = new QChart();
@@ -1464,13 +1851,13 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
     QLineSeries *seriesUsers = new QLineSeries;
     seriesUsers->setName("Users Analysis");
 
-    QVector<double> *avEffUsers = new QVector<double>(ALICE::kAliUsers + 1);
+    QVector<double> avEffUsers(ALICE::kAliUsers + 1);
     QVector<qint32> avNormUsers(ALICE::kAliUsers + 1);
 
-    avEffUsers->replace(ALICE::kAliDaq,   0.0);
-    avEffUsers->replace(ALICE::kAliProd,  0.0);
-    avEffUsers->replace(ALICE::kAliTrain, 0.0);
-    avEffUsers->replace(ALICE::kAliUsers, 0.0);
+    avEffUsers.replace(ALICE::kAliDaq,   0.0);
+    avEffUsers.replace(ALICE::kAliProd,  0.0);
+    avEffUsers.replace(ALICE::kAliTrain, 0.0);
+    avEffUsers.replace(ALICE::kAliUsers, 0.0);
     avNormUsers.replace(ALICE::kAliDaq,   0);
     avNormUsers.replace(ALICE::kAliProd,  0);
     avNormUsers.replace(ALICE::kAliTrain, 0);
@@ -1482,6 +1869,13 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
     QVector<qint32> normUsers(ALICE::kAliUsers + 1);
     QVector<double> effUsers(ALICE::kAliUsers  + 1);
 
+    // the full resolution points, downsampled when given to the series
+    QVector<QPointF> pointsDaq, pointsProd, pointsTrain, pointsUsers;
+    pointsDaq.reserve(mPlData.size());
+    pointsProd.reserve(mPlData.size());
+    pointsTrain.reserve(mPlData.size());
+    pointsUsers.reserve(mPlData.size());
+
     for (QVector<double> *valVec : mPlData) {
         effUsers.replace(ALICE::kAliDaq,   0.0);
         effUsers.replace(ALICE::kAliProd,  0.0);
@@ -1500,32 +1894,38 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
             if ( val > 0.0) {
                 effUsers.replace(user, effUsers.at(user) + val);
                 normUsers.replace(user, normUsers.at(user) + 1);
-                avEffUsers->replace(user, avEffUsers->at(user) + val);
+                avEffUsers.replace(user, avEffUsers.at(user) + val);
                 avNormUsers.replace(user, avNormUsers.at(user) + 1);
             }
         }
         if (normUsers.at(ALICE::kAliDaq) > 0) {
             effUsers.replace(ALICE::kAliDaq, effUsers.at(ALICE::kAliDaq) / normUsers.at(ALICE::kAliDaq));
-            seriesDaq->append(x, effUsers.at(ALICE::kAliDaq));
+            pointsDaq.append(QPointF(x, effUsers.at(ALICE::kAliDaq)));
         }
         if (normUsers.at(ALICE::kAliProd) > 0) {
             effUsers.replace(ALICE::kAliProd, effUsers.at(ALICE::kAliProd) / normUsers.at(ALICE::kAliProd));
-            seriesProd->append(x, effUsers.at(ALICE::kAliProd));
+            pointsProd.append(QPointF(x, effUsers.at(ALICE::kAliProd)));
         }
         if (normUsers.at(ALICE::kAliTrain) > 0) {
             effUsers.replace(ALICE::kAliTrain, effUsers.at(ALICE::kAliTrain) / normUsers.at(ALICE::kAliTrain));
-            seriesTrain->append((qint64)x, effUsers.at(ALICE::kAliTrain));
+            pointsTrain.append(QPointF((qint64)x, effUsers.at(ALICE::kAliTrain)));
         }
         if (normUsers.at(ALICE::kAliUsers) > 0) {
             effUsers.replace(ALICE::kAliUsers, effUsers.at(ALICE::kAliUsers) / normUsers.at(ALICE::kAliUsers));
-            seriesUsers->append((qint64)x, effUsers.at(ALICE::kAliUsers));
+            pointsUsers.append(QPointF((qint64)x, effUsers.at(ALICE::kAliUsers)));
         }
     }
 
-    avEffUsers->replace(ALICE::kAliDaq, avEffUsers->at(ALICE::kAliDaq) / avNormUsers.at(ALICE::kAliDaq));
-    avEffUsers->replace(ALICE::kAliProd, avEffUsers->at(ALICE::kAliProd) / avNormUsers.at(ALICE::kAliProd));
-    avEffUsers->replace(ALICE::kAliTrain, avEffUsers->at(ALICE::kAliTrain) / avNormUsers.at(ALICE::kAliTrain));
-    avEffUsers->replace(ALICE::kAliUsers, avEffUsers->at(ALICE::kAliUsers) / avNormUsers.at(ALICE::kAliUsers));
+    qint32 threshold = Downsampler::threshold(this);
+    seriesDaq->replace(Downsampler::downsample(pointsDaq, threshold));
+    seriesProd->replace(Downsampler::downsample(pointsProd, threshold));
+    seriesTrain->replace(Downsampler::downsample(pointsTrain, threshold));
+    seriesUsers->replace(Downsampler::downsample(pointsUsers, threshold));
+
+    avEffUsers.replace(ALICE::kAliDaq, avEffUsers.at(ALICE::kAliDaq) / avNormUsers.at(ALICE::kAliDaq));
+    avEffUsers.replace(ALICE::kAliProd, avEffUsers.at(ALICE::kAliProd) / avNormUsers.at(ALICE::kAliProd));
+    avEffUsers.replace(ALICE::kAliTrain, avEffUsers.at(ALICE::kAliTrain) / avNormUsers.at(ALICE::kAliTrain));
+    avEffUsers.replace(ALICE::kAliUsers, avEffUsers.at(ALICE::kAliUsers) / avNormUsers.at(ALICE::kAliUsers));
 
     PlTableModel *model = new PlTableModel();
     model->setColRow(ALICE::kAliUsers + 3, 1);
@@ -1564,12 +1964,16 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
 
     QString title("Users Efficiency Profile");
 
-    QChartView *chartView = new QChartView();
+    ZoomChartView *chartView = new ZoomChartView();
     chartView->setAttribute(Qt::WA_DeleteOnClose);
     chartView->setWindowTitle(title);
     chartView->setRenderHint(QPainter::Antialiasing);
     chartView->setMinimumSize(640, 480);
     chartView->setChart(chart);
+    chartView->addSeries(seriesDaq,   TimeSeriesPyramid(pointsDaq));
+    chartView->addSeries(seriesProd,  TimeSeriesPyramid(pointsProd));
+    chartView->addSeries(seriesTrain, TimeSeriesPyramid(pointsTrain));
+    chartView->addSeries(seriesUsers, TimeSeriesPyramid(pointsUsers));
 
     QTableView *tableView = new QTableView;
     tableView->setModel(model);
@@ -1603,55 +2007,117 @@ void MainWindow::plUserEfficiency(PlotOptions opt)
 //===========================================================================
 void MainWindow:: getDataFromWeb(PlotOptions opt)
 {
-    // plot the registered data profile
-
-    setProgressBar(true);
-
-    QNetworkRequest request;
-    QSslConfiguration conf = request.sslConfiguration();
-    conf.setPeerVerifyMode(QSslSocket::VerifyNone);
-    request.setSslConfiguration(conf);
-    request.setUrl(mURL);
-
-    if (!mNetworkManager)
-        mNetworkManager = new QNetworkAccessManager(this);
-    QNetworkReply *reply = mNetworkManager->get(request);
-
+    // plot the MonALISA profiles; the csv file is downloaded and parsed in the ingestion thread
+
+    struct Parsed {
+        QList<QVector<double>*> data;  // the parsed rows
+        QList<QString>          names; // the parsed column names
+    };
+    QSharedPointer<QByteArray> csv(new QByteArray);
+    QSharedPointer<Parsed> parsed(new Parsed);
+    QUrl url(mURL);
+
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, url.host(), [url, csv]{
+                 *csv = Fetcher::instance().get(url).result();
+                 return !csv->isEmpty();
+             });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "the csv file", [opt, csv, parsed]{
+                 parsePlotUrlFile(opt, *csv, parsed->data, parsed->names);
+                 csv->clear();
+                 return !parsed->data.isEmpty();
+             });
+
+    if (opt == kTierEfficiencyProfile) // the tier of each site is read from the snapshot of ALICE
+        steps << IngestPipeline::step(IngestPipeline::kAggregate, "the sites", []{
+                     ALICE::instance().initFAs();
+                     return true;
+                 });
+
+    ingest(QString("Downloading from %1").arg(mURL), steps, [this, opt, parsed](bool ok) {
+        if (!ok) {
+            qDeleteAll(parsed->data.begin(), parsed->data.end());
+            if (!mCancelled)
+                QMessageBox::warning(this, tr("MonALISA"), tr("No data received from MonALISA"));
+            return;
+        }
+        AllocStats::addLive(AllocStats::kPlotRow, parsed->data.size() - mPlData.size());
+        qDeleteAll(mPlData.begin(), mPlData.end());
+        mPlData     = parsed->data;
+        mPlDataName = parsed->names;
 
-    connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(transferProgress(qint64,qint64)));    
-    connect(reply, &QNetworkReply::finished, this, [opt, this]{ parsePlotUrlFile(opt); });
-    connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(showNetworkError(QNetworkReply::NetworkError)));
+        switch (opt) {
+        case kRegisteredDataProfile:
+            plRegisteredData(opt);
+            break;
+        case kTierEfficiencyProfile:
+            plTierEfficiency(kTierEfficiencyProfile);
+            break;
+        case kUserEfficiencyProfile:
+            plUserEfficiency(kUserEfficiencyProfile);
+            break;
+        case kPledgesProfile:
+            saveData(opt);
+            break;
+        case kEventSizeProfile:
+            plProfileEventSize();
+            break;
+        case kCPUUserShareProfile:
+            plUserEfficiency(kCPUUserShareProfile);
+            break;
+        default:
+            break;
+        }
+    });
 }
 
 //===========================================================================
 void MainWindow::getDataFromWeb(const QDate &date, Tier::TierCat cat)
 {
     // connect to the mURL and continue with saveURLFile when connection established
+    // the download is counted with the ingestion jobs, the progress window stays open until it is saved
 
     setProgressBar(true);
+    mIngesting++;
 
     QNetworkRequest request;
     QSslConfiguration conf = request.sslConfiguration();
     conf.setPeerVerifyMode(QSslSocket::VerifyNone);
     request.setSslConfiguration(conf);
-    request.setUrl(mURL);
+    QUrl url(mURL);
+    request.setUrl(Fetcher::resolve(url));
+
+    if (NetworkSession::instance().replaying()) {
+        QByteArray data;
+        qint64 latency = 0;
+        NetworkSession::instance().lookup(url, data, latency);
+        QTimer::singleShot(int(latency), this, [date, cat, data, this]{ saveUrlFile(date, cat, data); });
+        return;
+    }
 
     if (!mNetworkManager)
         mNetworkManager = new QNetworkAccessManager(this);
     QNetworkReply *reply = mNetworkManager->get(request);
-
+    qint64 asked = NetworkSession::instance().now();
 
     connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(transferProgress(qint64,qint64)));
     connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(showNetworkError(QNetworkReply::NetworkError)));
-    connect(reply, &QNetworkReply::finished, this, [date, cat, this]{ saveUrlFile(date, cat); });
+    connect(reply, &QNetworkReply::finished, this, [date, cat, url, asked, reply, this]{
+        QByteArray data = reply->readAll();
+        NetworkSession::instance().record(url, asked, NetworkSession::instance().now() - asked, data);
+        reply->deleteLater();
+        saveUrlFile(date, cat, data);
+    });
 }
 
 //===========================================================================
 void MainWindow::getDataFromWeb(const QDate &date, LoadOptions opt)
 {
     // connect to the mURL and continue with saveURLFile when connection established
+    // the download is counted with the ingestion jobs, the progress window stays open until it is saved
 
     setProgressBar(true);
+    mIngesting++;
 
     QNetworkRequest request;
 
@@ -1669,10 +2135,10 @@ void MainWindow::getDataFromWeb(const QDate &date, LoadOptions opt)
            QSslKey privateKey(&privateKeyFile, QSsl::Opaque);
            QSslCertificate certificate(&certificateFile);
 
-           qWarning() << QSslSocket::supportsSsl();
-           qWarning() << certificate.serialNumber();
-           qWarning() << certificate.subjectInfo(QSslCertificate::CommonName);
-           qWarning() << certificate.expiryDate();
+           qCDebug(lcNetwork) << QSslSocket::supportsSsl();
+           qCDebug(lcNetwork) << certificate.serialNumber();
+           qCDebug(lcNetwork) << certificate.subjectInfo(QSslCertificate::CommonName);
+           qCDebug(lcNetwork) << certificate.expiryDate();
 
            conf.setPrivateKey(privateKey);
            conf.setLocalCertificate(certificate);
@@ -1682,63 +2148,93 @@ void MainWindow::getDataFromWeb(const QDate &date, LoadOptions opt)
     }
 
     request.setSslConfiguration(conf);
-    request.setUrl(mURL);
+    QUrl url(mURL);
+    request.setUrl(Fetcher::resolve(url));
+
+    if (NetworkSession::instance().replaying()) {
+        QByteArray data;
+        qint64 latency = 0;
+        NetworkSession::instance().lookup(url, data, latency);
+        QTimer::singleShot(int(latency), this, [date, opt, data, this]{ saveUrlFile(date, opt, data); });
+        return;
+    }
 
     if (!mNetworkManager)
         mNetworkManager = new QNetworkAccessManager(this);
     QNetworkReply *reply = mNetworkManager->get(request);
+    qint64 asked = NetworkSession::instance().now();
 
-    qDebug() << Q_FUNC_INFO << mURL;
+    qCDebug(lcNetwork) << Q_FUNC_INFO << mURL;
 
     connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(transferProgress(qint64,qint64)));
     connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(showNetworkError(QNetworkReply::NetworkError)));
-    connect(reply, &QNetworkReply::finished, this, [date, opt, this]{ saveUrlFile(date, opt); });
+    connect(reply, &QNetworkReply::finished, this, [date, opt, url, asked, reply, this]{
+        QByteArray data = reply->readAll();
+        NetworkSession::instance().record(url, asked, NetworkSession::instance().now() - asked, data);
+        reply->deleteLater();
+        saveUrlFile(date, opt, data);
+    });
 
 }
 
 //===========================================================================
 void MainWindow::getDataFromFile(PlotOptions opt)
 {
-    // reads data from a local file into mPLData and mPLDataName
+    // reads data from a file of the ALICE web site into mPLData and mPLDataName, in the ingestion thread, then plots them
 
     switch (opt) {
     case kEventSizeProfile:
     {
-        mPlDataName.clear();
-        qDeleteAll(mPlData.begin(), mPlData.end());
-        mPlData.clear();
-        QString fileName("/data/EventSize.csv");
-        QByteArray dataA = ALICE::instance().getReportFromWeb(fileName);
-        if (dataA.isEmpty())
-            return;
-        QTextStream csvFile(&dataA);
-
-        // read headers in second line
-        QString line = csvFile.readLine();
-        line = csvFile.readLine();
-        QStringList strList = line.split(";");
-        // find the event size column
-        qint32 esColumn = -1;
-        for (qint32 index = 0; index < strList.size(); index++) {
-            QString str = strList.at(index);
-            if (str.contains("Event Size")) {
-                esColumn = index;
-                break;
-            }
-        }
-        while(!csvFile.atEnd()) {
+        struct Parsed {
+            QList<QVector<double>*> data;  // the event size per period
+            QList<QString>          names; // the periods
+        };
+        QSharedPointer<Parsed> parsed(new Parsed);
+        QList<IngestPipeline::Step> steps;
+        steps << IngestPipeline::step(IngestPipeline::kParse, "EventSize.csv", [parsed]{
+            QString fileName("/data/EventSize.csv");
+            QByteArray dataA = ALICE::instance().getReportFromWeb(fileName);
+            if (dataA.isEmpty())
+                return false;
+            QTextStream csvFile(&dataA);
+
+            // read headers in second line
+            QString line = csvFile.readLine();
             line = csvFile.readLine();
-            strList = line.split(";");
-            QString period(strList.at(0));
-            if (period.contains("LHC")) {
-                QVector<double> *dataVec = new QVector<double>(1);
-                mPlDataName.append(strList.at(0));
-                QString data = strList.at(esColumn);
-                data.replace(" ", "");
-                dataVec->replace(0, data.toDouble());
-                mPlData.append(dataVec);
+            QStringList strList = line.split(";");
+            // find the event size column
+            qint32 esColumn = -1;
+            for (qint32 index = 0; index < strList.size(); index++) {
+                QString str = strList.at(index);
+                if (str.contains("Event Size")) {
+                    esColumn = index;
+                    break;
+                }
             }
-        }
+            while(!csvFile.atEnd()) {
+                line = csvFile.readLine();
+                strList = line.split(";");
+                QString period(strList.at(0));
+                if (period.contains("LHC")) {
+                    QVector<double> *dataVec = new QVector<double>(1);
+                    parsed->names.append(strList.at(0));
+                    QString data = strList.at(esColumn);
+                    data.replace(" ", "");
+                    dataVec->replace(0, data.toDouble());
+                    parsed->data.append(dataVec);
+                }
+            }
+            return true;
+        });
+        ingest("Reading the event sizes", steps, [this, parsed](bool ok) {
+            if (!ok)
+                return;
+            AllocStats::addLive(AllocStats::kPlotRow, parsed->data.size() - mPlData.size());
+            qDeleteAll(mPlData.begin(), mPlData.end());
+            mPlData     = parsed->data;
+            mPlDataName = parsed->names;
+            plProfileEventSize();
+        });
         break;
     }
     default:
@@ -1751,6 +2247,8 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
 {
     // plot requirements CPU, Disk and tape as a function of year
 
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
     QString swhat = me.key(type);
     swhat.remove(0, 1); // removes the "k"
@@ -1776,78 +2274,105 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
     headers.replace(colTo, "Total");
     model->setHeader(headers);
 
-    setProgressBar();
-    int count = 0;
-
-    QVector<double> *dataVec = new QVector<double>(columns - 2);
+    // the values are collected in the ingestion thread, the plot is drawn when they are all there
+    QSharedPointer<QMap<QDate, QVector<double> > > values(new QMap<QDate, QVector<double> >);
+    QSharedPointer<QDate> missing(new QDate);
+    QList<IngestPipeline::Step> steps;
     QString xAxisFormat;
     QString xAxisTitle;
     if (opt == kRequirementsProfile || opt == kPledgesProfile) {
         xAxisFormat = "yyyy";
         xAxisTitle = "Year";
-        int years = mDEStart->date().daysTo(mDEEnd->date()) / 365;
         for (int year = mDEStart->date().year(); year <= mDEEnd->date().year(); year++) {
-            transferProgress(count++, years);
-            if (opt == kRequirementsProfile) {
-                dataVec->replace(colT0 - 2, ALICE::instance().getRequired(Tier::kT0,   type, QString::number(year)));
-                dataVec->replace(colT1 - 2, ALICE::instance().getRequired(Tier::kT1,   type, QString::number(year)));
-                dataVec->replace(colT2 - 2, ALICE::instance().getRequired(Tier::kT2,   type, QString::number(year)));
-                dataVec->replace(colTo - 2, ALICE::instance().getRequired(Tier::kTOTS, type, QString::number(year)));
-                model->addData(QString::number(year), dataVec);
-            } else if (opt == kPledgesProfile) {
-                dataVec->replace(colT0 - 2, ALICE::instance().getPledged(Tier::kT0,   type, QString::number(year)));
-                dataVec->replace(colT1 - 2, ALICE::instance().getPledged(Tier::kT1,   type, QString::number(year)));
-                dataVec->replace(colT2 - 2, ALICE::instance().getPledged(Tier::kT2,   type, QString::number(year)));
-                dataVec->replace(colTo - 2, ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(year)));
-                model->addData(QString::number(year), dataVec);
-            }
+            steps << IngestPipeline::step(IngestPipeline::kAggregate, QString::number(year), [=]{
+                TIMED_SCOPE("plProfile: year");
+                QVector<double> dataVec(columns - 2);
+                if (opt == kRequirementsProfile) {
+                    dataVec.replace(colT0 - 2, ALICE::instance().getRequired(Tier::kT0,   type, QString::number(year)));
+                    dataVec.replace(colT1 - 2, ALICE::instance().getRequired(Tier::kT1,   type, QString::number(year)));
+                    dataVec.replace(colT2 - 2, ALICE::instance().getRequired(Tier::kT2,   type, QString::number(year)));
+                    dataVec.replace(colTo - 2, ALICE::instance().getRequired(Tier::kTOTS, type, QString::number(year)));
+                } else if (opt == kPledgesProfile) {
+                    dataVec.replace(colT0 - 2, ALICE::instance().getPledged(Tier::kT0,   type, QString::number(year)));
+                    dataVec.replace(colT1 - 2, ALICE::instance().getPledged(Tier::kT1,   type, QString::number(year)));
+                    dataVec.replace(colT2 - 2, ALICE::instance().getPledged(Tier::kT2,   type, QString::number(year)));
+                    dataVec.replace(colTo - 2, ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(year)));
+                }
+                values->insert(QDate(year, 1, 1), dataVec);
+                return true;
+            });
         }
     } else if (opt == kUsageProfile || opt == kUsage_PledgesProfile || opt == kUsage_RequiredProfile) {
         xAxisFormat = "MM-yyyy";
         xAxisTitle = "Date";
-        ALICE::instance().setDrawTable(false);
-        QDate date = mDEStart->date();
-        int months = date.daysTo(mDEEnd->date()) / 30;
-        while (date <= mDEEnd->date()) {
-            transferProgress(count++, months);
-            double value0 = 0.0;
-            double value1 = 0.0;
-            double value2 = 0.0;
-            double valueo = 0.0;
-            if (opt == kUsageProfile) {
-                value0 = ALICE::instance().getUsed(Tier::kT0,   type, date);
-                value1 = ALICE::instance().getUsed(Tier::kT1,   type, date);
-                value2 = ALICE::instance().getUsed(Tier::kT2,   type, date);
-                valueo = ALICE::instance().getUsed(Tier::kTOTS, type, date);
-            } else if (opt == kUsage_PledgesProfile){
-                value0 = 100 * ALICE::instance().getUsed(Tier::kT0,   type, date) / ALICE::instance().getPledged(Tier::kT0,   type, QString::number(date.year()));
-                value1 = 100 * ALICE::instance().getUsed(Tier::kT1,   type, date) / ALICE::instance().getPledged(Tier::kT1,   type, QString::number(date.year()));
-                value2 = 100 * ALICE::instance().getUsed(Tier::kT2,   type, date) / ALICE::instance().getPledged(Tier::kT2,   type, QString::number(date.year()));
-                valueo = 100 * ALICE::instance().getUsed(Tier::kTOTS, type, date) / ALICE::instance().getPledged(Tier::kTOTS, type, QString::number(date.year()));
-            } else {
-                value0 = 100 * ALICE::instance().getUsed(Tier::kT0,   type, date) / ALICE::instance().getRequired(Tier::kT0,   type, QString::number(date.year()));
-                value1 = 100 * ALICE::instance().getUsed(Tier::kT1,   type, date) / ALICE::instance().getRequired(Tier::kT1,   type, QString::number(date.year()));
-                value2 = 100 * ALICE::instance().getUsed(Tier::kT2,   type, date) / ALICE::instance().getRequired(Tier::kT2,   type, QString::number(date.year()));
-                valueo = 100 * ALICE::instance().getUsed(Tier::kTOTS, type, date) / ALICE::instance().getRequired(Tier::kTOTS, type, QString::number(date.year()));
-            }
-            if(value0 < 0 || value1 < 0 || value2 < 0 || valueo < 0) {
-                setProgressBar(false);
-                QMessageBox message;
-                message.setText(QString("No report found for %1 %2").arg(swhat).arg(date.toString("MM.yyyy")));
-                message.exec();
-                break;
+        QList<QDate> months;
+        for (QDate date = mDEStart->date(); date <= mDEEnd->date(); date = date.addMonths(1))
+            months.append(date);
+        // the months are downloaded and parsed at the same time, see ALICE::usageProfile
+        steps << IngestPipeline::step(IngestPipeline::kAggregate, QString("%1 months").arg(months.size()), [=]{
+            TIMED_SCOPE("plProfile: months");
+            ALICE::instance().setDrawTable(false);
+            ALICE::UsageProfile used = ALICE::instance().usageProfile(months);
+            ALICE::instance().setDrawTable(true);
+            if (TaskScheduler::currentToken().isCancelled())
+                return false;
+
+            for (const QDate &date : months) {
+                if (!used.contains(date)) {
+                    *missing = date;
+                    return false;
+                }
+                QVector<double> dataVec(columns - 2);
+                for (qint32 tier = Tier::kT0; tier <= Tier::kTOTS; tier++) {
+                    const Resources &res = used[date].at(tier);
+                    double value = type == Resources::kCPU ? res.getCPU() : type == Resources::kDISK ? res.getDisk() : res.getTape();
+                    if (opt == kUsage_PledgesProfile)
+                        value = 100 * value / ALICE::instance().getPledged(Tier::TierCat(tier), type, QString::number(date.year()));
+                    else if (opt == kUsage_RequiredProfile)
+                        value = 100 * value / ALICE::instance().getRequired(Tier::TierCat(tier), type, QString::number(date.year()));
+                    dataVec.replace(colT0 - 2 + tier, value);
+                }
+                values->insert(date, dataVec);
             }
+            return true;
+        });
+    }
 
-            dataVec->replace(colT0 - 2, value0);
-            dataVec->replace(colT1 - 2, value1);
-            dataVec->replace(colT2 - 2, value2);
-            dataVec->replace(colTo - 2, valueo);
-            model->addData(QDateTime(date), dataVec);
-            date = date.addMonths(1);
+    ingest(QString("Collecting the %1 profile").arg(swhat), steps, [=](bool ok) {
+        for (QMap<QDate, QVector<double> >::const_iterator it = values->constBegin(); it != values->constEnd(); ++it) {
+            if (opt == kRequirementsProfile || opt == kPledgesProfile)
+                model->addData(QString::number(it.key().year()), it.value());
+            else
+                model->addData(QDateTime(it.key()), it.value());
         }
-        ALICE::instance().setDrawTable(true);
-    }
-    setProgressBar(false);
+        if (!ok && missing->isValid() && !mCancelled) {
+            QMessageBox message;
+            message.setText(QString("No report found for %1 %2").arg(swhat).arg(missing->toString("MM.yyyy")));
+            message.exec();
+        }
+        drawProfile(opt, type, model, xAxisFormat, xAxisTitle);
+    });
+}
+
+//===========================================================================
+void MainWindow::drawProfile(PlotOptions opt, Resources::Resources_type type, PlTableModel *model,
+                             const QString &xAxisFormat, const QString &xAxisTitle)
+{
+    // draws the profile collected by plProfile
+
+    TIMED_SCOPE("drawProfile");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
+    QMetaEnum me = QMetaEnum::fromType<Resources::Resources_type>();
+    QString swhat = me.key(type);
+    swhat.remove(0, 1); // removes the "k"
+
+    qint32 rows     = 5; // the ticks of the time axis
+    qint32 colYears = 0;
+    qint32 colT0    = 2;
+    qint32 colT1    = 3;
+    qint32 colT2    = 4;
+    qint32 colTo    = 5;
 
     double ymax = model->findMax();
     int exp = qFloor(qLn(ymax) / qLn(10));
@@ -1906,21 +2431,13 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
     // Tot
     QLineSeries *series = new QLineSeries;
     series->setName("Total");
-    QVXYModelMapper *mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colTo);
-    mapper->setSeries(series);
+    SeriesBuilder::bind(series, model, colYears, colTo);
     chart->addSeries(series);
     series->attachAxis(axisY);
     series->attachAxis(axisX);
 
     QScatterSeries *sseries = new QScatterSeries(mMdiArea);
-    mapper = new QVXYModelMapper;
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colTo);
-    mapper->setSeries(sseries);
+    SeriesBuilder::bind(sseries, model, colYears, colTo);
     chart->addSeries(sseries);
     sseries->attachAxis(axisY);
     sseries->attachAxis(axisX);
@@ -1933,21 +2450,13 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
     // T0
     series = new QLineSeries;
     series->setName("T0");
-    mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colT0);
-    mapper->setSeries(series);
+    SeriesBuilder::bind(series, model, colYears, colT0);
     chart->addSeries(series);
     series->attachAxis(axisY);
     series->attachAxis(axisX);
 
     sseries = new QScatterSeries;
-    mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colT0);
-    mapper->setSeries(sseries);
+    SeriesBuilder::bind(sseries, model, colYears, colT0);
     chart->addSeries(sseries);
     sseries->attachAxis(axisY);
     sseries->attachAxis(axisX);
@@ -1960,21 +2469,13 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
     // T1
     series = new QLineSeries;
     series->setName("T1");
-    mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colT1);
-    mapper->setSeries(series);
+    SeriesBuilder::bind(series, model, colYears, colT1);
     chart->addSeries(series);
     series->attachAxis(axisY);
     series->attachAxis(axisX);
 
     sseries = new QScatterSeries;
-    mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colT1);
-    mapper->setSeries(sseries);
+    SeriesBuilder::bind(sseries, model, colYears, colT1);
     chart->addSeries(sseries);
     sseries->attachAxis(axisY);
     sseries->attachAxis(axisX);
@@ -1988,21 +2489,13 @@ void MainWindow::   plProfile(PlotOptions opt, Resources::Resources_type type)
     if (type != Resources::kTAPE) {
         series = new QLineSeries;
         series->setName("T2");
-        mapper = new QVXYModelMapper(mMdiArea);
-        mapper->setModel(model);
-        mapper->setXColumn(colYears);
-        mapper->setYColumn(colT2);
-        mapper->setSeries(series);
+        SeriesBuilder::bind(series, model, colYears, colT2);
         chart->addSeries(series);
         series->attachAxis(axisY);
         series->attachAxis(axisX);
 
         sseries = new QScatterSeries;
-        mapper = new QVXYModelMapper(mMdiArea);
-        mapper->setModel(model);
-        mapper->setXColumn(colYears);
-        mapper->setYColumn(colT2);
-        mapper->setSeries(sseries);
+        SeriesBuilder::bind(sseries, model, colYears, colT2);
         chart->addSeries(sseries);
         sseries->attachAxis(axisY);
         sseries->attachAxis(axisX);
@@ -2086,20 +2579,29 @@ void MainWindow::printCurrentWindow() const
 }
 
 //===========================================================================
-void MainWindow::saveUrlFile(const QDate &date, LoadOptions opt)
+void MainWindow::printTiming()
+{
+    // writes the timing statistics of the session to the console
+
+    mLogConsolView->setVisible(true);
+    Logger::write(Timing::instance().report());
+}
+
+//===========================================================================
+void MainWindow::saveUrlFile(const QDate &date, LoadOptions opt, const QByteArray &data)
 {
     Q_UNUSED(date);
-    // save the url as a file
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    QByteArray data = reply->readAll();
+    // save the downloaded data as a file
     if (data.isEmpty()) {
-        qCritical() << Q_FUNC_INFO << "no data found";
+        if (!mCancelled)
+            qCCritical(lcNetwork) << Q_FUNC_INFO << "no data found";
+        loadDone();
         return;
     }
 
     mDownLoadText->setText("DONE");
 
-    QTextStream instream(&data);
+    QTextStream instream(data);
     QString line;
     //FIXME: save file to the righ place
 //    QString dir(QString("data/%1/%2/").arg(date.year()).arg(date.month()));
@@ -2119,24 +2621,24 @@ void MainWindow::saveUrlFile(const QDate &date, LoadOptions opt)
         file.close();
     }
 
-    setProgressBar(false);
+    loadDone();
 }
 
 //===========================================================================
-void MainWindow::saveUrlFile(const QDate &date, Tier::TierCat cat)
+void MainWindow::saveUrlFile(const QDate &date, Tier::TierCat cat, const QByteArray &data)
 {
     Q_UNUSED(date);
-    // save the url as a file
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    QByteArray data = reply->readAll();
+    // save the downloaded data as a file
     if (data.isEmpty()) {
-        qCritical() << Q_FUNC_INFO << "no data found";
+        if (!mCancelled)
+            qCCritical(lcNetwork) << Q_FUNC_INFO << "no data found";
+        loadDone();
         return;
     }
 
     mDownLoadText->setText("DONE");
 
-    QTextStream instream(&data);
+    QTextStream instream(data);
     QString line;
     //FIXME: save file to the righ place
 //    QString dir(QString("data/%1/%2/").arg(date.year()).arg(date.month()));
@@ -2155,7 +2657,7 @@ void MainWindow::saveUrlFile(const QDate &date, Tier::TierCat cat)
         }
         file.close();
     }
-    setProgressBar(false);
+    loadDone();
 }
 
 //===========================================================================
@@ -2165,6 +2667,9 @@ void MainWindow::plProfileEventSize()
     // the data are in mPLData
     // the name of LHC periods are in mPLDataName
 
+    TIMED_SCOPE("plProfileEventSize");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     QChart *chart = new QChart();
     chart->setTheme(QChart::ChartThemeBlueIcy);
     QMetaEnum me = QMetaEnum::fromType<PlotOptions>();
@@ -2190,13 +2695,16 @@ void MainWindow::plProfileEventSize()
     QLineSeries *series = new QLineSeries;
     series->setName("Average Event Size (kB)");
     double ymax = 0;
+    QVector<QPointF> points;
+    points.reserve(mPlData.size());
     for (qint32 x = 0; x < mPlData.size(); x++) {
         QVector<double> *data = mPlData.at(x);
         double y = data->at(0);
         if (y > ymax)
             ymax = y;
-        series->append(x, y);
+        points.append(QPointF(x, y));
     }
+    series->replace(points);
 
     int exp = qFloor(qLn(ymax) / qLn(10));
     if (ymax  < qPow(10., exp))
@@ -2235,6 +2743,8 @@ void MainWindow::plProfileMandO()
 {
     // specific plot for M&O data
 
+    ALLOC_SCOPE(AllocStats::kPlot);
+
     PlTableModel *model = new PlTableModel();
 
     // get the data
@@ -2251,27 +2761,58 @@ void MainWindow::plProfileMandO()
     headers.replace(colMaO, "M&O payers");
     headers.replace(colCPUperMaO, "CPU per M&O (HEPSpec06)");
     model->setHeader(headers);
-    double payersMax = 0.0;
-    double cpupPayerMax = 0.0;
+
+    // the values are collected in the ingestion thread, one step per year, the plot is drawn when they are all there
+    QSharedPointer<QMap<qint32, QVector<double> > > values(new QMap<qint32, QVector<double> >);
+    QList<IngestPipeline::Step> steps;
     for (int year = mDEStart->date().year(); year <= mDEEnd->date().year(); year++) {
-        QVector<double> *dataVec = new QVector<double>(columns - 2);
-        ALICE::instance().doReqAndPle(QString::number(year));
-        qint32 payers = ALICE::instance().countMOPayers();
-        if (payers > payersMax)
-            payersMax = payers;
-        double cpuPerPayers = ALICE::instance().getRequired(Tier::kT1, Resources::kCPU, QString::number(year)) +
-                              ALICE::instance().getRequired(Tier::kT2, Resources::kCPU, QString::number(year)) +
-                              ALICE::instance().getRequired(Tier::kT1, Resources::kCPU, QString::number(year));
-        if (payers == 0)
-            cpuPerPayers = 0;
-         else
-            cpuPerPayers = cpuPerPayers * 1000 / payers;
-        if (cpuPerPayers > cpupPayerMax)
-            cpupPayerMax = cpuPerPayers;
-        dataVec->replace(colMaO - 2, payers);
-        dataVec->replace(colCPUperMaO - 2, cpuPerPayers);
-        model->addData(QString::number(year), dataVec);
-    }
+        steps << IngestPipeline::step(IngestPipeline::kAggregate, QString::number(year), [=]{
+            TIMED_SCOPE("plProfileMandO: year");
+            QVector<double> dataVec(columns - 2);
+            ALICE::instance().doReqAndPle(QString::number(year));
+            qint32 payers = ALICE::instance().countMOPayers();
+            double cpuPerPayers = ALICE::instance().getRequired(Tier::kT1, Resources::kCPU, QString::number(year)) +
+                                  ALICE::instance().getRequired(Tier::kT2, Resources::kCPU, QString::number(year)) +
+                                  ALICE::instance().getRequired(Tier::kT1, Resources::kCPU, QString::number(year));
+            if (payers == 0)
+                cpuPerPayers = 0;
+             else
+                cpuPerPayers = cpuPerPayers * 1000 / payers;
+            dataVec.replace(colMaO - 2, payers);
+            dataVec.replace(colCPUperMaO - 2, cpuPerPayers);
+            values->insert(year, dataVec);
+            return true;
+        });
+    }
+
+    ingest("Collecting the M&O payers", steps, [=](bool ok) {
+        Q_UNUSED(ok)
+        double payersMax = 0.0;
+        double cpupPayerMax = 0.0;
+        for (QMap<qint32, QVector<double> >::const_iterator it = values->constBegin(); it != values->constEnd(); ++it) {
+            if (it.value().at(colMaO - 2) > payersMax)
+                payersMax = it.value().at(colMaO - 2);
+            if (it.value().at(colCPUperMaO - 2) > cpupPayerMax)
+                cpupPayerMax = it.value().at(colCPUperMaO - 2);
+            model->addData(QString::number(it.key()), it.value());
+        }
+        drawProfileMandO(model, payersMax, cpupPayerMax);
+    });
+}
+
+//===========================================================================
+void MainWindow::drawProfileMandO(PlTableModel *model, double payersMax, double cpupPayerMax)
+{
+    // draws the M&O profile collected by plProfileMandO
+
+    TIMED_SCOPE("drawProfileMandO");
+    ALLOC_SCOPE(AllocStats::kPlot);
+
+    qint32 rows           = 5; // the ticks of the time axis
+    qint32 colYears       = 0;
+    qint32 colMaO         = 2;
+    qint32 colCPUperMaO   = 3;
+
     double y1max = payersMax;
     int exp = qFloor(qLn(y1max) / qLn(10));
     if (y1max  < qPow(10., exp))
@@ -2316,21 +2857,13 @@ void MainWindow::plProfileMandO()
 
     QLineSeries *series = new QLineSeries;
     series->setName("M&O payers");
-    QVXYModelMapper *mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colMaO);
-    mapper->setSeries(series);
+    SeriesBuilder::bind(series, model, colYears, colMaO);
     chart->addSeries(series);
     series->attachAxis(axisY);
     series->attachAxis(axisX);
 
     QScatterSeries *sseries = new QScatterSeries(mMdiArea);
-    mapper = new QVXYModelMapper;
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colMaO);
-    mapper->setSeries(sseries);
+    SeriesBuilder::bind(sseries, model, colYears, colMaO);
     chart->addSeries(sseries);
     sseries->attachAxis(axisY);
     sseries->attachAxis(axisX);
@@ -2342,11 +2875,7 @@ void MainWindow::plProfileMandO()
 
     series = new QLineSeries;
     series->setName("Required CPU resources per M&O payers");
-    mapper = new QVXYModelMapper(mMdiArea);
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colCPUperMaO);
-    mapper->setSeries(series);
+    SeriesBuilder::bind(series, model, colYears, colCPUperMaO);
     chart->addSeries(series);
 
     axisY = new QValueAxis;
@@ -2361,11 +2890,7 @@ void MainWindow::plProfileMandO()
     series->attachAxis(axisX);
 
     sseries = new QScatterSeries(mMdiArea);
-    mapper = new QVXYModelMapper;
-    mapper->setModel(model);
-    mapper->setXColumn(colYears);
-    mapper->setYColumn(colCPUperMaO);
-    mapper->setSeries(sseries);
+    SeriesBuilder::bind(sseries, model, colYears, colCPUperMaO);
     chart->addSeries(sseries);
     sseries->attachAxis(axisY);
     sseries->attachAxis(axisX);
@@ -2409,9 +2934,41 @@ void MainWindow::plProfileMandO()
 //===========================================================================
 void MainWindow::readMonthlyReport(QDate date)
 {
-    // read the montly reports for CPU, disk and tape usage provided by ML
+    // read the montly reports for CPU, disk and tape usage provided by ML, in the ingestion thread
+    // the month is added to the table by ALICE::monthRead
+
+    QSharedPointer<QList<QByteArray> > reports(new QList<QByteArray>);
+    QSharedPointer<ALICE::MonthlyUsage> usage(new ALICE::MonthlyUsage);
+    QList<IngestPipeline::Step> steps;
+    steps << IngestPipeline::step(IngestPipeline::kFetch, QString("the report of %1").arg(date.toString("MM.yyyy")),
+                                  [date, reports]{ *reports = ALICE::instance().downloadMonthlyReport(date); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kParse, "the CPU, disk and tape usage",
+                                  [date, reports, usage]{ *usage = ALICE::computeMonthlyUsage(date, *reports); return true; });
+    steps << IngestPipeline::step(IngestPipeline::kAggregate, date.toString("MM.yyyy"), [usage]{
+        ALICE::instance().initFAs();
+        return ALICE::instance().mergeMonthlyUsage(*usage);
+    });
+    ingest(QString("Reading the report of %1").arg(date.toString("MMMM yyyy")), steps, [date](bool ok) {
+        if (!ok)
+            qCWarning(lcIngest) << "No report found for" << date.toString("MM.yyyy");
+    });
+}
+
+//===========================================================================
+void MainWindow::resizeVisibleColumns(QTableView *view)
+{
+    // resizes to their contents only the columns shown in the viewport
+    // the month columns scrolled out of view keep their width and are not computed
 
-    ALICE::instance().readMonthlyReport(date);
+    QHeaderView *header = view->horizontalHeader();
+    qint32 first = header->visualIndexAt(0);
+    qint32 last  = header->visualIndexAt(view->viewport()->width() - 1);
+    if (first == -1)
+        return;
+    if (last == -1)
+        last = header->count() - 1;
+    for (qint32 visual = first; visual <= last; visual++)
+        view->resizeColumnToContents(header->logicalIndex(visual));
 }
 
 //===========================================================================
@@ -2427,6 +2984,26 @@ void MainWindow::saveData(PlotOptions opt)
     }
 }
 
+//===========================================================================
+void MainWindow::saveTrace()
+{
+    // writes the trace of the session in a file chosen by the user, to be opened in chrome://tracing or ui.perfetto.dev
+
+    if (Tracer::instance().size() == 0) {
+        QMessageBox::information(this, tr("Save trace"), tr("Nothing traced, switch the tracing on in the Debug menu"));
+        return;
+    }
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save trace"), QString("%1/trace.json").arg(dir),
+                                                    tr("Chrome trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+    if (!Tracer::instance().write(fileName))
+        QMessageBox::warning(this, tr("Save trace"), QString(tr("Could not write %1")).arg(fileName));
+    else
+        Logger::write(QString("%1 events written to %2").arg(Tracer::instance().size()).arg(fileName));
+}
+
 //===========================================================================
 void MainWindow::selectDate(ActionOptions opt)
 {
@@ -2535,8 +3112,16 @@ void MainWindow::selectDates(LoadOptions opt)
 void MainWindow::setProgressBar(bool on)
 {
     // activate and desactivate progress bar when downloading data
+    // the window is shared by the downloads and the ingestion jobs running at the same time
 
     if (on) {
+        if (mProgressBarWidget) {
+            mDownLoadText->setText(QString("Downloading from %1").arg(mURL));
+            return;
+        }
+        ProgressModel::instance().reset();
+        ProgressModel::instance().start();
+
         mProgressBarWidget = new QWidget();
         mProgressBarWidget->setAttribute(Qt::WA_DeleteOnClose);
         mProgressBarWidget->setLayout(new QVBoxLayout);
@@ -2548,8 +3133,21 @@ void MainWindow::setProgressBar(bool on)
         mDownLoadText->setText(QString("Downloading from %1").arg(mURL));
         mDownLoadText->setAlignment(Qt::AlignHCenter);
         mProgressBarWidget->layout()->addWidget(mDownLoadText);
+
+        mProgressText = new QLabel(mProgressBarWidget);
+        mProgressText->setAlignment(Qt::AlignHCenter);
+        mProgressBarWidget->layout()->addWidget(mProgressText);
+
+        QPushButton *cancel = new QPushButton(tr("Cancel"), mProgressBarWidget);
+        connect(cancel, &QPushButton::clicked, this, &MainWindow::cancelLoads);
+        mProgressBarWidget->layout()->addWidget(cancel);
         mProgressBarWidget->show();
-    } else {
+    } else if (mProgressBarWidget && mIngesting == 0) {
+        ProgressModel::instance().stop();
         mProgressBarWidget->close();
+        mProgressBarWidget = Q_NULLPTR;
+        mProgressBar       = Q_NULLPTR;
+        mDownLoadText      = Q_NULLPTR;
+        mProgressText      = Q_NULLPTR;
     }
 }
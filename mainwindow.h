@@ -7,16 +7,20 @@
 #include <QtNetwork>
 
 #include <QDate>
+#include <QElapsedTimer>
 #include <QMainWindow>
 #include <QPlainTextEdit>
 #include <QString>
 #include <QTableView>
 
 #include "alice.h"
+#include "ingestpipeline.h"
 
 class QMdiArea;
 class QMdiSubWindow;
 class ConsoleWidget;
+class FASortProxyModel;
+class PlTableModel;
 
 struct MyLessThan {
     bool operator()(const QString &s1, const QString &s2) const {
@@ -40,7 +44,7 @@ class MainWindow : public QMainWindow
 public:
     enum ActionOptions {kTheBigTable, kOffenderTable, kGetReport};
     enum PlotOptions {kMandOProfile, kRequirementsProfile, kPledgesProfile, kRegisteredDataProfile, kUsageProfile, kUsage_PledgesProfile, kUsage_RequiredProfile, kTierEfficiencyProfile, kUserEfficiencyProfile,
-                      kEventSizeProfile, kPledgedRequiredUsed, kCPUUserShareProfile};
+                      kEventSizeProfile, kPledgedRequiredUsed, kCPUUserShareProfile, kUsage_PledgesHeatmap};
     enum LoadOptions {kEGICPUReportT1, kEGICPUReportT2, kMLCPUReport, kMLStorageReport, kMLRAWProd};
 
     Q_ENUM (ActionOptions)
@@ -53,45 +57,61 @@ public:
     void        createConsol();
     static bool isDebug() { return mDebug; }
     void        list(ALICE::ListOptions val);
+    static void parsePlotUrlFile(PlotOptions opt, const QByteArray &data, QList<QVector<double>*> &plData, QList<QString> &plDataName);
+    void        setStartup(const QElapsedTimer &timer) { mStartup = timer; }
 
 protected:
     void paintEvent(QPaintEvent *);
 
 private slots:
+    void        cancelLoads();
     void        doit(qint32 opt);
+    void        exportTable();
     void        findAName();
     void        load(qint32 opt);
     void        mousePressEvent(QMouseEvent *event);
     void        onTableClicked(const QModelIndex &index);
-    void        parsePlotUrlFile(PlotOptions opt);
     void        plot(qint32 opt);
     void        printCurrentWindow() const;
-    void        resizeView() {mTableConsol->resizeColumnsToContents();}
-    void        resizeViewOff() {mOffTableConsol->resizeColumnsToContents();}
-    void        saveUrlFile(const QDate &date, LoadOptions opt);
-    void        saveUrlFile(const QDate &date, Tier::TierCat cat);
+    void        printTiming();
+    void        saveTrace();
+    void        resizeView() {resizeVisibleColumns(mTableConsol);}
+    void        resizeViewOff() {resizeVisibleColumns(mOffTableConsol);}
+    void        saveUrlFile(const QDate &date, LoadOptions opt, const QByteArray &data);
+    void        saveUrlFile(const QDate &date, Tier::TierCat cat, const QByteArray &data);
     void        showNetworkError(QNetworkReply::NetworkError er);
+    void        showProgress();
     void        sortColumn(int col);
+    void        stepDone(qint32 job, qint32 done, qint32 total, const QString &text);
     void        transferProgress(qint64 readBytes, qint64 totalBytes);
     void        validateDate(ActionOptions opt);
     void        validateDates(PlotOptions opt);
     void        validateDates(LoadOptions opt);
 
 private:
+    void        addStatusFilterActions(QTableView *view, FASortProxyModel *proxy);
     void        createActions();
     void        createMenu();
-    static void customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
     void        setDebugMode(bool val);
     void        doOffenders(const QString &year);
     void        doeReqAndPle(const QString &year);
+    void        drawBarchart(Resources::Resources_type type, PlTableModel *model, const QStringList &categories, double valuemax);
+    void        drawHeatmap(Resources::Resources_type type, UsageLedger::Quantity quantity, const QList<QDate> &months);
+    void        drawProfile(PlotOptions opt, Resources::Resources_type type, PlTableModel *model,
+                            const QString &xAxisFormat, const QString &xAxisTitle);
+    void        drawProfileMandO(PlTableModel *model, double payersMax, double cpupPayerMax);
     void        getDataFromWeb(PlotOptions opt);
     void        getDataFromWeb(const QDate &date, Tier::TierCat cat);
     void        getDataFromWeb(const QDate &date, LoadOptions opt);
     void        getDataFromFile(PlotOptions opt);
+    void        ingest(const QString &title, const QList<IngestPipeline::Step> &steps, IngestPipeline::Done done,
+                       QObject *owner = Q_NULLPTR);
     void        keyPressEvent(QKeyEvent *event);
+    void        loadDone();
     void        loadUsageML(LoadOptions opt, QDateTime dateS, QDateTime dateE);
     void        loadUsageWLCG(QDate dateS, QDate dateE, Tier::TierCat cat);
     void        plBarchart(Resources::Resources_type type);
+    void        plHeatmap(Resources::Resources_type type);
     void        plProfileEventSize();
     void        plProfileMandO();
     void        plProfile(PlotOptions opt,  Resources::Resources_type type);
@@ -99,25 +119,33 @@ private:
     void        plTierEfficiency(PlotOptions opt);
     void        plUserEfficiency(PlotOptions opt);
     void        readMonthlyReport(QDate date);
+    void        resizeVisibleColumns(QTableView *view);
     void        saveData(PlotOptions opt);
     void        selectDate(ActionOptions opt);
     void        selectDates(PlotOptions opt, QDate dateMax = QDate::currentDate());
     void        selectDates(LoadOptions opt);
     void        setProgressBar(bool on = true);
+    void        setTimingMode(bool val);
+    void        setTracingMode(bool val);
+    FASortProxyModel *tableProxy() const;
+    void        warmUp();
 
     static bool             mDebug;              // True for running debug mode
     QAction                 *mDebugOffAction;    // Action for debug mode off
+    bool                    mCancelled;          // The user cancelled the loads running, their failures are not reported
     QAction                 *mDebugOnAction;     // Action for debug mode on
     QMenu                   *mDebugMenu;         // Menu Tab to set the debug on/off
     QLabel                  *mDownLoadText;      // The text associated with the download status window + mProgressBar
     QDateEdit               *mDEEnd;             // End date for the data to be plotted or loaded
     QDateEdit               *mDEStart;           // Start date for the data to be plotted or loaded
+    qint32                  mIngesting;          // Number of ingestion jobs and downloads not yet done
     QList<QAction*>         mLiAct;              // List of Actionsto do various stuff
     QList<QAction*>         mLoAct;              // Triggers loads
     ConsoleWidget           *mLogConsol;         // The console where to write logging info
     QMdiSubWindow           *mLogConsolView;     // The view of the log consol in the mdi area
     QMdiArea                *mMdiArea;           // The mdi area in the centralwidget
     QNetworkAccessManager   *mNetworkManager;    // The network manager
+    FASortProxyModel        *mOffProxy;          // The sort and filter proxy of the offenders table
     QTableView              *mOffTableConsol;    // The table where the due resources by offendersa are displayed
     QMdiSubWindow           *mOffTableConsolView;// The view of the previous table
     QList<QVector<double>*> mPlData;             // Data to be plotted
@@ -125,9 +153,14 @@ private:
     QList<QAction*>         mPlAct;              // Triggers plots
     QProgressBar            *mProgressBar;       // A progress bar used when downloading files from www
     QWidget                 *mProgressBarWidget; // The progress bar widget used when downloading files from www
+    QLabel                  *mProgressText;      // The bytes, files, months and steps done by all the loads
     QList<QMenu*>           mReportsMenus;       // Menus for reading reports/year
+    QElapsedTimer           mStartup;            // Started at the beginning of main(), invalid once the window is shown
+    FASortProxyModel        *mTableProxy;        // The filter proxy of the all stuff table
     QTableView              *mTableConsol;       // The table where the all stuff table is displayed
     QMdiSubWindow           *mTableConsolView;   // The view of the previous table
+    QAction                 *mTimingAction;      // Action for the timing of the stages on/off
+    QAction                 *mTracingAction;     // Action for the trace of the session on/off
     QString                 mURL;                // URL name where to get data from
 };
 
@@ -0,0 +1,80 @@
+// An immutable copy of the funding agencies and their sites, published by ALICE each time the ingestion changes them
+// the views hold a snapshot as long as they need it and read it without lock, a new version never tears it
+// (read-copy-update: the writer builds a new version and swaps the shared pointer atomically)
+
+#include "fundingagency.h"
+#include "modelsnapshot.h"
+
+//===========================================================================
+ModelSnapshot::ModelSnapshot(const QList<FundingAgency*> &fas, qint64 version) :
+    mVersion(version)
+{
+    // copies what the views read from the funding agencies, runs in the thread that changed them
+
+    for (FundingAgency *fa : fas) {
+        Agency agency;
+        agency.name    = fa->name();
+        agency.status  = fa->status();
+        agency.payers  = fa->payers();
+        agency.contrib = fa->contrib();
+        agency.listing = fa->list();
+        mAgencies.append(agency);
+
+        if (fa->name().left(1) == "-") // skip FAs included in a cluster
+            continue;
+        for (Tier *t : fa->tiers()) {
+            Site site;
+            site.name     = t->getWLCGName();
+            site.category = t->category();
+            site.agency   = fa->name();
+            for (const QString &ce : t->ces())
+                if (!mCEs.contains(ce))
+                    mCEs.insert(ce, site);
+            for (const QString &se : t->ses())
+                if (!mSEs.contains(se))
+                    mSEs.insert(se, site);
+        }
+    }
+}
+
+//===========================================================================
+const ModelSnapshot::Agency *ModelSnapshot::agency(const QString &name) const
+{
+    // searches funding agency by name, as ALICE::searchFA
+
+    QString n = canonicalName(name);
+    for (const Agency &agency : mAgencies)
+        if (agency.name.contains(n) && agency.name.left(1) != "-")
+            return &agency;
+    return Q_NULLPTR;
+}
+
+//===========================================================================
+QString ModelSnapshot::canonicalName(const QString &name)
+{
+    // the names used in the reports for some funding agencies differ from the ones in glance
+
+    if (name == "Switzerland")
+        return "CERN";
+    else if (name == "Russian Federation")
+        return "Russia";
+    else if (name == "UK")
+        return "UnitedKingdom-STFC";
+    else if (name == "Latin America")
+        return "Brazil";
+    return name;
+}
+
+//===========================================================================
+const ModelSnapshot::Site *ModelSnapshot::site(const QString &name) const
+{
+    // searches a site by its CE or SE name, as ALICE::search
+
+    QHash<QString, Site>::const_iterator it = mCEs.constFind(name);
+    if (it != mCEs.constEnd())
+        return &it.value();
+    it = mSEs.constFind(name);
+    if (it != mSEs.constEnd())
+        return &it.value();
+    return Q_NULLPTR;
+}
@@ -0,0 +1,55 @@
+// An immutable copy of the funding agencies and their sites, published by ALICE each time the ingestion changes them
+// the views hold a snapshot as long as they need it and read it without lock, a new version never tears it
+// (read-copy-update: the writer builds a new version and swaps the shared pointer atomically)
+
+#ifndef MODELSNAPSHOT_H
+#define MODELSNAPSHOT_H
+
+#include <memory>
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "tier.h"
+
+class FundingAgency;
+class ModelSnapshot
+{
+public:
+    struct Agency {
+        Agency() : payers(0), contrib(0.0) {}
+        QString name;    // name of the funding agency
+        QString status;  // MS or NMS
+        qint32  payers;  // number of M&O payers
+        double  contrib; // required contribution in %
+        QString listing; // the description given by FundingAgency::list
+    };
+
+    struct Site {
+        Site() : category(Tier::kUnknown) {}
+        QString       name;     // the name in WLCG
+        Tier::TierCat category; // T0, T1 or T2
+        QString       agency;   // the funding agency owning the site
+    };
+
+    ModelSnapshot() : mVersion(0) {}
+    ModelSnapshot(const QList<FundingAgency*> &fas, qint64 version);
+
+    const Agency        *agency(const QString &name) const;
+    const QList<Agency> &agencies() const { return mAgencies; }
+    static QString      canonicalName(const QString &name);
+    bool                isEmpty() const { return mAgencies.isEmpty(); }
+    const Site          *site(const QString &name) const;
+    qint64              version() const { return mVersion; }
+
+private:
+    QList<Agency>        mAgencies; // the funding agencies in the order of ALICE
+    QHash<QString, Site> mCEs;      // the sites by MonALISA CE name
+    QHash<QString, Site> mSEs;      // the sites by MonALISA SE name
+    qint64               mVersion;  // increases with each publication, 0 before the first
+};
+
+typedef std::shared_ptr<const ModelSnapshot> ModelSnapshotPtr;
+
+#endif // MODELSNAPSHOT_H
@@ -4,9 +4,12 @@
 #include<QDebug>
 #include <QFile>
 
+#include "allocstats.h"
+#include "logger.h"
 #include "naming.h"
+#include "timing.h"
 
-Naming* Naming::mInstance = Q_NULLPTR;
+QString Naming::mFileName  = QString(":/data/NamingDictionary.csv");
 
 //===========================================================================
 Naming::Naming(QObject *parent) : QObject(parent)
@@ -16,10 +19,10 @@ Naming::Naming(QObject *parent) : QObject(parent)
     // FORMAT: FA; SE; CE in ML; CE in WLCG
 
     mDict.clear();
-    QString fileName = QString(":/data/NamingDictionary.csv");
+    QString fileName = mFileName;
     QFile csvFile(fileName);
     if (!csvFile.open(QIODevice::ReadOnly)) {
-        qWarning() << QString("File %1 cannot be opened").arg(fileName);
+        qCWarning(lcNaming) << QString("File %1 cannot be opened").arg(fileName);
         exit(1);
     }
 
@@ -64,9 +67,19 @@ Naming::Naming(const Naming &) : QObject()
 //===========================================================================
 Naming* Naming::instance()
 {
-    if (!mInstance)
-        mInstance = new Naming();
-    return mInstance;
+    // created at first use, from any thread: by a worker after the first window is shown or by the first loader
+
+    static Naming *instance = new Naming();
+    return instance;
+}
+
+//===========================================================================
+void Naming::setFileName(const QString &fileName)
+{
+    // the dictionary to read instead of the one in the resources, e.g. the one of a sample written by tools/datagen
+    // to be set before the first use of instance()
+
+    mFileName = fileName;
 }
 
 //===========================================================================
@@ -74,6 +87,9 @@ const QList<QString> Naming::find(const QString &faName, QString wlcg, Elements
 {
   // retrieve the ML CE/SE element name for Funding Agency faName
 
+    TIMED_SCOPE("name lookup");
+    ALLOC_SCOPE(AllocStats::kLookup);
+
     QString fa = faName;
     fa.remove("*");
     QList<QString> rv;
@@ -92,6 +108,10 @@ const QList<QString> Naming::find(const QString &faName, QString wlcg, Elements
 const QString Naming::find(const QString &faShort)
 {
     // returns the country name corresponding to the abbreviation faShort
+
+    TIMED_SCOPE("name lookup");
+    ALLOC_SCOPE(AllocStats::kLookup);
+
     QString rv = "";
 
     for (QVector<QString> *vect : mDict) {
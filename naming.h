@@ -14,6 +14,7 @@ class Naming : public QObject
 public:    
     enum Elements {kFASHORT, kFA, kSE, kCEML, kCEWLCG};
     static Naming *instance();
+    static void    setFileName(const QString &fileName);
 
     const QList<QString> find(const QString &faName, QString wlcg, Elements el);
     const QString        find(const QString &faShort);
@@ -23,7 +24,7 @@ private:
     ~Naming();
     Naming(const Naming&);
 
-    static Naming               *mInstance; // the unique instance of the object
+    static QString               mFileName; // the dictionary, the one in the resources by default
     QList<QVector<QString>*>     mDict;     // list of (FA, SEML, CEML, SiteWLVG)
 };
 
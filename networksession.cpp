@@ -0,0 +1,135 @@
+// Records the responses of the data servers during a session and serves them again without the network
+// a recorded response is its url, when it was asked since the start of the recording, how long it took and its content
+// in replay the responses of an url are served in the order they were recorded, the last one again once they are used up;
+// an url not found as such is looked up without its relative interval (interval.min, interval.max of alimonitor)
+// the latencies recorded can be reproduced so that two builds replaying the same session can be compared
+// the file is a QDataStream: magic, version, then the responses appended as they arrive
+// singleton
+
+#include <QDataStream>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QUrlQuery>
+
+#include "logger.h"
+#include "networksession.h"
+
+//===========================================================================
+NetworkSession::NetworkSession() :
+    mLatencies(false), mMode(kOff)
+{
+    // ctor (private)
+
+    mClock.start();
+}
+
+//===========================================================================
+NetworkSession &NetworkSession::instance()
+{
+    // created at first use, from any thread
+
+    static NetworkSession instance;
+    return instance;
+}
+
+//===========================================================================
+QString NetworkSession::key(const QUrl &url)
+{
+    // url without the interval relative to the time of the request
+
+    QUrlQuery query(url);
+    query.removeAllQueryItems("interval.min");
+    query.removeAllQueryItems("interval.max");
+    QUrl rv(url);
+    rv.setQuery(query);
+    return rv.toString();
+}
+
+//===========================================================================
+bool NetworkSession::lookup(const QUrl &url, QByteArray &data, qint64 &latency)
+{
+    // the next recorded response of url and the time to wait before serving it, false if url was not recorded
+
+    QMutexLocker locker(&mMutex);
+    QHash<QString, Responses>::iterator it = mByUrl.find(url.toString());
+    if (it == mByUrl.end()) {
+        it = mByKey.find(key(url));
+        if (it == mByKey.end()) {
+            qCWarning(lcNetwork) << url.toString() << "not in the recorded session";
+            return false;
+        }
+    }
+    Responses &responses = it.value();
+    const Response &response = responses.list.at(qMin(responses.next, responses.list.size() - 1));
+    responses.next++;
+    data    = response.data;
+    latency = mLatencies ? response.latency : 0;
+    return true;
+}
+
+//===========================================================================
+bool NetworkSession::record(const QString &fileName)
+{
+    // records the responses in fileName from now on, to be called before the first download
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::WriteOnly)) {
+        mError = QString("File %1 cannot be written").arg(fileName);
+        return false;
+    }
+    QDataStream out(&mFile);
+    out << kMagic << kVersion;
+    mFile.flush();
+    mClock.restart();
+    mMode = kRecord;
+    return true;
+}
+
+//===========================================================================
+void NetworkSession::record(const QUrl &url, qint64 asked, qint64 latency, const QByteArray &data)
+{
+    // appends a response, asked at asked (see now()) and received latency ms later, can be called from any thread
+
+    if (mMode != kRecord)
+        return;
+    QMutexLocker locker(&mMutex);
+    QDataStream out(&mFile);
+    out << url.toString() << asked << latency << data;
+    mFile.flush(); // a session cut short is still usable
+}
+
+//===========================================================================
+bool NetworkSession::replay(const QString &fileName, bool latencies)
+{
+    // serves the responses recorded in fileName from now on, waiting their latency if latencies is set
+    // to be called before the first download
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = QString("File %1 cannot be opened").arg(fileName);
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 magic   = 0;
+    qint32  version = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        mError = QString("%1 is not a recorded session").arg(fileName);
+        return false;
+    }
+    qint32 count = 0;
+    while (!in.atEnd()) {
+        QString  url;
+        Response response;
+        in >> url >> response.asked >> response.latency >> response.data;
+        if (in.status() != QDataStream::Ok)
+            break; // the last response was cut short
+        mByUrl[url].list.append(response);
+        mByKey[key(QUrl(url))].list.append(response);
+        count++;
+    }
+    qCInfo(lcNetwork) << count << "responses to replay from" << fileName;
+    mLatencies = latencies;
+    mMode      = kReplay;
+    return true;
+}
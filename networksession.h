@@ -0,0 +1,65 @@
+// Records the responses of the data servers during a session and serves them again without the network
+// a recorded response is its url, when it was asked since the start of the recording, how long it took and its content
+// in replay the responses of an url are served in the order they were recorded, the last one again once they are used up;
+// an url not found as such is looked up without its relative interval (interval.min, interval.max of alimonitor)
+// the latencies recorded can be reproduced so that two builds replaying the same session can be compared
+// the file is a QDataStream: magic, version, then the responses appended as they arrive
+// singleton
+
+#ifndef NETWORKSESSION_H
+#define NETWORKSESSION_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+
+class NetworkSession
+{
+public:
+    enum Mode {kOff, kRecord, kReplay};
+
+    static NetworkSession &instance();
+
+    QString     error() const { return mError; }
+    bool        lookup(const QUrl &url, QByteArray &data, qint64 &latency);
+    Mode        mode() const { return mMode; }
+    bool        record(const QString &fileName);
+    void        record(const QUrl &url, qint64 asked, qint64 latency, const QByteArray &data);
+    bool        replay(const QString &fileName, bool latencies);
+    bool        recording() const { return mMode == kRecord; }
+    bool        replaying() const { return mMode == kReplay; }
+    qint64      now() const { return mClock.elapsed(); }
+
+private:
+    struct Response {
+        qint64     asked;   // when it was asked in ms since the recording started
+        qint64     latency; // how long it took in ms
+        QByteArray data;    // the content, empty if the download failed
+    };
+    struct Responses {
+        Responses() : next(0) {}
+        QList<Response> list; // in the order they were recorded
+        qint32          next; // the next one served
+    };
+
+    NetworkSession();
+    static QString key(const QUrl &url);
+
+    static const quint32        kMagic   = 0x4352534e; // "CRSN"
+    static const qint32         kVersion = 1;
+    QElapsedTimer               mClock;     // the time base of the recording
+    QString                     mError;     // why record() or replay() failed
+    QFile                       mFile;      // the recording
+    bool                        mLatencies; // the replayed responses wait their recorded latency
+    Mode                        mMode;      // set once at start
+    QMutex                      mMutex;     // protects mFile and the responses, used from the GUI and the network threads
+    QHash<QString, Responses>   mByKey;     // the responses by url without its relative interval
+    QHash<QString, Responses>   mByUrl;     // the responses by url
+};
+
+#endif // NETWORKSESSION_H
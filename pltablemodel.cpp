@@ -6,51 +6,62 @@
 #include <QDebug>
 #include <QFont>
 #include <QTime>
+
+#include <algorithm>
+
 #include "pltablemodel.h"
 
 //===========================================================================
-PlTableModel::PlTableModel(QObject *parent) : QAbstractTableModel(parent)
+PlTableModel::PlTableModel(QObject *parent) : QAbstractTableModel(parent),
+    mCapacity(0), mColums(0), mRows(0)
 {
     Q_UNUSED(parent)
 }
 
 //===========================================================================
-void PlTableModel::addData(const QString &year, QVector<double> *vec)
+void PlTableModel::addData(const QString &year, const QVector<double> &vec)
 {
     // add one row of data: year, double,....
 
     QDateTime date;
     date.setDate(QDate(year.toInt(), 4, 1)); // 1 April year
-    qint32 size = vec->size() + 2;
-    QVector<double> *dataVec = new QVector<double>(size);
-    dataVec->replace(0, (double) date.toMSecsSinceEpoch());
-    dataVec->replace(1, year.toDouble());
-    for (qint32 index = 0; index < vec->size(); index++)
-        dataVec->replace(index + 2, vec->at(index));
-    mData.append(dataVec);
+    appendRow((double) date.toMSecsSinceEpoch(), year.toDouble(), vec);
 }
 
 //===========================================================================
-void PlTableModel::addData(const QDateTime &date, QVector<double> *vec)
+void PlTableModel::addData(const QDateTime &date, const QVector<double> &vec)
 {
     // add one row of data; date, double,....
 
-    qint32 size = vec->size() + 2;
-    QVector<double> *dataVec = new QVector<double>(size);
-    dataVec->replace(0, (double) date.toMSecsSinceEpoch());
-    dataVec->replace(1, date.date().month()+ date.date().year()/10000.);
-    for (qint32 index = 0; index < vec->size(); index++)
-        dataVec->replace(index + 2, vec->at(index));
-    mData.append(dataVec);
-
+    appendRow((double) date.toMSecsSinceEpoch(), date.date().month()+ date.date().year()/10000., vec);
 }
 
 //===========================================================================
-void PlTableModel::addData(QVector<double> *vec)
+void PlTableModel::addData(const QVector<double> &vec)
 {
     // add one row of data: double, ....
-    mData.append(vec);
-    qDebug() << Q_FUNC_INFO << mData.at(0)->at(0);
+
+    beginInsertRows(QModelIndex(), mRows, mRows);
+    reserveRows(mRows + 1);
+    for (qint32 col = 0; col < mColums; col++)
+        setCell(mRows, col, col < vec.size() ? vec.at(col) : 0.0);
+    mRows++;
+    endInsertRows();
+}
+
+//===========================================================================
+void PlTableModel::appendRow(double x, double label, const QVector<double> &vec)
+{
+    // add one row: the two x columns followed by the values of vec
+
+    beginInsertRows(QModelIndex(), mRows, mRows);
+    reserveRows(mRows + 1);
+    setCell(mRows, 0, x);
+    setCell(mRows, 1, label);
+    for (qint32 col = 2; col < mColums; col++)
+        setCell(mRows, col, col - 2 < vec.size() ? vec.at(col - 2) : 0.0);
+    mRows++;
+    endInsertRows();
 }
 
 //===========================================================================
@@ -74,18 +85,14 @@ QVariant PlTableModel::data(const QModelIndex &index, int role) const
     {
         QVariant rv;
         if (index.column() > 1) {
-            double value = mData[index.row()]->at(index.column());
-            if (value == 0 && index.row() == rowCount() - 1) { // just in case the last year data are not available
-                value = mData[index.row()-1]->at(index.column());
-            }
-            rv = QString::number(value, 'f', 1);
+            rv = QString::number(value(index.row(), index.column()), 'f', 1);
         } else
-            rv = mData[index.row()]->at(index.column());
+            rv = at(index.row(), index.column());
         return rv;
         break;
     }
     case Qt::EditRole:
-        return mData[index.row()]->at(index.column());
+        return at(index.row(), index.column());
         break;
     case Qt::BackgroundRole:
 //        foreach (QRect rect, mMapping) {
@@ -120,14 +127,12 @@ QVariant PlTableModel::data(const QModelIndex &index, int role) const
 //===========================================================================
 double PlTableModel::findMax() const
 {
-    // find the largest y value
+    // find the largest y value from the cached extrema of the columns
 
     double max = -1;
-    for (QVector<double> *vec : mData) {
-        for (qint32 index = 2; index < vec->size(); index++) // skip the two first columns corresponding to x axis
-            if (vec->at(index) > max)
-                max = vec->at(index);
-    }
+    for (qint32 col = 2; col < mColums && mRows > 0; col++) // skip the two first columns corresponding to x axis
+        if (mMax.at(col) > max)
+            max = mMax.at(col);
     return max;
 }
 
@@ -164,24 +169,111 @@ QVariant PlTableModel::headerData(int section, Qt::Orientation orientation, int
 bool PlTableModel::isEmpty() const
 {
     // check if there are data
-    if (mData.size() > 0)
-        return false;
-    else
-        return true;
+    return mRows == 0;
+}
+
+//===========================================================================
+QVector<QPointF> PlTableModel::points(qint32 xColumn, qint32 yColumn) const
+{
+    // the (x, y) points of all rows, to be given at once to a series
+
+    QVector<QPointF> rv;
+    rv.reserve(mRows);
+    for (qint32 row = 0; row < mRows; row++)
+        rv.append(QPointF(value(row, xColumn), value(row, yColumn)));
+    return rv;
+}
+
+//===========================================================================
+void PlTableModel::rescan(qint32 column)
+{
+    // recomputes the extrema of column, needed when the old extremum was overwritten
+
+    const double *first = mData.constData() + column * mCapacity;
+    mMin[column] = mMax[column] = first[0];
+    for (qint32 row = 1; row < mRows; row++) {
+        if (first[row] < mMin.at(column))
+            mMin[column] = first[row];
+        if (first[row] > mMax.at(column))
+            mMax[column] = first[row];
+    }
+}
+
+//===========================================================================
+void PlTableModel::reserveRows(qint32 rows)
+{
+    // grows the buffer, doubling its capacity, so that it can hold rows
+
+    if (rows <= mCapacity)
+        return;
+    qint32 capacity = qMax(mCapacity * 2, qMax(rows, 8));
+    QVector<double> data(capacity * mColums);
+    for (qint32 col = 0; col < mColums; col++)
+        std::copy(mData.constData() + col * mCapacity, mData.constData() + col * mCapacity + mRows,
+                  data.data() + col * capacity);
+    mData.swap(data);
+    mCapacity = capacity;
 }
 
 //===========================================================================
 int PlTableModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
-    return mData.count();
+    return mRows;
+}
+
+//===========================================================================
+void PlTableModel::setCell(qint32 row, qint32 column, double value)
+{
+    // sets a new cell and updates the extrema of its column
+
+    mData[column * mCapacity + row] = value;
+    if (mRows == 0) {
+        mMin[column] = mMax[column] = value;
+        return;
+    }
+    if (value < mMin.at(column))
+        mMin[column] = value;
+    if (value > mMax.at(column))
+        mMax[column] = value;
+}
+
+//===========================================================================
+void PlTableModel::setColRow(int col, int row)
+{
+    // the number of columns and the expected number of rows, to be set before adding data
+
+    beginResetModel();
+    mColums   = col;
+    mRows     = 0;
+    mCapacity = 0;
+    mData.clear();
+    mMin.fill(0.0, col);
+    mMax.fill(0.0, col);
+    reserveRows(row);
+    endResetModel();
 }
 
 //===========================================================================
 bool PlTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
+    // the extrema are updated in O(1) unless the old extremum of the column is overwritten
+
     if (index.isValid() && role == Qt::EditRole) {
-        mData[index.row()]->replace(index.column(), value.toDouble());
+        qint32 row    = index.row();
+        qint32 column = index.column();
+        double &cell  = mData[column * mCapacity + row];
+        double old    = cell;
+        double val    = value.toDouble();
+        cell = val;
+        if ((old == mMax.at(column) && val < old) || (old == mMin.at(column) && val > old))
+            rescan(column);
+        else {
+            if (val < mMin.at(column))
+                mMin[column] = val;
+            if (val > mMax.at(column))
+                mMax[column] = val;
+        }
         emit dataChanged(index, index);
         return true;
     }
@@ -196,6 +288,29 @@ void PlTableModel::setHeader(QVector<QString> headers)
         mHeader.append(headers[index]);
 }
 
+//===========================================================================
+double PlTableModel::value(qint32 row, qint32 column) const
+{
+    // the value as displayed in the table
+
+    double rv = at(row, column);
+    if (column > 1 && rv == 0 && row > 0 && row == rowCount() - 1) // just in case the last year data are not available
+        rv = at(row - 1, column);
+    return rv;
+}
+
+//===========================================================================
+QVector<double> PlTableModel::values(qint32 column) const
+{
+    // the values of all rows in column
+
+    QVector<double> rv;
+    rv.reserve(mRows);
+    for (qint32 row = 0; row < mRows; row++)
+        rv.append(value(row, column));
+    return rv;
+}
+
 //===========================================================================
 Qt::ItemFlags PlTableModel::flags(const QModelIndex &index) const
 {
@@ -6,6 +6,8 @@
 
 #include <QAbstractTableModel>
 #include <QList>
+#include <QVector>
+#include <QPointF>
 #include <QRect>
 
 class PlTableModel : public QAbstractTableModel
@@ -13,28 +15,40 @@ class PlTableModel : public QAbstractTableModel
 public:
     PlTableModel(QObject *parent = 0);
 
-    void          addData(const QString &year, QVector<double> *vec);
-    void          addData(const QDateTime &date, QVector<double> *vec);
-    void          addData(QVector<double> *vec);
-    void          addMapping(QString color, QRect area);
-    void          clearMapping() { mMapping.clear(); }
-    int           columnCount(const QModelIndex &parent = QModelIndex()) const;
-    QVariant      data(const QModelIndex &index, int role) const;
-    double        findMax() const ;
-    Qt::ItemFlags flags(const QModelIndex &index) const;
-    QVariant      headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
-    bool          isEmpty() const;
-    int           rowCount(const QModelIndex &parent = QModelIndex()) const;
-    bool          setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
-    void          setColRow(int col, int row) { mColums = col; mRows = row; }
-    void          setHeader(QVector<QString> headers);
+    void             addData(const QString &year, const QVector<double> &vec);
+    void             addData(const QDateTime &date, const QVector<double> &vec);
+    void             addData(const QVector<double> &vec);
+    void             addMapping(QString color, QRect area);
+    void             clearMapping() { mMapping.clear(); }
+    int              columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant         data(const QModelIndex &index, int role) const;
+    double           findMax() const ;
+    Qt::ItemFlags    flags(const QModelIndex &index) const;
+    QVariant         headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    bool             isEmpty() const;
+    QVector<QPointF> points(qint32 xColumn, qint32 yColumn) const;
+    int              rowCount(const QModelIndex &parent = QModelIndex()) const;
+    bool             setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    void             setColRow(int col, int row);
+    void             setHeader(QVector<QString> headers);
+    double           value(qint32 row, qint32 column) const;
+    QVector<double>  values(qint32 column) const;
 
 private:
-    qint32                  mColums;  // number of colums
-    QList<QVector<double>*> mData;    // the data to be plotted
-    QVector<QString>        mHeader;  // the horizontal headers of the table
-    QHash<QString, QRect>   mMapping; // not used
-    qint32                  mRows;    // number of rows
+    void   appendRow(double x, double label, const QVector<double> &vec);
+    double at(qint32 row, qint32 column) const { return mData.at(column * mCapacity + row); }
+    void   rescan(qint32 column);
+    void   reserveRows(qint32 rows);
+    void   setCell(qint32 row, qint32 column, double value);
+
+    qint32                  mCapacity; // number of rows the buffer can hold
+    qint32                  mColums;   // number of colums
+    QVector<double>         mData;     // the data to be plotted, column after column, mCapacity values per column
+    QVector<QString>        mHeader;   // the horizontal headers of the table
+    QHash<QString, QRect>   mMapping;  // not used
+    QVector<double>         mMax;      // the largest value of each column
+    QVector<double>         mMin;      // the smallest value of each column
+    qint32                  mRows;     // number of rows
 };
 
 #endif // PLTABLEMODEL_H
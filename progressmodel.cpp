@@ -0,0 +1,123 @@
+// The progress of all the loads running at the same time: bytes and files downloaded, months merged and steps done
+// any thread adds to the counters without lock, the GUI thread reads them at a fixed rate and announces a change
+// singleton
+
+#include <QStringList>
+
+#include "progressmodel.h"
+
+//===========================================================================
+ProgressModel::ProgressModel(QObject *parent) : QObject(parent),
+    mPolled(-1)
+{
+    // ctor
+
+    for (qint32 unit = 0; unit < kNUnits; unit++) {
+        mDone[unit].store(0);
+        mTotal[unit].store(0);
+    }
+    mTimer.setInterval(kInterval);
+    connect(&mTimer, &QTimer::timeout, this, &ProgressModel::poll);
+}
+
+//===========================================================================
+void ProgressModel::add(Unit unit, qint64 done, qint64 total)
+{
+    // adds to the counters of unit, can be called from any thread as often as needed
+
+    if (done)
+        mDone[unit].fetchAndAddRelaxed(done);
+    if (total)
+        mTotal[unit].fetchAndAddRelaxed(total);
+}
+
+//===========================================================================
+double ProgressModel::fraction() const
+{
+    // the part done, the mean over the units in use
+
+    double sum = 0.0;
+    qint32 units = 0;
+    for (qint32 unit = 0; unit < kNUnits; unit++) {
+        qint64 total = mTotal[unit].load();
+        if (total <= 0)
+            continue;
+        sum += qMin(1.0, double(mDone[unit].load()) / total);
+        units++;
+    }
+    return units ? sum / units : 0.0;
+}
+
+//===========================================================================
+ProgressModel &ProgressModel::instance()
+{
+    // created at first use, in the GUI thread
+
+    static ProgressModel instance;
+    return instance;
+}
+
+//===========================================================================
+void ProgressModel::poll()
+{
+    // announces a change if a counter moved since the last poll
+
+    qint64 sum = 0;
+    for (qint32 unit = 0; unit < kNUnits; unit++)
+        sum += mDone[unit].load() + mTotal[unit].load();
+    if (sum == mPolled)
+        return;
+    mPolled = sum;
+    emit changed();
+}
+
+//===========================================================================
+void ProgressModel::reset()
+{
+    // forgets what was counted, done when no load is running
+
+    for (qint32 unit = 0; unit < kNUnits; unit++) {
+        mDone[unit].store(0);
+        mTotal[unit].store(0);
+    }
+    mPolled = -1;
+}
+
+//===========================================================================
+void ProgressModel::start()
+{
+    // starts the updates, GUI thread only
+
+    if (!mTimer.isActive())
+        mTimer.start();
+}
+
+//===========================================================================
+void ProgressModel::stop()
+{
+    // stops the updates, GUI thread only
+
+    mTimer.stop();
+    poll();
+}
+
+//===========================================================================
+QString ProgressModel::text() const
+{
+    // what is done, for example "3/12 files (1.2/4.0 MB), 5/36 months"
+
+    QStringList parts;
+    if (total(kFiles) > 0) {
+        QString files = QString("%1/%2 files").arg(done(kFiles)).arg(total(kFiles));
+        if (total(kBytes) > 0)
+            files.append(QString(" (%1/%2 MB)").arg(done(kBytes) / 1e6, 0, 'f', 1).arg(total(kBytes) / 1e6, 0, 'f', 1));
+        else if (done(kBytes) > 0)
+            files.append(QString(" (%1 MB)").arg(done(kBytes) / 1e6, 0, 'f', 1));
+        parts << files;
+    }
+    if (total(kMonths) > 0)
+        parts << QString("%1/%2 months").arg(done(kMonths)).arg(total(kMonths));
+    if (total(kSteps) > 0)
+        parts << QString("%1/%2 steps").arg(done(kSteps)).arg(total(kSteps));
+    return parts.join(", ");
+}
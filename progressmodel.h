@@ -0,0 +1,46 @@
+// The progress of all the loads running at the same time: bytes and files downloaded, months merged and steps done
+// any thread adds to the counters without lock, the GUI thread reads them at a fixed rate and announces a change
+// singleton
+
+#ifndef PROGRESSMODEL_H
+#define PROGRESSMODEL_H
+
+#include <QAtomicInteger>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class ProgressModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Unit {kBytes, kFiles, kMonths, kSteps, kNUnits};
+    Q_ENUM (Unit)
+
+    static ProgressModel &instance();
+
+    void    add(Unit unit, qint64 done, qint64 total);
+    qint64  done(Unit unit) const  { return mDone[unit].load(); }
+    double  fraction() const;
+    void    reset();
+    void    start();
+    void    stop();
+    QString text() const;
+    qint64  total(Unit unit) const { return mTotal[unit].load(); }
+
+signals:
+    void    changed(); // at most every kInterval ms while started
+
+private:
+    ProgressModel(QObject *parent = 0);
+    void    poll();
+
+    static const qint32    kInterval = 100;  // the period of the UI updates in ms
+    QAtomicInteger<qint64> mDone[kNUnits];   // what is done per unit
+    qint64                 mPolled;          // the sum of the counters at the last poll, used in the GUI thread only
+    QAtomicInteger<qint64> mTotal[kNUnits];  // what is expected per unit
+    QTimer                 mTimer;           // polls the counters
+};
+
+#endif // PROGRESSMODEL_H
@@ -6,6 +6,8 @@
 
 #include <QObject>
 
+#include "allocstats.h"
+
 class Resources : public QObject
 {
     Q_OBJECT
@@ -45,6 +47,7 @@ private:
     double mCPU;      // CPU resources in  kHEPSPEC06
     double mDisk;     // Disk resources in TBytes
     double mTape;     // Tape resources in TBytes
+    ALLOC_LIVE(AllocStats::kResources);
 };
 
 #endif // RESOURCES_H
@@ -0,0 +1,45 @@
+// Fills chart series from the columns of a PlTableModel
+// the points are collected in one vector and installed with a single replace(),
+// so that the chart is updated once per series instead of once per point;
+// the series follow later edits of the table
+
+#include <QBarSet>
+#include <QXYSeries>
+
+#include "pltablemodel.h"
+#include "seriesbuilder.h"
+
+//===========================================================================
+void SeriesBuilder::bind(QXYSeries *series, PlTableModel *model, qint32 xColumn, qint32 yColumn)
+{
+    // the points (xColumn, yColumn) of model in series, rebuilt when the model changes
+
+    series->replace(model->points(xColumn, yColumn));
+
+    auto refill = [series, model, xColumn, yColumn] { series->replace(model->points(xColumn, yColumn)); };
+    QObject::connect(model, &QAbstractItemModel::dataChanged, series,
+                     [refill, xColumn, yColumn](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        if ((xColumn >= topLeft.column() && xColumn <= bottomRight.column()) ||
+            (yColumn >= topLeft.column() && yColumn <= bottomRight.column()))
+            refill();
+    });
+    QObject::connect(model, &QAbstractItemModel::rowsInserted, series, refill);
+    QObject::connect(model, &QAbstractItemModel::rowsRemoved, series, refill);
+    QObject::connect(model, &QAbstractItemModel::modelReset, series, refill);
+}
+
+//===========================================================================
+void SeriesBuilder::bind(QBarSet *set, PlTableModel *model, qint32 column)
+{
+    // the values of column in set, appended at once; an edited cell replaces its bar
+
+    set->append(model->values(column).toList());
+
+    QObject::connect(model, &QAbstractItemModel::dataChanged, set,
+                     [set, model, column](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        if (column < topLeft.column() || column > bottomRight.column())
+            return;
+        for (qint32 row = topLeft.row(); row <= bottomRight.row() && row < set->count(); row++)
+            set->replace(row, model->value(row, column));
+    });
+}
@@ -0,0 +1,29 @@
+// Fills chart series from the columns of a PlTableModel
+// the points are collected in one vector and installed with a single replace(),
+// so that the chart is updated once per series instead of once per point;
+// the series follow later edits of the table
+
+#ifndef SERIESBUILDER_H
+#define SERIESBUILDER_H
+
+#include <QChartGlobal>
+
+QT_CHARTS_BEGIN_NAMESPACE
+class QBarSet;
+class QXYSeries;
+QT_CHARTS_END_NAMESPACE
+QT_CHARTS_USE_NAMESPACE
+
+class PlTableModel;
+
+class SeriesBuilder
+{
+public:
+    static void bind(QXYSeries *series, PlTableModel *model, qint32 xColumn, qint32 yColumn);
+    static void bind(QBarSet *set, PlTableModel *model, qint32 column);
+
+private:
+    SeriesBuilder() {;}
+};
+
+#endif // SERIESBUILDER_H
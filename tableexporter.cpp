@@ -0,0 +1,184 @@
+// Exports a table model to a file as CSV, TSV or JSON Lines
+// rows are streamed one by one to a QSaveFile, the raw values are written instead of the displayed strings
+
+#include <QAbstractItemModel>
+#include <QDebug>
+#include <QLocale>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtMath>
+
+#include "logger.h"
+#include "tableexporter.h"
+
+//===========================================================================
+QString TableExporter::escape(const QString &text, Format format)
+{
+    // quotes a string for the given format
+
+    switch (format) {
+    case kCSV:
+    {
+        if (!text.contains(QChar(',')) && !text.contains(QChar('"')) && !text.contains(QChar('\n')))
+            return text;
+        QString rv = text;
+        rv.replace(QChar('"'), QString("\"\""));
+        return QString("\"%1\"").arg(rv);
+    }
+    case kTSV:
+    {
+        QString rv = text;
+        rv.replace(QChar('\t'), QChar(' '));
+        rv.replace(QChar('\n'), QChar(' '));
+        return rv;
+    }
+    case kJSONL:
+    {
+        QString rv;
+        rv.reserve(text.size() + 2);
+        rv += QChar('"');
+        for (const QChar &c : text) {
+            switch (c.unicode()) {
+            case '"':
+                rv += QString("\\\"");
+                break;
+            case '\\':
+                rv += QString("\\\\");
+                break;
+            case '\n':
+                rv += QString("\\n");
+                break;
+            case '\t':
+                rv += QString("\\t");
+                break;
+            case '\r':
+                rv += QString("\\r");
+                break;
+            default:
+                if (c.unicode() < 0x20)
+                    rv += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+                else
+                    rv += c;
+                break;
+            }
+        }
+        rv += QChar('"');
+        return rv;
+    }
+    default:
+        break;
+    }
+    return text;
+}
+
+//===========================================================================
+bool TableExporter::exportModel(const QAbstractItemModel *model, const QString &fileName, Format format, int role)
+{
+    // writes the header and then each row of model, nothing is kept in memory but the current row
+    // the file is replaced only when all the rows were written
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(lcUi) << Q_FUNC_INFO << "cannot open" << fileName << file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+
+    qint32 columns = model->columnCount();
+    qint32 rows    = model->rowCount();
+
+    QStringList header;
+    header.reserve(columns);
+    for (qint32 col = 0; col < columns; col++)
+        header << model->headerData(col, Qt::Horizontal, Qt::DisplayRole).toString().simplified();
+    if (format != kJSONL) {
+        QStringList fields;
+        fields.reserve(columns);
+        for (const QString &name : header)
+            fields << escape(name, format);
+        writeRow(out, header, fields, format);
+    }
+
+    QStringList fields;
+    fields.reserve(columns);
+    for (qint32 row = 0; row < rows; row++) {
+        fields.clear();
+        for (qint32 col = 0; col < columns; col++)
+            fields << field(model->data(model->index(row, col), role), format);
+        writeRow(out, header, fields, format);
+    }
+
+    out.flush();
+    if (out.status() != QTextStream::Ok || !file.commit()) {
+        qCWarning(lcUi) << Q_FUNC_INFO << "cannot write" << fileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+//===========================================================================
+QString TableExporter::field(const QVariant &value, Format format)
+{
+    // a number is written with the shortest exact representation,
+    // an undefined value as an empty field (null in JSON)
+
+    bool isNumber = value.type() == QVariant::Double || value.type() == QVariant::Int ||
+                    value.type() == QVariant::LongLong || value.type() == QVariant::UInt;
+    if (!value.isValid() || (isNumber && !qIsFinite(value.toDouble())))
+        return format == kJSONL ? QString("null") : QString();
+    if (value.type() == QVariant::Double)
+        return QString::number(value.toDouble(), 'g', QLocale::FloatingPointShortest);
+    if (isNumber)
+        return value.toString();
+    if (value.type() == QVariant::Bool && format == kJSONL)
+        return value.toBool() ? QString("true") : QString("false");
+    return escape(value.toString(), format);
+}
+
+//===========================================================================
+QString TableExporter::filters()
+{
+    // the filters of the file dialog, one per format
+
+    return QString("CSV (*.csv);;TSV (*.tsv);;JSON Lines (*.jsonl)");
+}
+
+//===========================================================================
+TableExporter::Format TableExporter::formatOf(const QString &filter)
+{
+    // the format of a filter selected in the file dialog
+
+    if (filter.startsWith("TSV"))
+        return kTSV;
+    if (filter.startsWith("JSON"))
+        return kJSONL;
+    return kCSV;
+}
+
+//===========================================================================
+void TableExporter::writeRow(QTextStream &out, const QStringList &header, const QStringList &fields, Format format)
+{
+    // one line per row, the JSON objects are keyed by the column headers
+
+    switch (format) {
+    case kCSV:
+        out << fields.join(QChar(','));
+        break;
+    case kTSV:
+        out << fields.join(QChar('\t'));
+        break;
+    case kJSONL:
+        out << '{';
+        for (qint32 col = 0; col < fields.size(); col++) {
+            if (col > 0)
+                out << ',';
+            out << escape(header.at(col), kJSONL) << ':' << fields.at(col);
+        }
+        out << '}';
+        break;
+    default:
+        break;
+    }
+    out << '\n';
+}
@@ -0,0 +1,34 @@
+// Exports a table model to a file as CSV, TSV or JSON Lines
+// rows are streamed one by one to a QSaveFile, the raw values are written instead of the displayed strings
+
+#ifndef TABLEEXPORTER_H
+#define TABLEEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+class QAbstractItemModel;
+class QTextStream;
+
+class TableExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {kCSV, kTSV, kJSONL};
+    Q_ENUM (Format)
+
+    static bool    exportModel(const QAbstractItemModel *model, const QString &fileName, Format format, int role = Qt::UserRole);
+    static QString filters();
+    static Format  formatOf(const QString &filter);
+
+private:
+    TableExporter() {;}
+    static QString escape(const QString &text, Format format);
+    static QString field(const QVariant &value, Format format);
+    static void    writeRow(QTextStream &out, const QStringList &header, const QStringList &fields, Format format);
+};
+
+#endif // TABLEEXPORTER_H
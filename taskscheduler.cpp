@@ -0,0 +1,229 @@
+// Runs the fetch and parse tasks on a pool of workers, the most urgent first:
+// the tasks of the window the user is looking at, then the others, then the speculative prefetch.
+// each worker has its own deques, one per priority, and steals from the others when they hold more urgent tasks or it has none
+// singleton
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadStorage>
+
+#include "taskscheduler.h"
+
+namespace {
+struct Current {
+    Current() : priority(TaskScheduler::kNormal), owner(Q_NULLPTR) {}
+    TaskScheduler::Priority priority; // the priority of the task running in the thread
+    QObject                 *owner;   // its owner
+    CancelToken             token;    // the token of its load
+};
+QThreadStorage<Current> gCurrent;
+}
+
+//===========================================================================
+class TaskScheduler::Runner : public QRunnable
+{
+    // the loop of a worker in a thread of the pool
+
+public:
+    Runner(TaskScheduler *scheduler, qint32 worker) : mScheduler(scheduler), mWorker(worker) {}
+    void run() { mScheduler->work(mWorker); }
+
+private:
+    TaskScheduler *mScheduler; // the scheduler owning the worker
+    qint32        mWorker;     // the index of the worker
+};
+
+//===========================================================================
+TaskScheduler::TaskScheduler(QObject *parent) : QObject(parent),
+    mNext(0), mPending(0), mStopping(false)
+{
+    // ctor
+    // one worker per core, the workers live as long as the application
+
+    qint32 workers = qMax(2, QThread::idealThreadCount());
+    mPool.setMaxThreadCount(workers);
+    mPool.setExpiryTimeout(-1);
+    for (qint32 index = 0; index < workers; index++) {
+        mWorkers.append(new Worker);
+        mPool.start(new Runner(this, index));
+    }
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &TaskScheduler::stop);
+}
+
+//===========================================================================
+TaskScheduler::~TaskScheduler()
+{
+    // dtor
+
+    stop();
+    qDeleteAll(mWorkers);
+}
+
+//===========================================================================
+QObject *TaskScheduler::currentOwner()
+{
+    // the owner of the task running in this thread, the tasks it posts inherit it
+
+    return gCurrent.localData().owner;
+}
+
+//===========================================================================
+TaskScheduler::Priority TaskScheduler::currentPriority()
+{
+    // the priority of the task running in this thread, kNormal outside the tasks
+
+    return gCurrent.localData().priority;
+}
+
+//===========================================================================
+CancelToken TaskScheduler::currentToken()
+{
+    // the cancel token of the task running in this thread, the tasks and downloads it starts carry it
+
+    return gCurrent.localData().token;
+}
+
+//===========================================================================
+TaskScheduler &TaskScheduler::instance()
+{
+    // created at first use, when the application object exists
+
+    static TaskScheduler instance;
+    return instance;
+}
+
+//===========================================================================
+void TaskScheduler::post(Priority priority, QObject *owner, Task task, const CancelToken &token)
+{
+    // queues task on the next worker, can be called from any thread
+    // the task runs with token, by default the one of the load posting it
+
+    Entry entry;
+    entry.owner = owner;
+    entry.task  = task;
+    entry.token = token;
+    Worker *worker = mWorkers.at(quint32(mNext.fetchAndAddRelaxed(1)) % mWorkers.size());
+    {
+        QMutexLocker locker(&worker->mutex);
+        worker->lanes[priority].enqueue(entry);
+    }
+    QMutexLocker locker(&mIdleLock);
+    mPending++;
+    mIdle.wakeOne();
+}
+
+//===========================================================================
+void TaskScheduler::promote(QObject *owner)
+{
+    // the waiting tasks of owner, the window the user now looks at, pass before the others
+
+    if (!owner)
+        return;
+    for (Worker *worker : mWorkers) {
+        QMutexLocker locker(&worker->mutex);
+        for (qint32 priority = kNormal; priority < kNPriorities; priority++) {
+            QQueue<Entry> &lane = worker->lanes[priority];
+            for (qint32 index = 0; index < lane.size(); ) {
+                if (lane.at(index).owner == owner)
+                    worker->lanes[kVisible].enqueue(lane.takeAt(index));
+                else
+                    index++;
+            }
+        }
+    }
+}
+
+//===========================================================================
+void TaskScheduler::setCurrent(Priority priority, QObject *owner, const CancelToken &token)
+{
+    // for the threads running tasks of their own (the ingestion thread): what they post or fetch inherits priority, owner and token
+
+    Current &current = gCurrent.localData();
+    current.priority = priority;
+    current.owner    = owner;
+    current.token    = token;
+}
+
+//===========================================================================
+void TaskScheduler::stop()
+{
+    // the workers run the waiting tasks and leave, so that no future is left unfinished
+
+    {
+        QMutexLocker locker(&mIdleLock);
+        if (mStopping)
+            return;
+        mStopping = true;
+        mIdle.wakeAll();
+    }
+    mPool.waitForDone();
+}
+
+//===========================================================================
+bool TaskScheduler::take(qint32 worker, Entry &entry, Priority &priority)
+{
+    // the most urgent task for worker: the head of its own lane, or the tail of a more urgent lane of another worker
+
+    qint32 own = kNPriorities;
+    Worker *self = mWorkers.at(worker);
+    {
+        QMutexLocker locker(&self->mutex);
+        for (qint32 p = kVisible; p < kNPriorities; p++)
+            if (!self->lanes[p].isEmpty()) {
+                own = p;
+                break;
+            }
+    }
+
+    // steal when another worker has a more urgent task
+    for (qint32 p = kVisible; p < own; p++) {
+        for (qint32 offset = 1; offset < mWorkers.size(); offset++) {
+            Worker *victim = mWorkers.at((worker + offset) % mWorkers.size());
+            QMutexLocker locker(&victim->mutex);
+            if (!victim->lanes[p].isEmpty()) {
+                entry    = victim->lanes[p].takeLast();
+                priority = Priority(p);
+                return true;
+            }
+        }
+    }
+
+    if (own == kNPriorities)
+        return false;
+    QMutexLocker locker(&self->mutex);
+    for (qint32 p = kVisible; p < kNPriorities; p++) // a thief may have emptied the lane meanwhile
+        if (!self->lanes[p].isEmpty()) {
+            entry    = self->lanes[p].dequeue();
+            priority = Priority(p);
+            return true;
+        }
+    return false;
+}
+
+//===========================================================================
+void TaskScheduler::work(qint32 worker)
+{
+    // the loop of a worker: takes the most urgent task and runs it, waits when there is none
+
+    forever {
+        {
+            QMutexLocker locker(&mIdleLock);
+            while (mPending == 0 && !mStopping)
+                mIdle.wait(&mIdleLock);
+            if (mPending == 0)
+                return;
+            mPending--; // reserves one of the waiting tasks
+        }
+
+        Entry entry;
+        Priority priority;
+        while (!take(worker, entry, priority)) // the reserved task is being moved by a thief or by promote
+            QThread::yieldCurrentThread();
+        setCurrent(priority, entry.owner, entry.token);
+        entry.task();
+        setCurrent(kNormal, Q_NULLPTR);
+    }
+}
@@ -0,0 +1,90 @@
+// Runs the fetch and parse tasks on a pool of workers, the most urgent first:
+// the tasks of the window the user is looking at, then the others, then the speculative prefetch.
+// each worker has its own deques, one per priority, and steals from the others when they hold more urgent tasks or it has none
+// singleton
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <functional>
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "canceltoken.h"
+
+class TaskScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {kVisible, kNormal, kPrefetch, kNPriorities};
+    Q_ENUM (Priority)
+
+    typedef std::function<void()> Task;
+
+    static TaskScheduler &instance();
+
+    static QObject     *currentOwner();
+    static Priority    currentPriority();
+    static CancelToken currentToken();
+    void               post(Priority priority, QObject *owner, Task task, const CancelToken &token = currentToken());
+    void               promote(QObject *owner);
+    template <typename F>
+    auto               run(Priority priority, QObject *owner, F f) -> QFuture<decltype(f())>;
+    static void        setCurrent(Priority priority, QObject *owner, const CancelToken &token = CancelToken());
+    void               stop();
+
+private:
+    struct Entry {
+        QObject     *owner; // the window waiting for the task, never dereferenced
+        Task        task;   // what to do
+        CancelToken token;  // the token of the load posting the task, inherited by the task
+    };
+
+    struct Worker {
+        QMutex        mutex;               // protects lanes, the worker and the thieves take it one at a time
+        QQueue<Entry> lanes[kNPriorities]; // the waiting tasks by priority, the owner pops the head, the thieves the tail
+    };
+
+    class Runner;
+
+    TaskScheduler(QObject *parent = 0);
+    ~TaskScheduler();
+    bool take(qint32 worker, Entry &entry, Priority &priority);
+    void work(qint32 worker);
+
+    QWaitCondition  mIdle;     // the workers without task wait on it
+    QMutex          mIdleLock; // protects mPending and mStopping for mIdle
+    QAtomicInt      mNext;     // the worker receiving the next task, round robin
+    qint32          mPending;  // the number of tasks posted and not yet taken
+    QThreadPool     mPool;     // runs one Runner per worker
+    bool            mStopping; // the workers leave once the waiting tasks are done
+    QList<Worker*>  mWorkers;  // one per thread of mPool
+};
+
+//===========================================================================
+template <typename F>
+auto TaskScheduler::run(Priority priority, QObject *owner, F f) -> QFuture<decltype(f())>
+{
+    // runs f on a worker and returns its result as a future
+    // f is skipped if its load is cancelled before it starts, the result is then a default value
+
+    typedef decltype(f()) R;
+    QFutureInterface<R> promise;
+    promise.reportStarted();
+    post(priority, owner, [promise, f]() mutable {
+        promise.reportResult(currentToken().isCancelled() ? R() : f());
+        promise.reportFinished();
+    });
+    return promise.future();
+}
+
+#endif // TASKSCHEDULER_H
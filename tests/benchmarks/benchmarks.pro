@@ -0,0 +1,15 @@
+# Benchmarks of the ingestion and aggregation hot paths on the sample of tests/data at 1x, 10x and 100x its size
+# run with make check, or ./tst_hotpaths -median 5 for steadier numbers
+# qmake -r CONFIG+=alloc_stats counts the allocations of the hot paths too, see HOTPATHS_ALLOC_BASELINE in tst_hotpaths.cpp
+
+QT       += testlib
+
+CONFIG   += testcase c++11
+CONFIG   -= app_bundle
+
+TARGET    = tst_hotpaths
+TEMPLATE  = app
+
+include(../../ComputingResources.pri)
+
+SOURCES  += tst_hotpaths.cpp
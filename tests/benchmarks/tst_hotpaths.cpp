@@ -0,0 +1,372 @@
+// Benchmarks of the hot paths of the ingestion and aggregation on the sample of tests/data at 1x, 10x and 100x its size:
+// the Glance, REBUS and requirements parsers, the clustering of the funding agencies, the search* lookups,
+// the rows and the model of the big table, the parse and merge of a monthly report and the MonALISA csv of the plots
+// the larger sizes repeat the rows of the sample files (see scaled), the runs use a scratch ALICE
+// the stages building the collaboration (glance, clustering, REBUS, merge) change it and are measured once per size,
+// the others are repeated by QBENCHMARK
+// a sample written by tools/datagen (its default first month is that of tests/data) is taken with HOTPATHS_DATA
+// built with CONFIG += alloc_stats the allocations of a run of every hot path are counted: HOTPATHS_ALLOC_BASELINE=<file>
+// writes them in file on the first run, the next runs fail when a hot path allocates more than in file
+
+#include <functional>
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+
+#include "alice.h"
+#include "allocstats.h"
+#include "mainwindow.h"
+#include "naming.h"
+
+class HotPaths : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parseGlanceData_data() { scales(); }
+    void parseGlanceData();
+    void organizeFA_data() { scales(); }
+    void organizeFA();
+    void parseRebus_data() { scales(); }
+    void parseRebus();
+    void parseRequirements_data() { scales(); }
+    void parseRequirements();
+    void search_data() { scales(); }
+    void search();
+    void reqAndPleTable_data() { scales(); }
+    void reqAndPleTable();
+    void setTable_data() { scales(); }
+    void setTable();
+    void computeMonthlyUsage_data() { scales(); }
+    void computeMonthlyUsage();
+    void mergeMonthlyUsage_data() { scales(); }
+    void mergeMonthlyUsage();
+    void parsePlotUrlFile_data() { scales(); }
+    void parsePlotUrlFile();
+
+private:
+    enum Stage {kNone, kGlance, kOrganized, kRebus, kRequirements};
+
+    struct ScratchDeleter {
+        static void cleanup(ALICE *scratch) { if (scratch) scratch->clear(); delete scratch; }
+    };
+    typedef QScopedPointer<ALICE, ScratchDeleter> Scratch; // the funding agencies are deleted with the scratch ALICE
+
+    void              countAllocations(const std::function<void()> &run);
+    static QByteArray readFile(const QString &fileName);
+    static QByteArray scaled(const QByteArray &csv, qint32 factor);
+    static void       scales();
+    void              prepare(ALICE *scratch, Stage stage, qint32 scale) const;
+
+    QJsonObject       mAllocations;  // the allocations of a run per hot path and scale
+    QString           mBaseline;     // the file of the allocations to compare to, HOTPATHS_ALLOC_BASELINE
+    QJsonObject       mExpected;     // the allocations of mBaseline, empty when this run writes it
+    QByteArray        mGlance;       // MandO.csv
+    QDate             mMonth;        // the month of the monthly report
+    QByteArray        mRebus;        // pledges.csv
+    QList<QByteArray> mReports;      // the four files of the monthly report, in the order of ALICE::fetchMonthlyReport
+    QByteArray        mRequirements; // Requirements.csv
+    QString           mYear;         // the year of the sample
+};
+
+//===========================================================================
+void HotPaths::initTestCase()
+{
+    // reads the sample, its dictionary replaces the one in the resources
+    // HOTPATHS_DATA=<dir>/data takes a larger sample written by tools/datagen in <dir> instead of tests/data
+
+    QString dir = QString::fromLocal8Bit(qgetenv("HOTPATHS_DATA"));
+    if (dir.isEmpty())
+        dir = QFINDTESTDATA("../data");
+    QVERIFY2(!dir.isEmpty(), "tests/data not found");
+    Naming::setFileName(QString("%1/NamingDictionary.csv").arg(dir));
+
+    mYear         = "2017";
+    mMonth        = QDate(2017, 1, 1);
+    mGlance       = readFile(QString("%1/%2/MandO.csv").arg(dir, mYear));
+    mRebus        = readFile(QString("%1/%2/pledges.csv").arg(dir, mYear));
+    mRequirements = readFile(QString("%1/%2/Requirements.csv").arg(dir, mYear));
+    QString month = QString("%1/%2/%3").arg(dir, mYear).arg(mMonth.month());
+    mReports << readFile(QString("%1/TIER1_TIER1_sum_normcpu_TIER1_VO.csv").arg(month))
+             << readFile(QString("%1/reptier2.csv").arg(month))
+             << readFile(QString("%1/CPU_Usage.csv").arg(month))
+             << readFile(QString("%1/Disk_Tape_Usage.csv").arg(month));
+    QVERIFY(!mGlance.isEmpty() && !mRebus.isEmpty() && !mRequirements.isEmpty());
+    for (const QByteArray &report : mReports)
+        QVERIFY(!report.isEmpty());
+
+    mBaseline = QString::fromLocal8Bit(qgetenv("HOTPATHS_ALLOC_BASELINE"));
+    if (mBaseline.isEmpty())
+        return;
+    if (!AllocStats::enabled()) {
+        qWarning() << "HOTPATHS_ALLOC_BASELINE is ignored, the allocations are counted in a build with CONFIG += alloc_stats";
+        return;
+    }
+    QFile baseline(mBaseline);
+    if (baseline.open(QIODevice::ReadOnly))
+        mExpected = QJsonDocument::fromJson(baseline.readAll()).object();
+}
+
+//===========================================================================
+void HotPaths::cleanupTestCase()
+{
+    // writes the baseline of the allocations if it did not exist
+
+    if (mBaseline.isEmpty() || !AllocStats::enabled() || QFile::exists(mBaseline))
+        return;
+    QFile baseline(mBaseline);
+    QVERIFY2(baseline.open(QIODevice::WriteOnly), qPrintable(QString("%1 cannot be written").arg(mBaseline)));
+    baseline.write(QJsonDocument(mAllocations).toJson());
+}
+
+//===========================================================================
+void HotPaths::countAllocations(const std::function<void()> &run)
+{
+    // runs once the hot path of the current test and row and counts its allocations in this thread
+    // they vary less than the times from one machine to the other, a hot path allocating more than the baseline fails
+
+    qint64 allocations = AllocStats::threadAllocations();
+    run();
+    if (!AllocStats::enabled())
+        return;
+    allocations = AllocStats::threadAllocations() - allocations;
+    QString key = QString("%1@%2").arg(QTest::currentTestFunction(), QTest::currentDataTag());
+    mAllocations.insert(key, double(allocations));
+    qint64 expected = qint64(mExpected.value(key).toDouble(-1));
+    if (expected >= 0 && allocations > expected)
+        QFAIL(qPrintable(QString("%1 allocations instead of %2").arg(allocations).arg(expected)));
+}
+
+//===========================================================================
+void HotPaths::prepare(ALICE *scratch, Stage stage, qint32 scale) const
+{
+    // runs on scratch the stages of the ingestion up to stage, outside of the measures
+
+    if (stage >= kGlance)
+        scratch->parseGlanceData(scaled(mGlance, scale));
+    if (stage >= kOrganized)
+        scratch->organizeFA();
+    if (stage >= kRebus)
+        scratch->parseRebus(mYear, scaled(mRebus, scale));
+    if (stage >= kRequirements)
+        scratch->parseRequirements(mYear, scaled(mRequirements, scale));
+}
+
+//===========================================================================
+QByteArray HotPaths::readFile(const QString &fileName)
+{
+    // the content of fileName, empty if it cannot be read
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+//===========================================================================
+QByteArray HotPaths::scaled(const QByteArray &csv, qint32 factor)
+{
+    // csv with its header line, factor times its data lines and its trailing Total lines once
+    // the parsers see factor times the rows and still find the totals after the last one
+
+    if (factor <= 1)
+        return csv;
+    QList<QByteArray> lines = csv.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty())
+        lines.removeLast();
+    if (lines.size() < 2)
+        return csv;
+    qint32 end = lines.size();
+    while (end > 1 && lines.at(end - 1).startsWith("Total"))
+        end--;
+
+    QByteArray rows   = lines.mid(1, end - 1).join('\n') + '\n';
+    QByteArray totals = end < lines.size() ? lines.mid(end).join('\n') + '\n' : QByteArray();
+    QByteArray rv;
+    rv.reserve(lines.first().size() + 1 + rows.size() * factor + totals.size());
+    rv.append(lines.first()).append('\n');
+    for (qint32 copy = 0; copy < factor; copy++)
+        rv.append(rows);
+    rv.append(totals);
+    return rv;
+}
+
+//===========================================================================
+void HotPaths::scales()
+{
+    // the rows of every benchmark: the sample at 1x, 10x and 100x its size
+
+    QTest::addColumn<qint32>("scale");
+    QTest::newRow("1x")   << 1;
+    QTest::newRow("10x")  << 10;
+    QTest::newRow("100x") << 100;
+}
+
+//===========================================================================
+void HotPaths::parseGlanceData()
+{
+    QFETCH(qint32, scale);
+    QByteArray glance = scaled(mGlance, scale);
+    Scratch scratch(ALICE::createScratch());
+    bool ok = false;
+    QBENCHMARK_ONCE {
+        countAllocations([&]{ ok = scratch->parseGlanceData(glance); });
+    }
+    QVERIFY(ok);
+}
+
+//===========================================================================
+void HotPaths::organizeFA()
+{
+    QFETCH(qint32, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kGlance, scale);
+    QBENCHMARK_ONCE {
+        countAllocations([&]{ scratch->organizeFA(); });
+    }
+}
+
+//===========================================================================
+void HotPaths::parseRebus()
+{
+    QFETCH(qint32, scale);
+    QByteArray rebus = scaled(mRebus, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kOrganized, scale);
+    bool ok = false;
+    QBENCHMARK_ONCE {
+        countAllocations([&]{ ok = scratch->parseRebus(mYear, rebus); });
+    }
+    QVERIFY(ok);
+}
+
+//===========================================================================
+void HotPaths::parseRequirements()
+{
+    QFETCH(qint32, scale);
+    QByteArray requirements = scaled(mRequirements, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kRebus, scale);
+    auto run = [&]{ scratch->parseRequirements(mYear, requirements); };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+}
+
+//===========================================================================
+void HotPaths::search()
+{
+    // every funding agency, site, CE and SE of the collaboration looked up by its name
+
+    QFETCH(qint32, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kRebus, scale);
+    auto run = [&]{
+        for (FundingAgency *fa : scratch->fundingAgencies()) {
+            scratch->searchFA(fa->name());
+            for (Tier *tier : fa->tiers()) {
+                scratch->searchTier(tier->getWLCGName());
+                for (const QString &ce : tier->ces())
+                    scratch->searchCE(ce);
+                for (const QString &se : tier->ses())
+                    scratch->searchSE(se);
+            }
+        }
+    };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+}
+
+//===========================================================================
+void HotPaths::reqAndPleTable()
+{
+    QFETCH(qint32, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kRequirements, scale);
+    ALICE::Table rows;
+    auto run = [&]{ rows = scratch->reqAndPleTable(); };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+    QVERIFY(!rows.isEmpty());
+}
+
+//===========================================================================
+void HotPaths::setTable()
+{
+    QFETCH(qint32, scale);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kRequirements, scale);
+    ALICE::Table rows = scratch->reqAndPleTable();
+    auto run = [&]{
+        FATableModel model(&scratch->ledger()); // a new model every run, setting the same rows again is only a diff
+        model.setTable(FATableModel::kReqAndPle, rows);
+    };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+}
+
+//===========================================================================
+void HotPaths::computeMonthlyUsage()
+{
+    QFETCH(qint32, scale);
+    QList<QByteArray> reports;
+    for (const QByteArray &report : mReports)
+        reports.append(scaled(report, scale));
+    ALICE::MonthlyUsage usage;
+    auto run = [&]{ usage = ALICE::computeMonthlyUsage(mMonth, reports); };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+    QVERIFY(usage.found);
+    QCOMPARE(usage.t1CPU.size(), scale * ALICE::computeMonthlyUsage(mMonth, mReports).t1CPU.size()); // the rows before Total are all read
+}
+
+//===========================================================================
+void HotPaths::mergeMonthlyUsage()
+{
+    QFETCH(qint32, scale);
+    QList<QByteArray> reports;
+    for (const QByteArray &report : mReports)
+        reports.append(scaled(report, scale));
+    ALICE::MonthlyUsage usage = ALICE::computeMonthlyUsage(mMonth, reports);
+    Scratch scratch(ALICE::createScratch());
+    prepare(scratch.data(), kRequirements, scale);
+    QBENCHMARK_ONCE {
+        countAllocations([&]{ scratch->mergeMonthlyUsage(usage); });
+    }
+}
+
+//===========================================================================
+void HotPaths::parsePlotUrlFile()
+{
+    // the MonALISA csv of the efficiency profiles
+
+    QFETCH(qint32, scale);
+    QByteArray csv = scaled(mReports.at(2), scale);
+    auto run = [&]{
+        QList<QVector<double>*> plData;
+        QList<QString>          plDataName;
+        MainWindow::parsePlotUrlFile(MainWindow::kTierEfficiencyProfile, csv, plData, plDataName);
+        qDeleteAll(plData);
+    };
+    countAllocations(run);
+    QBENCHMARK {
+        run();
+    }
+}
+
+QTEST_MAIN(HotPaths)
+#include "tst_hotpaths.moc"
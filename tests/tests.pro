@@ -0,0 +1,6 @@
+# The tests of ComputingResources, run with make check
+# the sample data they read is in data/, in the layout of the data server (see tools/datagen)
+
+TEMPLATE = subdirs
+
+SUBDIRS += benchmarks
@@ -7,6 +7,7 @@
 #include <QMap>
 #include <QObject>
 
+#include "allocstats.h"
 #include "resources.h"
 
 class Tier : public QObject
@@ -26,6 +27,7 @@ public:
     void    addCEs(const QList<QString> &list);
     void    addSEs(const QList<QString> &list);
     TierCat category() const { return mTierCategory; }
+    const QList<QString> &ces() const { return mMLCENames; }
     void    clearUsed(const QString &month);
     qint32  countWLCGAlias() const { return mWLCGAliasNames.size(); }
     bool    findCE(const QString &ce);
@@ -40,6 +42,7 @@ public:
     QString getWLCGName() const  { return mWLCGName; }
     QString list() const;
     void    addAlias(QString alias) { mWLCGAliasNames.append(alias); }
+    const QList<QString> &ses() const { return mMLSENames; }
     void    setUsedCPU(QString &month, double cpu);
     double  usedCPU(const QString &m) const { return mUsed[m].getCPU(); }
     double  usedDisk(const QString &m) const { return mUsed[m].getDisk(); }
@@ -53,6 +56,7 @@ private:
     QList<QString>             mWLCGAliasNames;// Aliases name in WLCG
     QString                    mWLCGName;      // The name in WLCG
     QMap<QString, Resources>   mUsed;          // The resources in this site (CPU, disk, tape) per month
+    ALLOC_LIVE(AllocStats::kTier);
 };
 
 #endif // TIER_H
@@ -0,0 +1,151 @@
+// A time series kept at several resolutions: the raw points and their aggregates
+// per hour, per day and per week (min, max and mean of each bucket).
+// A chart picks the level matching the visible time span, zooming never needs a new download.
+
+#include <algorithm>
+#include <cmath>
+
+#include "timeseriespyramid.h"
+
+//===========================================================================
+TimeSeriesPyramid::TimeSeriesPyramid(const QVector<QPointF> &points)
+{
+    // builds all the levels from the raw points (x in ms since epoch, sorted in time)
+    // each level is aggregated from the previous one, weighted by the number of raw points
+
+    QVector<Bucket> &raw = mLevels[kRaw];
+    raw.reserve(points.size());
+    for (const QPointF &point : points) {
+        Bucket bucket;
+        bucket.x     = point.x();
+        bucket.min   = point.y();
+        bucket.max   = point.y();
+        bucket.mean  = point.y();
+        bucket.count = 1;
+        raw.append(bucket);
+    }
+
+    for (qint32 level = kHourly; level < kNLevels; level++) {
+        const QVector<Bucket> &finer = mLevels[level - 1];
+        QVector<Bucket> &coarser     = mLevels[level];
+        double w = width(static_cast<Level>(level));
+        qint64 current = 0;
+        double sumX    = 0.0;
+        double sumY    = 0.0;
+        for (const Bucket &bucket : finer) {
+            qint64 key = qint64(std::floor(bucket.x / w));
+            if (coarser.isEmpty() || key != current) {
+                if (!coarser.isEmpty()) {
+                    coarser.last().x    = sumX / coarser.last().count;
+                    coarser.last().mean = sumY / coarser.last().count;
+                }
+                coarser.append(bucket);
+                current = key;
+                sumX    = bucket.x * bucket.count;
+                sumY    = bucket.mean * bucket.count;
+                continue;
+            }
+            Bucket &last = coarser.last();
+            last.min    = qMin(last.min, bucket.min);
+            last.max    = qMax(last.max, bucket.max);
+            last.count += bucket.count;
+            sumX       += bucket.x * bucket.count;
+            sumY       += bucket.mean * bucket.count;
+        }
+        if (!coarser.isEmpty()) {
+            coarser.last().x    = sumX / coarser.last().count;
+            coarser.last().mean = sumY / coarser.last().count;
+        }
+    }
+}
+
+//===========================================================================
+qint32 TimeSeriesPyramid::count(Level level, double from, double to) const
+{
+    // number of buckets of level between from and to
+
+    return qMax(0, last(level, to) - first(level, from) + 1);
+}
+
+//===========================================================================
+qint32 TimeSeriesPyramid::first(Level level, double from) const
+{
+    // index of the first bucket at or after from
+
+    const QVector<Bucket> &buckets = mLevels[level];
+    return std::lower_bound(buckets.constBegin(), buckets.constEnd(), from,
+                            [](const Bucket &bucket, double x) { return bucket.x < x; }) - buckets.constBegin();
+}
+
+//===========================================================================
+qint32 TimeSeriesPyramid::last(Level level, double to) const
+{
+    // index of the last bucket at or before to
+
+    const QVector<Bucket> &buckets = mLevels[level];
+    return std::upper_bound(buckets.constBegin(), buckets.constEnd(), to,
+                            [](double x, const Bucket &bucket) { return x < bucket.x; }) - buckets.constBegin() - 1;
+}
+
+//===========================================================================
+TimeSeriesPyramid::Level TimeSeriesPyramid::level(double from, double to, qint32 maxPoints) const
+{
+    // the finest level with no more than maxPoints buckets between from and to
+
+    for (qint32 level = kRaw; level < kNLevels; level++)
+        if (count(static_cast<Level>(level), from, to) <= maxPoints)
+            return static_cast<Level>(level);
+    return kWeekly;
+}
+
+//===========================================================================
+QVector<QPointF> TimeSeriesPyramid::points(Level level, double from, double to) const
+{
+    // the mean of the buckets of level between from and to, with one more bucket
+    // on each side so that the line reaches the edges of the plot
+
+    const QVector<Bucket> &buckets = mLevels[level];
+    qint32 begin = qMax(0, first(level, from) - 1);
+    qint32 end   = qMin(buckets.size() - 1, last(level, to) + 1);
+    QVector<QPointF> rv;
+    if (end < begin)
+        return rv;
+    rv.reserve(end - begin + 1);
+    for (qint32 index = begin; index <= end; index++)
+        rv.append(QPointF(buckets.at(index).x, buckets.at(index).mean));
+    return rv;
+}
+
+//===========================================================================
+qint64 TimeSeriesPyramid::width(Level level)
+{
+    // the time span of a bucket of level in ms
+
+    switch (level) {
+    case kHourly:
+        return Q_INT64_C(3600000);
+    case kDaily:
+        return Q_INT64_C(24) * 3600000;
+    case kWeekly:
+        return Q_INT64_C(7) * 24 * 3600000;
+    default:
+        break;
+    }
+    return 1;
+}
+
+//===========================================================================
+double TimeSeriesPyramid::xMax() const
+{
+    // time of the last point
+
+    return isEmpty() ? 0.0 : mLevels[kRaw].last().x;
+}
+
+//===========================================================================
+double TimeSeriesPyramid::xMin() const
+{
+    // time of the first point
+
+    return isEmpty() ? 0.0 : mLevels[kRaw].first().x;
+}
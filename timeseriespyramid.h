@@ -0,0 +1,44 @@
+// A time series kept at several resolutions: the raw points and their aggregates
+// per hour, per day and per week (min, max and mean of each bucket).
+// A chart picks the level matching the visible time span, zooming never needs a new download.
+
+#ifndef TIMESERIESPYRAMID_H
+#define TIMESERIESPYRAMID_H
+
+#include <QPointF>
+#include <QVector>
+
+class TimeSeriesPyramid
+{
+public:
+    enum Level {kRaw, kHourly, kDaily, kWeekly, kNLevels};
+
+    struct Bucket {
+        double x;     // the mean time of the points in the bucket (ms since epoch)
+        double min;   // the smallest value
+        double max;   // the largest value
+        double mean;  // the mean value
+        qint32 count; // number of raw points in the bucket
+    };
+
+    TimeSeriesPyramid() {;}
+    explicit TimeSeriesPyramid(const QVector<QPointF> &points);
+
+    const QVector<Bucket> &buckets(Level level) const { return mLevels[level]; }
+    qint32                count(Level level, double from, double to) const;
+    bool                  isEmpty() const { return mLevels[kRaw].isEmpty(); }
+    Level                 level(double from, double to, qint32 maxPoints) const;
+    QVector<QPointF>      points(Level level, double from, double to) const;
+    double                xMax() const;
+    double                xMin() const;
+
+    static qint64         width(Level level);
+
+private:
+    qint32 first(Level level, double from) const;
+    qint32 last(Level level, double to) const;
+
+    QVector<Bucket> mLevels[kNLevels]; // the buckets of each level, sorted in time
+};
+
+#endif // TIMESERIESPYRAMID_H
@@ -0,0 +1,123 @@
+// Times the stages of the loads (network, parsing, name lookups, tables, plots) for the whole session
+// a ScopedTimer measures its scope and adds it to the statistics of its stage: count, total, median and 95th percentile
+// the times are inclusive, a stage nested in another one is counted in both
+// switched off by default, a disabled timer only reads two flags (see Tracer)
+// singleton
+
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QPair>
+#include <QStringList>
+
+#include "timing.h"
+
+QAtomicInt Timing::mEnabled(0);
+
+//===========================================================================
+Timing &Timing::instance()
+{
+    // created at first use, from any thread
+
+    static Timing instance;
+    return instance;
+}
+
+//===========================================================================
+qint64 Timing::percentile(QVector<qint64> samples, double fraction)
+{
+    // the sample below which fraction of the samples are
+
+    if (samples.isEmpty())
+        return 0;
+    qint32 rank = qMin(samples.size() - 1, qint32(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples.at(rank);
+}
+
+//===========================================================================
+void Timing::record(const char *stage, qint64 nsecs)
+{
+    // adds a run of stage, can be called from any thread
+
+    QMutexLocker locker(&mMutex);
+    Stats &stats = mStats[QString::fromLatin1(stage)];
+    stats.count++;
+    stats.total += nsecs;
+    if (stats.samples.size() < kSamples)
+        stats.samples.append(nsecs);
+    else {
+        stats.samples[stats.next] = nsecs;
+        stats.next = (stats.next + 1) % kSamples;
+    }
+}
+
+//===========================================================================
+QString Timing::report() const
+{
+    // the table of the statistics of the session, the most expensive stage first
+
+    QList<QPair<QString, Stats> > rows;
+    {
+        QMutexLocker locker(&mMutex);
+        for (QHash<QString, Stats>::const_iterator it = mStats.constBegin(); it != mStats.constEnd(); ++it)
+            rows.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(rows.begin(), rows.end(), [](const QPair<QString, Stats> &a, const QPair<QString, Stats> &b) {
+        return a.second.total > b.second.total;
+    });
+
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5").arg("stage", -32).arg("count", 8).arg("total ms", 12).arg("p50 ms", 10).arg("p95 ms", 10);
+    for (const QPair<QString, Stats> &row : rows)
+        lines << QString("%1 %2 %3 %4 %5").arg(row.first, -32).arg(row.second.count, 8)
+                 .arg(row.second.total / 1e6, 12, 'f', 1)
+                 .arg(percentile(row.second.samples, 0.50) / 1e6, 10, 'f', 3)
+                 .arg(percentile(row.second.samples, 0.95) / 1e6, 10, 'f', 3);
+    if (rows.isEmpty())
+        lines << "no stage timed, switch the timing on in the Debug menu";
+    return lines.join('\n');
+}
+
+//===========================================================================
+void Timing::reset()
+{
+    // forgets the statistics of the session
+
+    QMutexLocker locker(&mMutex);
+    mStats.clear();
+}
+
+//===========================================================================
+QString Timing::summary(const QString &operation, qint64 nsecs, const Totals &before) const
+{
+    // one line for an operation which took nsecs: its duration and the stages which cost the most since before
+
+    QList<QPair<qint64, QString> > spent;
+    Totals now = totals();
+    for (Totals::const_iterator it = now.constBegin(); it != now.constEnd(); ++it) {
+        qint64 delta = it.value() - before.value(it.key());
+        if (delta > 0)
+            spent.append(qMakePair(delta, it.key()));
+    }
+    std::sort(spent.begin(), spent.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+        return a.first > b.first;
+    });
+
+    QStringList stages;
+    for (qint32 index = 0; index < qMin(4, spent.size()); index++)
+        stages << QString("%1 %2 ms").arg(spent.at(index).second).arg(spent.at(index).first / 1e6, 0, 'f', 1);
+    return QString("%1: %2 ms (%3)").arg(operation).arg(nsecs / 1e6, 0, 'f', 1).arg(stages.join(", "));
+}
+
+//===========================================================================
+Timing::Totals Timing::totals() const
+{
+    // the time spent so far per stage
+
+    Totals rv;
+    QMutexLocker locker(&mMutex);
+    for (QHash<QString, Stats>::const_iterator it = mStats.constBegin(); it != mStats.constEnd(); ++it)
+        rv.insert(it.key(), it.value().total);
+    return rv;
+}
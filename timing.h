@@ -0,0 +1,99 @@
+// Times the stages of the loads (network, parsing, name lookups, tables, plots) for the whole session
+// a ScopedTimer measures its scope and adds it to the statistics of its stage: count, total, median and 95th percentile
+// the times are inclusive, a stage nested in another one is counted in both
+// switched off by default, a disabled timer only reads two flags (see Tracer)
+// singleton
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "tracer.h"
+
+class Timing
+{
+public:
+    typedef QHash<QString, qint64> Totals; // the total time in ns per stage
+
+    static Timing &instance();
+
+    static bool enabled() { return mEnabled.loadAcquire(); }
+    void        record(const char *stage, qint64 nsecs);
+    QString     report() const;
+    void        reset();
+    static void setEnabled(bool on) { mEnabled.storeRelease(on); }
+    QString     summary(const QString &operation, qint64 nsecs, const Totals &before) const;
+    Totals      totals() const;
+
+private:
+    struct Stats {
+        Stats() : count(0), total(0), next(0) {}
+        qint64          count;   // the number of times the stage ran
+        qint64          total;   // the time spent in ns
+        QVector<qint64> samples; // the last kSamples times, for the percentiles
+        qint32          next;    // where the next sample goes once samples is full
+    };
+
+    Timing() {}
+    static qint64 percentile(QVector<qint64> samples, double fraction);
+
+    static const qint32   kSamples = 4096; // the samples kept per stage
+    static QAtomicInt     mEnabled;        // the timers measure only when set
+    mutable QMutex        mMutex;          // protects mStats, the stages run in all threads
+    QHash<QString, Stats> mStats;          // the statistics per stage
+};
+
+class ScopedTimer
+{
+public:
+    // measures from its construction to its destruction or to stop()
+    // the scope is also recorded in the trace when the tracer is on
+
+    explicit ScopedTimer(const char *stage, const QString &detail = QString()) :
+        mStage(Q_NULLPTR), mTimed(Timing::enabled()), mTraced(Tracer::enabled()), mBegin(0)
+    {
+        if (!mTimed && !mTraced)
+            return;
+        mStage = stage;
+        if (mTraced) {
+            mDetail = detail;
+            mBegin  = Tracer::instance().now();
+        }
+        mTimer.start();
+    }
+    ~ScopedTimer() { stop(); }
+
+    void stop()
+    {
+        if (!mStage)
+            return;
+        qint64 nsecs = mTimer.nsecsElapsed();
+        if (mTimed)
+            Timing::instance().record(mStage, nsecs);
+        if (mTraced)
+            Tracer::instance().complete(mStage, mBegin, nsecs, mDetail);
+        mStage = Q_NULLPTR;
+    }
+
+private:
+    Q_DISABLE_COPY(ScopedTimer)
+
+    const char    *mStage;  // the stage measured, null if the timing and the tracing are off or already recorded
+    bool          mTimed;   // the stage goes to the statistics
+    bool          mTraced;  // the stage goes to the trace
+    qint64        mBegin;   // the beginning in the time base of the tracer
+    QString       mDetail;  // what the stage works on, shown in the trace
+    QElapsedTimer mTimer;   // started with the scope
+};
+
+#define TIMING_CONCAT2(a, b) a##b
+#define TIMING_CONCAT(a, b) TIMING_CONCAT2(a, b)
+#define TIMED_SCOPE(stage) ScopedTimer TIMING_CONCAT(timedScope, __LINE__)(stage)
+
+#endif // TIMING_H
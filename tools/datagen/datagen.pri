@@ -0,0 +1,7 @@
+# the synthetic data generator, to be included by the CLI or by a test harness
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/datagenerator.cpp
+
+HEADERS += $$PWD/datagenerator.h
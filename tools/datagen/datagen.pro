@@ -0,0 +1,13 @@
+# Writes synthetic input data for scale tests, see datagenerator.h
+
+QT       = core
+
+CONFIG  += console c++11
+CONFIG  -= app_bundle
+
+TARGET   = datagen
+TEMPLATE = app
+
+include(datagen.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,518 @@
+// Generates synthetic input data for scale tests, laid out as on the data server (<dir>/data/<year>/...):
+// MandO.csv (Glance), pledges.csv (REBUS) and Requirements.csv per year, and per month the EGI reports
+// TIER1_TIER1_sum_normcpu_TIER1_VO.csv and reptier2.csv and the MonALISA matrices CPU_Usage.csv and Disk_Tape_Usage.csv
+// the funding agencies and sites are those of NamingDictionary.csv, completed with synthetic ones when more are asked;
+// the dictionary extended with the synthetic sites, CEs and SEs is written to <dir>/data/NamingDictionary.csv
+// the values are drawn around realistic sizes per tier and grow by year; the same seed gives the same files
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegExp>
+#include <QSet>
+
+#include "datagenerator.h"
+
+//===========================================================================
+DataGenerator::Config::Config() :
+    fas(0), sites(0), ces(0), ses(0), from(2017, 1, 1), to(2017, 12, 1), samples(360), seed(1)
+{
+    // ctor, the funding agencies and sites of the dictionary for one year
+}
+
+//===========================================================================
+DataGenerator::DataGenerator(const Config &config) :
+    mConfig(config)
+{
+    // ctor
+}
+
+//===========================================================================
+bool DataGenerator::build()
+{
+    // the funding agencies and the sites from the dictionary, trimmed or completed up to the numbers asked
+
+    static const QStringList kT1s = QStringList() << "DE-KIT" << "FR-CCIN2P3" << "IT-INFN-CNAF" << "KR-KISTI-GSDC"
+                                                  << "NDGF" << "NL-T1" << "NRC-KI-T1" << "UK-T1-RAL";
+
+    // the funding agencies, CERN first since the requirements are shared among the others
+    QList<Agency> agencies;
+    QSet<QString> codes;
+    for (const Entry &entry : mEntries) {
+        codes.insert(entry.shortName);
+        bool known = false;
+        for (const Agency &agency : agencies)
+            known = known || agency.name == entry.fa;
+        if (known || entry.fa.isEmpty())
+            continue;
+        Agency agency;
+        agency.name      = entry.fa;
+        agency.shortName = entry.shortName;
+        if (entry.fa == "CERN")
+            agencies.prepend(agency);
+        else
+            agencies.append(agency);
+    }
+    if (agencies.isEmpty() || agencies.first().name != "CERN") {
+        mError = QString("CERN is missing from %1").arg(mConfig.naming);
+        return false;
+    }
+    if (mConfig.fas > 0 && mConfig.fas < agencies.size())
+        agencies = agencies.mid(0, mConfig.fas);
+    QChar first('Q');
+    QChar second('A');
+    for (qint32 index = agencies.size(); index < mConfig.fas; index++) {
+        QString code;
+        while (code.isEmpty() || codes.contains(code)) {
+            if (first > QChar('Z')) {
+                mError = "no country code left for the synthetic funding agencies";
+                return false;
+            }
+            code = QString(first) + QString(second);
+            second = QChar(second.unicode() + 1);
+            if (second > QChar('Z')) {
+                second = QChar('A');
+                first  = QChar(first.unicode() + 1);
+            }
+        }
+        codes.insert(code);
+        Agency agency;
+        agency.name      = QString("Synthetic %1").arg(index, 4, 10, QChar('0'));
+        agency.shortName = code;
+        agencies.append(agency);
+    }
+    for (Agency &agency : agencies) {
+        agency.member = agency.name == "CERN" || noise(agency.name, 1, 1.0) > 0.4; // about 4 in 5 are members
+        double mean   = agency.name == "CERN" ? 150.0 : 15.0;
+        agency.payers = qMax(1, qRound(mean * noise(agency.name, 2, 0.8)));
+    }
+    mAgencies = agencies;
+
+    QSet<QString> selected;
+    for (const Agency &agency : agencies)
+        selected.insert(agency.name);
+
+    // the WLCG sites of the dictionary, the T0 and T1s first
+    QList<Site> wlcg;
+    QHash<QString, qint32> wlcgIndex;
+    for (const Entry &entry : mEntries) {
+        if (entry.ceWLCG.isEmpty() || !selected.contains(entry.fa))
+            continue;
+        QString key = entry.fa + ";" + entry.ceWLCG;
+        if (!wlcgIndex.contains(key)) {
+            Site site;
+            site.wlcg     = entry.ceWLCG;
+            site.fa       = entry.fa;
+            site.category = entry.ceWLCG == "CH-CERN" ? kT0 : kT1s.contains(entry.ceWLCG) ? kT1 : kT2;
+            wlcgIndex.insert(key, wlcg.size());
+            wlcg.append(site);
+        }
+        Site &site = wlcg[wlcgIndex.value(key)];
+        if (!entry.ceML.isEmpty() && !site.ces.contains(entry.ceML))
+            site.ces.append(entry.ceML);
+        if (!entry.se.isEmpty() && !site.ses.contains(entry.se))
+            site.ses.append(entry.se);
+    }
+    std::stable_sort(wlcg.begin(), wlcg.end(), [](const Site &a, const Site &b) { return a.category < b.category; });
+    if (mConfig.sites > 0 && mConfig.sites < wlcg.size())
+        wlcg = wlcg.mid(0, mConfig.sites);
+
+    // the synthetic T2s, one for each synthetic funding agency then in turn among all but CERN
+    QList<const Agency*> hosts;
+    for (const Agency &agency : mAgencies)
+        if (agency.name.startsWith("Synthetic"))
+            hosts.append(&agency);
+    qint32 wanted = qMax(mConfig.sites, wlcg.size() + hosts.size());
+    for (const Agency &agency : mAgencies)
+        if (agency.name != "CERN" && !agency.name.startsWith("Synthetic"))
+            hosts.append(&agency);
+    qint32 synthetic = 0;
+    while (wlcg.size() < wanted && !hosts.isEmpty()) {
+        const Agency *host = hosts.at(synthetic % hosts.size());
+        QString code = host->shortName.isEmpty() ? QString("XX") : host->shortName;
+        QString name = QString("%1_SYN%2").arg(code).arg(++synthetic, 4, 10, QChar('0'));
+        Site site;
+        site.wlcg     = QString("%1-T2-%2").arg(code).arg(synthetic, 4, 10, QChar('0'));
+        site.fa       = host->name;
+        site.category = kT2;
+        site.ces << name;
+        site.ses << QString("ALICE::%1::SE").arg(name);
+        wlcg.append(site);
+        Entry entry;
+        entry.shortName = host->shortName;
+        entry.fa        = host->name;
+        entry.se        = site.ses.first();
+        entry.ceML      = site.ces.first();
+        entry.ceWLCG    = site.wlcg;
+        mEntries.append(entry);
+    }
+
+    // the finer grained CEs and SEs of the WLCG sites
+    for (Site &site : wlcg) {
+        QString base = site.ces.isEmpty() ? QString(site.wlcg).replace(QRegExp("[^A-Za-z0-9]"), "_") : site.ces.first();
+        QString shortName;
+        for (const Agency &agency : mAgencies)
+            if (agency.name == site.fa)
+                shortName = agency.shortName;
+        for (qint32 index = 1; index <= qMax(mConfig.ces, mConfig.ses); index++) {
+            Entry entry;
+            entry.shortName = shortName;
+            entry.fa        = site.fa;
+            entry.ceWLCG    = site.wlcg;
+            if (index <= mConfig.ces) {
+                entry.ceML = QString("%1_CE%2").arg(base).arg(index);
+                site.ces.append(entry.ceML);
+            }
+            if (index <= mConfig.ses) {
+                entry.se = QString("ALICE::%1_%2::SE").arg(base).arg(index);
+                site.ses.append(entry.se);
+            }
+            mEntries.append(entry);
+        }
+    }
+
+    // the sites outside WLCG, their SEs are known to the loader only when they contain the name of the CE
+    QList<Site> others;
+    for (const Entry &entry : mEntries) {
+        if (!entry.ceWLCG.isEmpty() || entry.ceML.isEmpty() || !selected.contains(entry.fa))
+            continue;
+        Site site;
+        site.fa       = entry.fa;
+        site.category = kT2;
+        site.ces << entry.ceML;
+        for (const Entry &se : mEntries)
+            if (se.ceWLCG.isEmpty() && se.fa == entry.fa && !se.se.isEmpty() && se.se.contains(entry.ceML))
+                site.ses << se.se;
+        others.append(site);
+    }
+
+    mSites = wlcg + others;
+    return true;
+}
+
+//===========================================================================
+QByteArray DataGenerator::cpuUsage(const QDate &month) const
+{
+    // the CPU used per CE as sampled by MonALISA, the loader takes the mean over the month
+
+    QByteArray rv("Time");
+    QList<double> targets; // the mean of each column
+    for (const Site &site : mSites) {
+        for (const QString &ce : site.ces) {
+            rv.append(',').append(ce.toLatin1());
+            targets.append(used(site, month) / site.ces.size());
+        }
+    }
+    rv.append('\n');
+
+    qint32 hours = month.daysInMonth() * 24;
+    qint64 start = QDateTime(month).toMSecsSinceEpoch();
+    qint64 span  = qint64(hours) * 3600 * 1000;
+    std::mt19937 random(mConfig.seed ^ uint(month.year() * 12 + month.month()));
+    std::normal_distribution<double> jitter(1.0, 0.1);
+    for (qint32 sample = 0; sample < mConfig.samples; sample++) {
+        rv.append(QByteArray::number(start + span * sample / mConfig.samples));
+        double daily = 1.0 + 0.2 * std::sin(2 * M_PI * sample * month.daysInMonth() / mConfig.samples);
+        for (double target : targets) {
+            double value = target * hours * 10000 / 4.2 * daily * qMax(0.0, jitter(random)); // see ALICE::computeMonthlyUsage
+            rv.append(',').append(QByteArray::number(value, 'f', 1));
+        }
+        rv.append('\n');
+    }
+    return rv;
+}
+
+//===========================================================================
+QByteArray DataGenerator::diskTapeUsage(const QDate &month) const
+{
+    // the storage used per SE in GB as sampled by MonALISA, filling up along the month; the loader takes the maximum
+
+    QByteArray rv("Time");
+    QList<double> capacities; // the capacity of each column in GB
+    for (const Site &site : mSites) {
+        qint32 disks = 0;
+        qint32 tapes = 0;
+        for (const QString &se : site.ses)
+            isTape(se) ? tapes++ : disks++;
+        for (const QString &se : site.ses) {
+            rv.append(',').append(se.toLatin1());
+            double capacity = site.wlcg.isEmpty() ? 200.0 * noise(se, 3, 0.5)
+                                                  : pledge(site, month.year(), isTape(se) ? 2 : 1);
+            if (!site.wlcg.isEmpty() && isTape(se) && capacity == 0.0)
+                capacity = pledge(site, month.year(), 1);
+            capacities.append(capacity * 1000 / (isTape(se) ? tapes : disks));
+        }
+    }
+    rv.append('\n');
+
+    qint64 start = QDateTime(month).toMSecsSinceEpoch();
+    qint64 span  = qint64(month.daysInMonth()) * 24 * 3600 * 1000;
+    std::mt19937 random(mConfig.seed ^ uint(month.year() * 12 + month.month()) ^ 0x5bd1e995u);
+    std::normal_distribution<double> jitter(1.0, 0.02);
+    double fill = 0.55 + 0.03 * month.month(); // fills up along the year
+    for (qint32 sample = 0; sample < mConfig.samples; sample++) {
+        rv.append(QByteArray::number(start + span * sample / mConfig.samples));
+        double filled = qMin(0.97, fill + 0.03 * sample / mConfig.samples);
+        for (double capacity : capacities)
+            rv.append(',').append(QByteArray::number(capacity * filled * jitter(random), 'f', 1));
+        rv.append('\n');
+    }
+    return rv;
+}
+
+//===========================================================================
+QByteArray DataGenerator::glance(qint32 year) const
+{
+    // the M&O payers of year, one line per person as exported from Glance; the name field holds a ','
+
+    QByteArray rv("Name,Institute,Funding Agency,Start Date,End Date\n");
+    for (qint32 index = 0; index < mAgencies.size(); index++) {
+        const Agency &agency = mAgencies.at(index);
+        qint32 payers = qMax(1, qRound(agency.payers * std::pow(1.03, year - mConfig.from.year()) * noise(agency.name, year, 0.1)));
+        QString status = agency.member ? "MS" : "NMS";
+        for (qint32 payer = 0; payer < payers; payer++)
+            rv.append(QString("\"Payer%1-%2, Given\",%3 Institute %4,%5-%6,%7-09-01,%8-08-31\n")
+                      .arg(index).arg(payer).arg(agency.name).arg(payer % 3).arg(status, agency.name)
+                      .arg(year - 1).arg(year + 1).toUtf8());
+    }
+    return rv;
+}
+
+//===========================================================================
+bool DataGenerator::isTape(const QString &se)
+{
+    // as FundingAgency::addUsedDiskTape
+
+    return se.contains("TAPE") || se.contains("T0ALICE") || se.contains("CASTOR2");
+}
+
+//===========================================================================
+QByteArray DataGenerator::naming() const
+{
+    // the dictionary with the synthetic elements
+
+    QByteArray rv("Funding Agency;Storage Element;Computing Element  ML;Computing element WLCG\n");
+    for (const Entry &entry : mEntries)
+        rv.append(QString("%1;%2;%3;%4;%5\r\n").arg(entry.shortName, entry.fa, entry.se, entry.ceML, entry.ceWLCG).toUtf8());
+    return rv;
+}
+
+//===========================================================================
+double DataGenerator::noise(const QString &key, qint32 salt, double sigma) const
+{
+    // a log-normal factor of mean 1, always the same for a key, a salt and the seed
+
+    std::mt19937 random(mConfig.seed ^ qHash(key) ^ (uint(salt) * 2654435761u));
+    std::lognormal_distribution<double> distribution(-sigma * sigma / 2, sigma);
+    return distribution(random);
+}
+
+//===========================================================================
+double DataGenerator::pledge(const Site &site, qint32 year, qint32 resource) const
+{
+    // the pledge of a WLCG site in year: CPU in HEPSPEC06 (resource 0), disk (1) and tape (2) in TB
+    // around the size of its tier in 2017, growing by 15% a year
+
+    static const double kBase[3][3] = {{300000.0, 20000.0, 40000.0},  // T0
+                                       { 20000.0,  2000.0,  4000.0},  // T1
+                                       {  6000.0,   600.0,     0.0}}; // T2
+    if (site.wlcg.isEmpty())
+        return 0.0;
+    return kBase[site.category][resource] * noise(site.wlcg, resource, 0.6) * std::pow(1.15, year - 2017)
+            * noise(site.wlcg, year * 3 + resource, 0.05);
+}
+
+//===========================================================================
+bool DataGenerator::readNaming()
+{
+    // reads the dictionary, format: country code; funding agency; SE; CE in ML; CE in WLCG
+
+    QFile file(mConfig.naming);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mError = QString("File %1 cannot be opened").arg(mConfig.naming);
+        return false;
+    }
+    file.readLine(); // the header
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine());
+        line.remove("\r");
+        line.remove("\n");
+        QStringList fields = line.split(';');
+        if (fields.size() < 5)
+            continue;
+        Entry entry;
+        entry.shortName = fields.at(0);
+        entry.fa        = fields.at(1);
+        entry.se        = fields.at(2);
+        entry.ceML      = fields.at(3);
+        entry.ceWLCG    = fields.at(4);
+        mEntries.append(entry);
+    }
+    return true;
+}
+
+//===========================================================================
+QByteArray DataGenerator::rebus(qint32 year) const
+{
+    // the pledges of the WLCG sites in year as exported from REBUS: CPU then disk, then tape for the T0 and T1s
+
+    static const char *const kTiers[] = {"Tier 0", "Tier 1", "Tier 2"};
+
+    QByteArray rv("Tier,Country,Federation,Accounting Name,Pledge Unit,ALICE,ATLAS,CMS,LHCb,Sum\n");
+    for (const Site &site : mSites) {
+        if (site.wlcg.isEmpty())
+            continue;
+        for (qint32 resource = 0; resource < (site.category == kT2 ? 2 : 3); resource++) {
+            qint64 alice  = qMax(qint64(1), qint64(qRound64(pledge(site, year, resource))));
+            qint64 others = qRound64(alice * 3 * noise(site.wlcg, year * 7 + resource, 0.5));
+            rv.append(QString("%1,%2,%3,%3 accounting,%4,%5,%6,%7,%8,%9\n")
+                      .arg(kTiers[site.category], site.fa, site.wlcg, resource == 0 ? "HEP-SPEC06" : "Tbytes")
+                      .arg(alice).arg(others / 2).arg(others / 3).arg(others / 6).arg(alice + others).toUtf8());
+        }
+    }
+    return rv;
+}
+
+//===========================================================================
+QByteArray DataGenerator::requirements(qint32 year) const
+{
+    // the requirements of year per tier, a little above the pledges: CPU in kHEPSPEC06, disk and tape in PB
+
+    double sum[3][3] = {{0.0}};
+    for (const Site &site : mSites)
+        for (qint32 resource = 0; resource < 3; resource++)
+            sum[site.category][resource] += pledge(site, year, resource) / 1000;
+
+    static const char *const kRows[] = {"T0", "T1", "T2"};
+    QByteArray rv(";CPU;Disk;Tape\n");
+    double total[3] = {0.0, 0.0, 0.0};
+    for (qint32 category = kT0; category <= kT2; category++) {
+        rv.append(kRows[category]);
+        for (qint32 resource = 0; resource < 3; resource++) {
+            double required = sum[category][resource] * 1.1 * noise(kRows[category], year * 3 + resource, 0.05);
+            total[resource] += required;
+            rv.append(';').append(QByteArray::number(required, 'f', 1));
+        }
+        rv.append('\n');
+    }
+    rv.append("Total smooth");
+    for (qint32 resource = 0; resource < 3; resource++)
+        rv.append(';').append(QByteArray::number(total[resource], 'f', 1));
+    rv.append('\n');
+    return rv;
+}
+
+//===========================================================================
+QByteArray DataGenerator::tier1Report(const QDate &month) const
+{
+    // the CPU delivered by the T0 and T1s in HEPSPEC06-hours as exported from the EGI portal
+    // the files before December 2016 start with four lines to be skipped
+
+    QByteArray rv;
+    if (month < QDate(2016, 12, 1))
+        rv.append("EGI accounting\nNormalised CPU time (HEPSPEC06-hours)\nTIER1 by VO\n\n");
+    rv.append("TIER1,\"alice\",\"atlas\",\"cms\",\"lhcb\",Total\n");
+    double total = 0.0;
+    qint32 hours = month.daysInMonth() * 24;
+    for (const Site &site : mSites) {
+        if (site.wlcg.isEmpty() || site.category == kT2)
+            continue;
+        double alice = used(site, month) * 1000 * hours;
+        rv.append(QString("%1,%2,%3,%4,%5,%6\n").arg(site.wlcg).arg(qRound64(alice)).arg(qRound64(alice * 2))
+                  .arg(qRound64(alice * 1.5)).arg(qRound64(alice / 2)).arg(qRound64(alice * 5)).toUtf8());
+        total += alice * 5;
+    }
+    rv.append(QString("Total,,,,,%1\n").arg(qRound64(total)).toUtf8());
+    return rv;
+}
+
+//===========================================================================
+QByteArray DataGenerator::tier2Report(const QDate &month) const
+{
+    // the CPU delivered by the T2s in HEPSPEC06-hours as exported from the EGI portal
+    // before December 2016: four lines to be skipped then country and federation, after: the federation only
+
+    bool old = month < QDate(2016, 12, 1);
+    QByteArray rv;
+    if (old)
+        rv.append("EGI accounting\nNormalised CPU time (HEPSPEC06-hours)\nTIER2 by VO\n\n")
+          .append(QString("COUNTRY,FEDERATION,%1 CPU Pledge (HEPSPEC06),pledge inc. efficiency (HEPSPEC06-Hrs),"
+                          "SITE,alice,atlas,cms,lhcb,Total,delivered as % of pledge\n").arg(month.year()).toUtf8());
+    else
+        rv.append("FEDERATION,alice,atlas,cms,lhcb,Total\n");
+    qint32 hours = month.daysInMonth() * 24;
+    for (const Site &site : mSites) {
+        if (site.wlcg.isEmpty() || site.category != kT2)
+            continue;
+        double pledged = pledge(site, month.year(), 0);
+        double alice   = used(site, month) * 1000 * hours;
+        if (old)
+            rv.append(QString("%1,%2,%3,%4,%2,%5,%6,%7,%8,%9,%10\n").arg(site.fa, site.wlcg).arg(qRound64(pledged))
+                      .arg(qRound64(pledged * hours)).arg(qRound64(alice)).arg(qRound64(alice * 2)).arg(qRound64(alice))
+                      .arg(qRound64(alice / 2)).arg(qRound64(alice * 4.5)).arg(qRound(100 * alice / (pledged * hours))).toUtf8());
+        else
+            rv.append(QString("%1,%2,%3,%4,%5,%6\n").arg(site.wlcg).arg(qRound64(alice)).arg(qRound64(alice * 2))
+                      .arg(qRound64(alice)).arg(qRound64(alice / 2)).arg(qRound64(alice * 4.5)).toUtf8());
+    }
+    rv.append(old ? "Total,Total,,,,,,,,,\n" : "Total,,,,,\n");
+    return rv;
+}
+
+//===========================================================================
+double DataGenerator::used(const Site &site, const QDate &month) const
+{
+    // the CPU used by a site during month in kHEPSPEC06, around its pledge for the WLCG sites
+
+    qint32 key = month.year() * 12 + month.month();
+    if (site.wlcg.isEmpty())
+        return 1.0 * noise(site.ces.value(0), key, 0.5);
+    return pledge(site, month.year(), 0) / 1000 * 0.95 * noise(site.wlcg, key, 0.25);
+}
+
+//===========================================================================
+bool DataGenerator::write(const QString &dir)
+{
+    // writes all the files under dir/data
+
+    if (!readNaming() || !build())
+        return false;
+
+    QString data = QString("%1/data").arg(dir);
+    if (!writeFile(QString("%1/NamingDictionary.csv").arg(data), naming()))
+        return false;
+    for (qint32 year = mConfig.from.year(); year <= mConfig.to.year(); year++) {
+        if (!writeFile(QString("%1/%2/MandO.csv").arg(data).arg(year), glance(year)) ||
+            !writeFile(QString("%1/%2/pledges.csv").arg(data).arg(year), rebus(year)) ||
+            !writeFile(QString("%1/%2/Requirements.csv").arg(data).arg(year), requirements(year)))
+            return false;
+    }
+    for (QDate month(mConfig.from.year(), mConfig.from.month(), 1); month <= mConfig.to; month = month.addMonths(1)) {
+        QString path = QString("%1/%2/%3").arg(data).arg(month.year()).arg(month.month());
+        if (!writeFile(QString("%1/TIER1_TIER1_sum_normcpu_TIER1_VO.csv").arg(path), tier1Report(month)) ||
+            !writeFile(QString("%1/reptier2.csv").arg(path), tier2Report(month)) ||
+            !writeFile(QString("%1/CPU_Usage.csv").arg(path), cpuUsage(month)) ||
+            !writeFile(QString("%1/Disk_Tape_Usage.csv").arg(path), diskTapeUsage(month)))
+            return false;
+    }
+    return true;
+}
+
+//===========================================================================
+bool DataGenerator::writeFile(const QString &fileName, const QByteArray &data)
+{
+    // writes data in fileName, creating its directory
+
+    QDir().mkpath(QFileInfo(fileName).path());
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        mError = QString("File %1 cannot be written").arg(fileName);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+// Generates synthetic input data for scale tests, laid out as on the data server (<dir>/data/<year>/...):
+// MandO.csv (Glance), pledges.csv (REBUS) and Requirements.csv per year, and per month the EGI reports
+// TIER1_TIER1_sum_normcpu_TIER1_VO.csv and reptier2.csv and the MonALISA matrices CPU_Usage.csv and Disk_Tape_Usage.csv
+// the funding agencies and sites are those of NamingDictionary.csv, completed with synthetic ones when more are asked;
+// the dictionary extended with the synthetic sites, CEs and SEs is written to <dir>/data/NamingDictionary.csv
+// the values are drawn around realistic sizes per tier and grow by year; the same seed gives the same files
+
+#ifndef DATAGENERATOR_H
+#define DATAGENERATOR_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class DataGenerator
+{
+public:
+    struct Config {
+        Config();
+        QString naming;  // the NamingDictionary.csv the funding agencies and sites are taken from
+        qint32  fas;     // the number of funding agencies, 0 for those of the dictionary
+        qint32  sites;   // the number of WLCG sites, 0 for those of the dictionary
+        qint32  ces;     // the MonALISA CEs added to each WLCG site
+        qint32  ses;     // the SEs added to each WLCG site
+        QDate   from;    // the first month
+        QDate   to;      // the last month
+        qint32  samples; // the timestamps per month in the MonALISA matrices
+        quint32 seed;    // the seed of the random values
+    };
+
+    explicit DataGenerator(const Config &config);
+
+    QString    error() const { return mError; }
+    qint32     countFAs() const   { return mAgencies.size(); }
+    qint32     countSites() const { return mSites.size(); }
+    bool       write(const QString &dir);
+
+private:
+    enum Category {kT0, kT1, kT2};
+
+    struct Entry {
+        QString shortName; // the country code
+        QString fa;        // the funding agency
+        QString se;        // the storage element, may be empty
+        QString ceML;      // the computing element in MonALISA, may be empty
+        QString ceWLCG;    // the WLCG site, empty for the sites outside WLCG
+    };
+    struct Agency {
+        QString name;      // as in the dictionary
+        QString shortName; // the country code
+        bool    member;    // MS or NMS
+        qint32  payers;    // the M&O payers of the first year
+    };
+    struct Site {
+        QString     wlcg;     // the WLCG name, empty for a site outside WLCG
+        QString     fa;       // its funding agency
+        Category    category; // T0, T1 or T2
+        QStringList ces;      // its computing elements in MonALISA
+        QStringList ses;      // its storage elements
+    };
+
+    bool       build();
+    QByteArray cpuUsage(const QDate &month) const;
+    QByteArray diskTapeUsage(const QDate &month) const;
+    QByteArray glance(qint32 year) const;
+    QByteArray naming() const;
+    double     noise(const QString &key, qint32 salt, double sigma) const;
+    double     pledge(const Site &site, qint32 year, qint32 resource) const;
+    QByteArray rebus(qint32 year) const;
+    bool       readNaming();
+    QByteArray requirements(qint32 year) const;
+    QByteArray tier1Report(const QDate &month) const;
+    QByteArray tier2Report(const QDate &month) const;
+    double     used(const Site &site, const QDate &month) const;
+    bool       writeFile(const QString &fileName, const QByteArray &data);
+
+    static bool isTape(const QString &se);
+
+    QList<Agency> mAgencies; // the funding agencies written to Glance
+    Config        mConfig;   // what to generate
+    QList<Entry>  mEntries;  // the dictionary, extended with the synthetic elements
+    QString       mError;    // why write() failed
+    QList<Site>   mSites;    // the WLCG sites then the sites outside WLCG of the funding agencies
+};
+
+#endif // DATAGENERATOR_H
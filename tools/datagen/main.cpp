@@ -0,0 +1,61 @@
+// Writes synthetic input data for scale tests under <out>/data, see datagenerator.h
+// e.g. datagen --out /tmp/big --naming ../../data/NamingDictionary.csv --fas 200 --sites 2000 --ces 4 --ses 2
+// then HOTPATHS_DATA=/tmp/big/data tests/benchmarks/tst_hotpaths, or serve /tmp/big in place of the data server with --naming /tmp/big/data/NamingDictionary.csv
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "datagenerator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes synthetic MandO.csv, pledges.csv, Requirements.csv, EGI reports and MonALISA matrices.");
+    parser.addHelpOption();
+    QCommandLineOption outOption("out", "Writes the files under <dir>/data.", "dir");
+    QCommandLineOption namingOption("naming", "Takes the funding agencies and sites from <file>.", "file", "data/NamingDictionary.csv");
+    QCommandLineOption fasOption("fas", "Writes <n> funding agencies, 0 for those of the dictionary.", "n", "0");
+    QCommandLineOption sitesOption("sites", "Writes <n> WLCG sites, 0 for those of the dictionary.", "n", "0");
+    QCommandLineOption cesOption("ces", "Adds <n> MonALISA CEs to each WLCG site.", "n", "0");
+    QCommandLineOption sesOption("ses", "Adds <n> SEs to each WLCG site.", "n", "0");
+    QCommandLineOption fromOption("from", "Starts at <month>.", "yyyy-MM", "2017-01");
+    QCommandLineOption toOption("to", "Ends at <month>.", "yyyy-MM", "2017-12");
+    QCommandLineOption samplesOption("samples", "Writes <n> timestamps per month in the MonALISA matrices.", "n", "360");
+    QCommandLineOption seedOption("seed", "Seeds the random values with <n>.", "n", "1");
+    parser.addOptions(QList<QCommandLineOption>() << outOption << namingOption << fasOption << sitesOption << cesOption
+                      << sesOption << fromOption << toOption << samplesOption << seedOption);
+    parser.process(a);
+
+    QTextStream out(stdout);
+    if (!parser.isSet(outOption)) {
+        out << "--out <dir> is required" << endl;
+        return 1;
+    }
+
+    DataGenerator::Config config;
+    config.naming  = parser.value(namingOption);
+    config.fas     = parser.value(fasOption).toInt();
+    config.sites   = parser.value(sitesOption).toInt();
+    config.ces     = parser.value(cesOption).toInt();
+    config.ses     = parser.value(sesOption).toInt();
+    config.from    = QDate::fromString(parser.value(fromOption), "yyyy-MM");
+    config.to      = QDate::fromString(parser.value(toOption), "yyyy-MM");
+    config.samples = qMax(1, parser.value(samplesOption).toInt());
+    config.seed    = parser.value(seedOption).toUInt();
+    if (!config.from.isValid() || !config.to.isValid() || config.to < config.from) {
+        out << "--from and --to must be months yyyy-MM in order" << endl;
+        return 1;
+    }
+
+    DataGenerator generator(config);
+    if (!generator.write(parser.value(outOption))) {
+        out << generator.error() << endl;
+        return 1;
+    }
+    out << QString("%1 funding agencies and %2 sites written to %3/data")
+           .arg(generator.countFAs()).arg(generator.countSites()).arg(parser.value(outOption)) << endl;
+    return 0;
+}
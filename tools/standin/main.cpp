@@ -0,0 +1,49 @@
+// Serves a directory tree in place of the data servers, see standinserver.h
+// e.g. standin --root /tmp/big --port 8080 --latency 150 --jitter 50 --bandwidth 2000000 --errors 0.01
+// then ComputingResources --base-url http://localhost:8080 --naming /tmp/big/data/NamingDictionary.csv
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QHostAddress>
+#include <QTextStream>
+
+#include "standinserver.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serves a directory tree in place of alicecrm, alimonitor and EGI accounting.");
+    parser.addHelpOption();
+    QCommandLineOption rootOption("root", "Serves the files under <dir>.", "dir", ".");
+    QCommandLineOption portOption("port", "Listens on <port> of localhost.", "port", "8080");
+    QCommandLineOption latencyOption("latency", "Waits <ms> before each response.", "ms", "0");
+    QCommandLineOption jitterOption("jitter", "Adds up to <ms> to the latency.", "ms", "0");
+    QCommandLineOption bandwidthOption("bandwidth", "Sends at most <bytes> per second on each connection, 0 for no limit.", "bytes", "0");
+    QCommandLineOption errorsOption("errors", "Answers a <fraction> of the requests with a 500 error.", "fraction", "0");
+    QCommandLineOption dropsOption("drops", "Closes the connection in the middle of a <fraction> of the responses.", "fraction", "0");
+    QCommandLineOption seedOption("seed", "Seeds the latencies and the failures with <n>.", "n", "1");
+    parser.addOptions(QList<QCommandLineOption>() << rootOption << portOption << latencyOption << jitterOption
+                      << bandwidthOption << errorsOption << dropsOption << seedOption);
+    parser.process(a);
+
+    StandInServer::Config config;
+    config.root      = QDir(parser.value(rootOption)).absolutePath();
+    config.latency   = parser.value(latencyOption).toInt();
+    config.jitter    = parser.value(jitterOption).toInt();
+    config.bandwidth = parser.value(bandwidthOption).toLongLong();
+    config.errors    = parser.value(errorsOption).toDouble();
+    config.drops     = parser.value(dropsOption).toDouble();
+    config.seed      = parser.value(seedOption).toUInt();
+
+    QTextStream out(stdout);
+    StandInServer server(config);
+    if (!server.listen(QHostAddress::LocalHost, parser.value(portOption).toUShort())) {
+        out << server.errorString() << endl;
+        return 1;
+    }
+    out << QString("serving %1 on http://localhost:%2").arg(config.root).arg(server.serverPort()) << endl;
+    return a.exec();
+}
@@ -0,0 +1,9 @@
+# the stand-in server of the data servers, to be included by the CLI or by a test harness
+
+QT          += network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/standinserver.cpp
+
+HEADERS += $$PWD/standinserver.h
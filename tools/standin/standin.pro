@@ -0,0 +1,13 @@
+# Serves a directory tree in place of the data servers, see standinserver.h
+
+QT       = core network
+
+CONFIG  += console c++11
+CONFIG  -= app_bundle
+
+TARGET   = standin
+TEMPLATE = app
+
+include(standin.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,223 @@
+// A local HTTP server standing in for the data servers of the application, to measure the downloads offline
+// it serves a directory tree laid out as the ALICE web site (<root>/data/<year>/...) and the csv of the queries:
+//   alimonitor /display?page=<page>&interval.min=<min>&interval.max=<max>...
+//       <root>/display/<page>/<min>_<max>.csv, or <root>/display/<page>.csv for any interval
+//   EGI /custom_xml.php?option=<option>&sYear=..&sMonth=..&eYear=..&eMonth=..
+//       <root>/custom_xml/<option>/<sYear>-<sMonth>_<eYear>-<eMonth>.csv, or <root>/custom_xml/<option>.csv
+//   alimonitor /production/raw.jsp
+//       <root>/production/raw.csv
+// each response waits a latency, is sent at a limited rate and may fail on purpose, all drawn from a seed
+// the application is pointed to it with --base-url http://localhost:<port>
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+
+#include "standinserver.h"
+
+//===========================================================================
+StandInServer::Config::Config() :
+    latency(0), jitter(0), bandwidth(0), errors(0.0), drops(0.0), seed(1)
+{
+    // ctor, serves as fast as possible and never fails
+}
+
+//===========================================================================
+StandInServer::StandInServer(const Config &config, QObject *parent) : QTcpServer(parent),
+    mConfig(config), mRandom(config.seed), mUniform(0.0, 1.0)
+{
+    // ctor
+}
+
+//===========================================================================
+qint32 StandInServer::delay()
+{
+    // the latency of the next response in ms
+
+    return mConfig.latency + qRound(mConfig.jitter * mUniform(mRandom));
+}
+
+//===========================================================================
+QString StandInServer::fileName(const QUrl &url) const
+{
+    // the file served for url, empty if there is none
+
+    QString path = url.path();
+    if (path.contains(".."))
+        return QString();
+
+    QUrlQuery query(url);
+    auto item = [&query](const QString &key) { return query.queryItemValue(key, QUrl::FullyDecoded); };
+    QStringList candidates;
+    if (path.endsWith("/display")) {
+        QString page = item("page");
+        if (page.isEmpty() || page.contains(".."))
+            return QString();
+        QString dir = QString("%1/display/%2").arg(mConfig.root, page);
+        candidates << QString("%1/%2_%3.csv").arg(dir, item("interval.min"), item("interval.max"))
+                   << QString("%1.csv").arg(dir);
+    } else if (path.endsWith("/custom_xml.php")) {
+        QString option = item("option");
+        if (option.isEmpty() || option.contains(".."))
+            return QString();
+        QString dir = QString("%1/custom_xml/%2").arg(mConfig.root, option);
+        candidates << QString("%1/%2-%3_%4-%5.csv").arg(dir, item("sYear"), item("sMonth"), item("eYear"), item("eMonth"))
+                   << QString("%1.csv").arg(dir);
+    } else if (path.endsWith("/production/raw.jsp"))
+        candidates << QString("%1/production/raw.csv").arg(mConfig.root);
+    else
+        candidates << mConfig.root + path;
+
+    for (const QString &candidate : candidates)
+        if (QFileInfo(candidate).isFile())
+            return candidate;
+    return QString();
+}
+
+//===========================================================================
+void StandInServer::incomingConnection(qintptr handle)
+{
+    // each connection is served by its own object, deleted when the client disconnects
+
+    QTcpSocket *socket = new QTcpSocket;
+    if (!socket->setSocketDescriptor(handle)) {
+        delete socket;
+        return;
+    }
+    new StandInConnection(this, socket);
+}
+
+//===========================================================================
+bool StandInServer::roll(double fraction)
+{
+    // true for a fraction of the calls
+
+    return fraction > 0.0 && mUniform(mRandom) < fraction;
+}
+
+//===========================================================================
+StandInConnection::StandInConnection(StandInServer *server, QTcpSocket *socket) : QObject(server),
+    mBusy(false), mOffset(0), mServer(server), mSocket(socket), mTimer(Q_NULLPTR)
+{
+    // ctor
+
+    mSocket->setParent(this);
+    mTimer = new QTimer(this);
+    mTimer->setInterval(10);
+    connect(mTimer, &QTimer::timeout, this, &StandInConnection::send);
+    connect(mSocket, &QTcpSocket::readyRead, this, &StandInConnection::read);
+    connect(mSocket, &QTcpSocket::disconnected, this, &QObject::deleteLater);
+}
+
+//===========================================================================
+void StandInConnection::read()
+{
+    // parses the requests received, only their head is read since GET has no body
+
+    mBuffer.append(mSocket->readAll());
+    qint32 end;
+    while ((end = mBuffer.indexOf("\r\n\r\n")) != -1) {
+        QList<QByteArray> lines = mBuffer.left(end).split('\n');
+        mBuffer.remove(0, end + 4);
+        QList<QByteArray> fields = lines.first().trimmed().split(' ');
+        if (fields.size() != 3)
+            continue;
+        Request request;
+        request.method = fields.at(0);
+        request.url    = QUrl(QString::fromLatin1(fields.at(1)));
+        request.close  = fields.at(2) == "HTTP/1.0";
+        for (const QByteArray &line : lines.mid(1)) {
+            QByteArray header = line.trimmed().toLower();
+            if (header.startsWith("connection:"))
+                request.close = header.contains("close");
+        }
+        mRequests.enqueue(request);
+    }
+    respond();
+}
+
+//===========================================================================
+void StandInConnection::respond()
+{
+    // prepares the response of the next request and starts it after the latency
+
+    if (mBusy || mRequests.isEmpty())
+        return;
+    mBusy = true;
+    Request request = mRequests.dequeue();
+
+    QByteArray status("200 OK");
+    QByteArray body;
+    QString fileName = mServer->fileName(request.url);
+    if (request.method != "GET")
+        status = "405 Method Not Allowed";
+    else if (fileName.isEmpty())
+        status = "404 Not Found";
+    else if (mServer->roll(mServer->config().errors))
+        status = "500 Internal Server Error";
+    else {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly))
+            body = file.readAll();
+        else
+            status = "403 Forbidden";
+    }
+
+    mResponse.close = request.close;
+    mResponse.data  = QByteArray("HTTP/1.1 ") + status + "\r\n"
+                    + "Content-Type: " + (status.startsWith("200") ? "text/csv" : "text/plain") + "\r\n"
+                    + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                    + "Connection: " + (request.close ? "close" : "keep-alive") + "\r\n\r\n";
+    mResponse.end   = mResponse.data.size() + body.size();
+    if (!body.isEmpty() && mServer->roll(mServer->config().drops)) {
+        mResponse.end  -= body.size() / 2;
+        mResponse.close = true;
+    }
+    mResponse.data.append(body);
+    qInfo().noquote() << request.method << request.url.toString() << status.left(3) << fileName;
+
+    QTimer::singleShot(mServer->delay(), this, &StandInConnection::start);
+}
+
+//===========================================================================
+void StandInConnection::send()
+{
+    // sends what the bandwidth allows since the start of the response, then the next response
+
+    qint64 bandwidth = mServer->config().bandwidth;
+    qint64 allowed   = bandwidth > 0 ? bandwidth * mClock.elapsed() / 1000 : mResponse.end;
+    qint64 until     = qMin(allowed, mResponse.end);
+    if (until > mOffset) {
+        mSocket->write(mResponse.data.constData() + mOffset, until - mOffset);
+        mOffset = until;
+    }
+    if (mOffset < mResponse.end)
+        return;
+
+    mTimer->stop();
+    mResponse.data.clear();
+    if (mResponse.close) {
+        mSocket->disconnectFromHost();
+        return;
+    }
+    mBusy = false;
+    respond();
+}
+
+//===========================================================================
+void StandInConnection::start()
+{
+    // the latency is over, the response is sent in slices
+
+    if (mSocket->state() != QAbstractSocket::ConnectedState)
+        return;
+    mOffset = 0;
+    mClock.start();
+    send();
+    if (mBusy && mOffset < mResponse.end)
+        mTimer->start();
+}
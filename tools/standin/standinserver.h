@@ -0,0 +1,93 @@
+// A local HTTP server standing in for the data servers of the application, to measure the downloads offline
+// it serves a directory tree laid out as the ALICE web site (<root>/data/<year>/...) and the csv of the queries:
+//   alimonitor /display?page=<page>&interval.min=<min>&interval.max=<max>...
+//       <root>/display/<page>/<min>_<max>.csv, or <root>/display/<page>.csv for any interval
+//   EGI /custom_xml.php?option=<option>&sYear=..&sMonth=..&eYear=..&eMonth=..
+//       <root>/custom_xml/<option>/<sYear>-<sMonth>_<eYear>-<eMonth>.csv, or <root>/custom_xml/<option>.csv
+//   alimonitor /production/raw.jsp
+//       <root>/production/raw.csv
+// each response waits a latency, is sent at a limited rate and may fail on purpose, all drawn from a seed
+// the application is pointed to it with --base-url http://localhost:<port>
+
+#ifndef STANDINSERVER_H
+#define STANDINSERVER_H
+
+#include <random>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QString>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+class QTimer;
+class StandInServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    struct Config {
+        Config();
+        QString root;      // the directory served
+        qint32  latency;   // the time in ms before the response is sent
+        qint32  jitter;    // a time in ms drawn between 0 and jitter is added to the latency
+        qint64  bandwidth; // the bytes per second sent on each connection, 0 for no limit
+        double  errors;    // the fraction of the responses replaced by a 500 Internal Server Error
+        double  drops;     // the fraction of the responses whose connection is closed in the middle of the body
+        quint32 seed;      // the seed of the latencies and of the failures
+    };
+
+    explicit StandInServer(const Config &config, QObject *parent = Q_NULLPTR);
+
+    const Config &config() const { return mConfig; }
+    qint32        delay();
+    QString       fileName(const QUrl &url) const;
+    bool          roll(double fraction);
+
+protected:
+    void          incomingConnection(qintptr handle) Q_DECL_OVERRIDE;
+
+private:
+    Config                                 mConfig;  // how to serve
+    std::mt19937                           mRandom;  // draws the latencies and the failures
+    std::uniform_real_distribution<double> mUniform; // between 0 and 1
+};
+
+class StandInConnection : public QObject
+{
+    Q_OBJECT
+
+public:
+    StandInConnection(StandInServer *server, QTcpSocket *socket);
+
+private:
+    struct Request {
+        QByteArray method;  // GET is the only one served
+        QUrl       url;     // the path and the query
+        bool       close;   // the client asked to close the connection after the response
+    };
+    struct Response {
+        QByteArray data;    // the status line, the headers and the content
+        qint64     end;     // the bytes sent before the connection is closed, less than the size of data to drop it
+        bool       close;   // the connection is closed after the response
+    };
+
+    void read();
+    void respond();
+    void send();
+    void start();
+
+    bool                 mBusy;     // a response is being sent, the next requests wait
+    QByteArray           mBuffer;   // the bytes received not yet parsed
+    QElapsedTimer        mClock;    // times the response being sent
+    qint64               mOffset;   // the bytes of mResponse already sent
+    QQueue<Request>      mRequests; // the requests waiting for their response
+    Response             mResponse; // the response being sent
+    StandInServer        *mServer;  // the server
+    QTcpSocket           *mSocket;  // the connection
+    QTimer               *mTimer;   // paces the sending
+};
+
+#endif // STANDINSERVER_H
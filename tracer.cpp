@@ -0,0 +1,180 @@
+// Records what the threads do during a session (fetches, parses, lookups, model builds, chart renders)
+// as begin/end events in a ring buffer and writes them as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+// the scopes timed by ScopedTimer are recorded as complete events, the downloads as asynchronous events
+// since they overlap in the network thread
+// switched off by default, a disabled tracer only reads a flag
+// singleton
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "tracer.h"
+
+QAtomicInt Tracer::mEnabled(0);
+
+//===========================================================================
+Tracer::Tracer() :
+    mLastId(0), mNext(0), mSize(0)
+{
+    // ctor (private)
+
+    mClock.start();
+    mEvents.resize(kCapacity);
+}
+
+//===========================================================================
+void Tracer::asyncBegin(const char *name, quint64 id, const QString &detail)
+{
+    // the beginning of an operation which may overlap others of the same thread, ended by asyncEnd with the same id
+
+    Event event;
+    event.name   = name;
+    event.phase  = 'b';
+    event.ts     = now();
+    event.id     = id;
+    event.detail = detail;
+    record(event);
+}
+
+//===========================================================================
+void Tracer::asyncEnd(const char *name, quint64 id)
+{
+    // the end of the operation started by asyncBegin
+
+    Event event;
+    event.name  = name;
+    event.phase = 'e';
+    event.ts    = now();
+    event.id    = id;
+    record(event);
+}
+
+//===========================================================================
+void Tracer::complete(const char *name, qint64 begin, qint64 nsecs, const QString &detail)
+{
+    // an operation of the current thread which began at begin (see now()) and took nsecs
+
+    Event event;
+    event.name   = name;
+    event.phase  = 'X';
+    event.ts     = begin;
+    event.dur    = nsecs;
+    event.detail = detail;
+    record(event);
+}
+
+//===========================================================================
+Tracer &Tracer::instance()
+{
+    // created at first use, from any thread
+
+    static Tracer instance;
+    return instance;
+}
+
+//===========================================================================
+void Tracer::record(Event &event)
+{
+    // adds event to the ring, can be called from any thread
+
+    QThread *thread = QThread::currentThread();
+
+    QMutexLocker locker(&mMutex);
+    if (!mThreadIds.contains(thread)) {
+        QString name = thread->objectName();
+        if (qApp && thread == qApp->thread())
+            name = "GUI";
+        else if (name.isEmpty())
+            name = QString("pool %1").arg(mThreadNames.size());
+        mThreadIds.insert(thread, mThreadNames.size());
+        mThreadNames.append(name);
+    }
+    event.tid = mThreadIds.value(thread);
+    mEvents[mNext] = event;
+    mNext = (mNext + 1) % kCapacity;
+    mSize = qMin(mSize + 1, kCapacity);
+}
+
+//===========================================================================
+qint32 Tracer::size() const
+{
+    // the number of events recorded
+
+    QMutexLocker locker(&mMutex);
+    return mSize;
+}
+
+//===========================================================================
+void Tracer::start()
+{
+    // forgets the previous trace and records from now on
+
+    {
+        QMutexLocker locker(&mMutex);
+        mNext = 0;
+        mSize = 0;
+        mThreadIds.clear();
+        mThreadNames.clear();
+    }
+    mEnabled.storeRelease(1);
+}
+
+//===========================================================================
+void Tracer::stop()
+{
+    // no more events are recorded, the trace is kept for write()
+
+    mEnabled.storeRelease(0);
+}
+
+//===========================================================================
+bool Tracer::write(const QString &fileName) const
+{
+    // writes the events of the ring, the oldest first, in the Chrome trace event format (times in us)
+
+    QJsonArray events;
+    {
+        QMutexLocker locker(&mMutex);
+        for (qint32 tid = 0; tid < mThreadNames.size(); tid++) {
+            QJsonObject meta;
+            meta.insert("name", "thread_name");
+            meta.insert("ph", "M");
+            meta.insert("pid", 1);
+            meta.insert("tid", tid);
+            meta.insert("args", QJsonObject{{"name", mThreadNames.at(tid)}});
+            events.append(meta);
+        }
+        qint32 first = (mNext - mSize + kCapacity) % kCapacity;
+        for (qint32 index = 0; index < mSize; index++) {
+            const Event &event = mEvents.at((first + index) % kCapacity);
+            QJsonObject json;
+            json.insert("name", QString::fromLatin1(event.name));
+            json.insert("ph", QString(QChar(event.phase)));
+            json.insert("pid", 1);
+            json.insert("tid", event.tid);
+            json.insert("ts", event.ts / 1000.0);
+            if (event.phase == 'X')
+                json.insert("dur", event.dur / 1000.0);
+            else {
+                json.insert("cat", QString::fromLatin1(event.name));
+                json.insert("id", QString::number(event.id));
+            }
+            if (!event.detail.isEmpty())
+                json.insert("args", QJsonObject{{"detail", event.detail}});
+            events.append(json);
+        }
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QJsonObject trace;
+    trace.insert("traceEvents", events);
+    trace.insert("displayTimeUnit", "ms");
+    return file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) != -1;
+}
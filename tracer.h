@@ -0,0 +1,90 @@
+// Records what the threads do during a session (fetches, parses, lookups, model builds, chart renders)
+// as begin/end events in a ring buffer and writes them as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+// the scopes timed by ScopedTimer are recorded as complete events, the downloads as asynchronous events
+// since they overlap in the network thread
+// switched off by default, a disabled tracer only reads a flag
+// singleton
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QThread;
+class Tracer
+{
+public:
+    static Tracer &instance();
+
+    void        asyncBegin(const char *name, quint64 id, const QString &detail = QString());
+    void        asyncEnd(const char *name, quint64 id);
+    void        complete(const char *name, qint64 begin, qint64 nsecs, const QString &detail = QString());
+    static bool enabled() { return mEnabled.loadAcquire(); }
+    quint64     nextId() { return quint64(mLastId.fetchAndAddRelaxed(1)) + 1; }
+    qint64      now() const { return mClock.nsecsElapsed(); }
+    qint32      size() const;
+    void        start();
+    void        stop();
+    bool        write(const QString &fileName) const;
+
+private:
+    struct Event {
+        Event() : name(Q_NULLPTR), phase(0), ts(0), dur(0), tid(0), id(0) {}
+        const char *name;   // what was done, a literal
+        char       phase;   // 'X' complete, 'b' and 'e' asynchronous begin and end
+        qint64     ts;      // when it began in ns since the tracer exists
+        qint64     dur;     // how long it took in ns, complete events only
+        qint32     tid;     // the thread which did it, its index in mThreadNames
+        quint64    id;      // pairs the asynchronous begin and end
+        QString    detail;  // what it was done on, an url, a step, etc.
+    };
+
+    Tracer();
+    void record(Event &event);
+
+    static const qint32      kCapacity = 1 << 16; // the events kept, the oldest are overwritten
+    QElapsedTimer            mClock;              // the time base of the events
+    static QAtomicInt        mEnabled;            // the events are recorded only when set
+    QVector<Event>           mEvents;             // the ring buffer
+    QAtomicInt               mLastId;             // the last id given to an asynchronous event
+    mutable QMutex           mMutex;              // protects mEvents, mNext, mSize and the threads
+    qint32                   mNext;               // where the next event goes
+    qint32                   mSize;               // the events in the ring
+    QHash<QThread*, qint32>  mThreadIds;          // the index of the threads seen
+    QStringList              mThreadNames;        // the names of the threads seen
+};
+
+class TracedScope
+{
+public:
+    // records its scope in the trace when the tracer is on, without going to the timing statistics (see ScopedTimer)
+
+    explicit TracedScope(const char *name, const QString &detail = QString()) :
+        mName(Tracer::enabled() ? name : Q_NULLPTR), mBegin(0)
+    {
+        if (!mName)
+            return;
+        mDetail = detail;
+        mBegin  = Tracer::instance().now();
+    }
+    ~TracedScope()
+    {
+        if (mName)
+            Tracer::instance().complete(mName, mBegin, Tracer::instance().now() - mBegin, mDetail);
+    }
+
+private:
+    Q_DISABLE_COPY(TracedScope)
+
+    const char *mName;   // the operation traced, null if the tracer is off
+    qint64     mBegin;   // the beginning in the time base of the tracer
+    QString    mDetail;  // what the operation works on
+};
+
+#endif // TRACER_H
@@ -0,0 +1,130 @@
+// The monthly used resources per funding agency (WLCG CPU, MonALISA CPU, disk and tape)
+// one entry per month and funding agency with the sum over all funding agencies,
+// and the resources pledged by each funding agency per year
+// filled in the ingestion thread while the views read it, all the accesses are locked
+
+#include <QSet>
+
+#include "usageledger.h"
+
+//===========================================================================
+void UsageLedger::clear()
+{
+    // forgets all the months and pledges
+
+    QWriteLocker locker(&mLock);
+    mMonths.clear();
+    mPledged.clear();
+}
+
+//===========================================================================
+bool UsageLedger::contains(const QDate &month) const
+{
+    // true if the usage of month has been recorded
+
+    QReadLocker locker(&mLock);
+    return mMonths.contains(key(month));
+}
+
+//===========================================================================
+QStringList UsageLedger::fundingAgencies() const
+{
+    // the names of all the funding agencies with a usage or a pledge, sorted
+
+    QReadLocker locker(&mLock);
+    QSet<QString> names;
+    for (const Month &month : mMonths)
+        for (QHash<QString, Usage>::const_iterator it = month.fas.constBegin(); it != month.fas.constEnd(); ++it)
+            names.insert(it.key());
+    for (const QHash<QString, Usage> &year : mPledged)
+        for (QHash<QString, Usage>::const_iterator it = year.constBegin(); it != year.constEnd(); ++it)
+            names.insert(it.key());
+    QStringList rv = names.toList();
+    rv.sort();
+    return rv;
+}
+
+//===========================================================================
+bool UsageLedger::isEmpty() const
+{
+    // true if no month has been recorded
+
+    QReadLocker locker(&mLock);
+    return mMonths.isEmpty();
+}
+
+//===========================================================================
+QList<QDate> UsageLedger::months() const
+{
+    // the recorded months, in time order
+
+    QReadLocker locker(&mLock);
+    return mMonths.keys();
+}
+
+//===========================================================================
+double UsageLedger::pledged(qint32 year, const QString &fa, Quantity q) const
+{
+    // the resources pledged by fa for year
+
+    QReadLocker locker(&mLock);
+    QMap<qint32, QHash<QString, Usage> >::const_iterator it = mPledged.constFind(year);
+    if (it == mPledged.constEnd())
+        return 0.0;
+    QHash<QString, Usage>::const_iterator fit = it.value().constFind(fa);
+    if (fit == it.value().constEnd())
+        return 0.0;
+    return fit.value().value[q];
+}
+
+//===========================================================================
+void UsageLedger::record(const QDate &month, const QString &fa, const Usage &usage)
+{
+    // sets the used resources of fa during month and updates the total of the month
+
+    QWriteLocker locker(&mLock);
+    Month &entry = mMonths[key(month)];
+    QHash<QString, Usage>::iterator it = entry.fas.find(fa);
+    for (qint32 q = 0; q < kNQuantities; q++) {
+        if (it != entry.fas.end())
+            entry.total.value[q] -= it.value().value[q];
+        entry.total.value[q] += usage.value[q];
+    }
+    entry.fas.insert(fa, usage);
+}
+
+//===========================================================================
+void UsageLedger::recordPledged(qint32 year, const QString &fa, const Usage &pledged)
+{
+    // sets the resources pledged by fa for year
+
+    QWriteLocker locker(&mLock);
+    mPledged[year].insert(fa, pledged);
+}
+
+//===========================================================================
+double UsageLedger::total(const QDate &month, Quantity q) const
+{
+    // the used resources summed over the funding agencies during month
+
+    QReadLocker locker(&mLock);
+    QMap<QDate, Month>::const_iterator it = mMonths.constFind(key(month));
+    if (it == mMonths.constEnd())
+        return 0.0;
+    return it.value().total.value[q];
+}
+
+//===========================================================================
+double UsageLedger::value(const QDate &month, const QString &fa, Quantity q) const
+{
+    // the used resources of fa during month
+
+    QReadLocker locker(&mLock);
+    QMap<QDate, Month>::const_iterator it = mMonths.constFind(key(month));
+    if (it == mMonths.constEnd())
+        return 0.0;
+    QHash<QString, Usage>::const_iterator fit = it.value().fas.constFind(fa);
+    if (fit == it.value().fas.constEnd())
+        return 0.0;
+    return fit.value().value[q];
+}
@@ -0,0 +1,51 @@
+// The monthly used resources per funding agency (WLCG CPU, MonALISA CPU, disk and tape)
+// one entry per month and funding agency with the sum over all funding agencies,
+// and the resources pledged by each funding agency per year
+// filled in the ingestion thread while the views read it, all the accesses are locked
+
+#ifndef USAGELEDGER_H
+#define USAGELEDGER_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+
+class UsageLedger
+{
+public:
+    enum Quantity {kCPU, kCPUML, kDiskML, kTapeML, kNQuantities};
+
+    struct Usage {
+        Usage() { for (qint32 q = 0; q < kNQuantities; q++) value[q] = 0.0; }
+        double value[kNQuantities]; // the used resources indexed by Quantity
+    };
+
+    void         clear();
+    bool         contains(const QDate &month) const;
+    QStringList  fundingAgencies() const;
+    bool         isEmpty() const;
+    QList<QDate> months() const;
+    double       pledged(qint32 year, const QString &fa, Quantity q) const;
+    void         record(const QDate &month, const QString &fa, const Usage &usage);
+    void         recordPledged(qint32 year, const QString &fa, const Usage &pledged);
+    double       total(const QDate &month, Quantity q) const;
+    double       value(const QDate &month, const QString &fa, Quantity q) const;
+
+    static QDate key(const QDate &date) { return QDate(date.year(), date.month(), 1); }
+
+private:
+    struct Month {
+        QHash<QString, Usage> fas;   // the used resources per funding agency
+        Usage                 total; // the sum over the funding agencies
+    };
+
+    mutable QReadWriteLock               mLock;    // writers are the ingestion thread, readers the views
+    QMap<QDate, Month>                   mMonths;  // the months, keyed by their first day
+    QMap<qint32, QHash<QString, Usage> > mPledged; // the pledged resources per year and funding agency
+};
+
+#endif // USAGELEDGER_H
@@ -0,0 +1,219 @@
+// A chart view with a time axis that zooms with the mouse wheel and pans by dragging;
+// the series are refilled from their TimeSeriesPyramid at the level matching the visible span
+// double click goes back to the full range
+
+#include <QDateTimeAxis>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QXYSeries>
+#include <QtMath>
+
+#include "downsampler.h"
+#include "timing.h"
+#include "zoomchartview.h"
+
+//===========================================================================
+ZoomChartView::ZoomChartView(QWidget *parent) : QChartView(parent),
+    mAxis(Q_NULLPTR), mDragging(false), mFullMax(0.0), mFullMin(0.0)
+{
+    // ctor
+}
+
+//===========================================================================
+void ZoomChartView::addSeries(QXYSeries *series, const TimeSeriesPyramid &pyramid)
+{
+    // a single series refilled from pyramid when zooming
+
+    addStack(QVector<QXYSeries*>() << series, QVector<TimeSeriesPyramid>() << pyramid);
+}
+
+//===========================================================================
+void ZoomChartView::addStack(const QVector<QXYSeries *> &layers, const QVector<TimeSeriesPyramid> &pyramids)
+{
+    // stacked series (e.g. the boundaries of area series) sharing the same times;
+    // they are refilled with the same points so that they stay stacked
+
+    Stack stack;
+    stack.layers   = layers;
+    stack.pyramids = pyramids;
+    mStacks.append(stack);
+
+    for (const TimeSeriesPyramid &pyramid : pyramids) {
+        if (pyramid.isEmpty())
+            continue;
+        if (mFullMax <= mFullMin) {
+            mFullMin = pyramid.xMin();
+            mFullMax = pyramid.xMax();
+        } else {
+            mFullMin = qMin(mFullMin, pyramid.xMin());
+            mFullMax = qMax(mFullMax, pyramid.xMax());
+        }
+    }
+    axis();
+}
+
+//===========================================================================
+QDateTimeAxis *ZoomChartView::axis()
+{
+    // the horizontal time axis of the chart; the series are refilled when its range changes
+
+    if (mAxis || !chart())
+        return mAxis;
+    for (QAbstractAxis *axis : chart()->axes(Qt::Horizontal)) {
+        mAxis = qobject_cast<QDateTimeAxis*>(axis);
+        if (mAxis)
+            break;
+    }
+    if (mAxis) {
+        mFormat = mAxis->format();
+        connect(mAxis, &QDateTimeAxis::rangeChanged, this, &ZoomChartView::refill);
+    }
+    return mAxis;
+}
+
+//===========================================================================
+void ZoomChartView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    // back to the full range
+
+    if (!axis() || mFullMax <= mFullMin) {
+        QChartView::mouseDoubleClickEvent(event);
+        return;
+    }
+    setRange(mFullMin, mFullMax);
+    event->accept();
+}
+
+//===========================================================================
+void ZoomChartView::mouseMoveEvent(QMouseEvent *event)
+{
+    // pans the time axis following the mouse
+
+    if (!mDragging || !axis()) {
+        QChartView::mouseMoveEvent(event);
+        return;
+    }
+    double width = chart()->plotArea().width();
+    if (width > 0) {
+        double min   = mAxis->min().toMSecsSinceEpoch();
+        double max   = mAxis->max().toMSecsSinceEpoch();
+        double shift = -(event->pos().x() - mLastPos.x()) * (max - min) / width;
+        setRange(min + shift, max + shift);
+    }
+    mLastPos = event->pos();
+    event->accept();
+}
+
+//===========================================================================
+void ZoomChartView::mousePressEvent(QMouseEvent *event)
+{
+    // the left button starts panning
+
+    if (event->button() != Qt::LeftButton || !axis() || mFullMax <= mFullMin) {
+        QChartView::mousePressEvent(event);
+        return;
+    }
+    mDragging = true;
+    mLastPos  = event->pos();
+    setCursor(Qt::ClosedHandCursor);
+    event->accept();
+}
+
+//===========================================================================
+void ZoomChartView::mouseReleaseEvent(QMouseEvent *event)
+{
+    // stops panning
+
+    if (!mDragging) {
+        QChartView::mouseReleaseEvent(event);
+        return;
+    }
+    mDragging = false;
+    unsetCursor();
+    event->accept();
+}
+
+//===========================================================================
+void ZoomChartView::paintEvent(QPaintEvent *event)
+{
+    // renders the chart, timed as the chart render stage
+
+    TIMED_SCOPE("chart render");
+    QChartView::paintEvent(event);
+}
+
+//===========================================================================
+void ZoomChartView::refill()
+{
+    // refills the series with the level of their pyramid matching the visible span,
+    // reduced with LTTB to one point per pixel of the plot area
+
+    TIMED_SCOPE("chart refill");
+
+    if (!axis())
+        return;
+    double from = mAxis->min().toMSecsSinceEpoch();
+    double to   = mAxis->max().toMSecsSinceEpoch();
+
+    qint32 pixels = qRound(chart()->plotArea().width() * devicePixelRatioF());
+    if (pixels <= 0)
+        pixels = Downsampler::threshold(this);
+
+    for (const Stack &stack : mStacks) {
+        const TimeSeriesPyramid &top = stack.pyramids.last();
+        TimeSeriesPyramid::Level level = top.level(from, to, 2 * pixels);
+        QVector<QPointF> topPoints = top.points(level, from, to);
+        QVector<qint32> indices = Downsampler::indices(topPoints, pixels);
+        for (qint32 index = 0; index < stack.layers.size(); index++) {
+            QVector<QPointF> points = stack.pyramids.at(index).points(level, from, to);
+            if (points.size() == topPoints.size())
+                stack.layers.at(index)->replace(Downsampler::select(points, indices));
+            else
+                stack.layers.at(index)->replace(Downsampler::downsample(points, pixels));
+        }
+    }
+
+    // the labels follow the zoom
+    qint64 day = TimeSeriesPyramid::width(TimeSeriesPyramid::kDaily);
+    if (to - from >= 90 * day)
+        mAxis->setFormat(mFormat);
+    else if (to - from >= 2 * day)
+        mAxis->setFormat("dd-MM-yyyy");
+    else
+        mAxis->setFormat("dd-MM hh:mm");
+}
+
+//===========================================================================
+void ZoomChartView::setRange(double min, double max)
+{
+    // sets the range of the time axis, kept inside the span of the data
+
+    double span = qMin(max - min, mFullMax - mFullMin);
+    if (min < mFullMin)
+        min = mFullMin;
+    if (min + span > mFullMax)
+        min = mFullMax - span;
+    mAxis->setRange(QDateTime::fromMSecsSinceEpoch(qRound64(min)), QDateTime::fromMSecsSinceEpoch(qRound64(min + span)));
+}
+
+//===========================================================================
+void ZoomChartView::wheelEvent(QWheelEvent *event)
+{
+    // zooms the time axis around the mouse position, down to one hour
+
+    qint32 delta = event->angleDelta().y();
+    double width = chart() ? chart()->plotArea().width() : 0.0;
+    if (delta == 0 || width <= 0 || !axis() || mFullMax <= mFullMin) {
+        QChartView::wheelEvent(event);
+        return;
+    }
+
+    double min = mAxis->min().toMSecsSinceEpoch();
+    double max = mAxis->max().toMSecsSinceEpoch();
+    double t   = qBound(0.0, (event->pos().x() - chart()->plotArea().left()) / width, 1.0);
+    double at  = min + t * (max - min);
+    double span = (max - min) * qPow(0.8, delta / 120.0);
+    span = qBound(double(TimeSeriesPyramid::width(TimeSeriesPyramid::kHourly)), span, mFullMax - mFullMin);
+    setRange(at - t * span, at + (1 - t) * span);
+    event->accept();
+}
@@ -0,0 +1,60 @@
+// A chart view with a time axis that zooms with the mouse wheel and pans by dragging;
+// the series are refilled from their TimeSeriesPyramid at the level matching the visible span
+// double click goes back to the full range
+
+#ifndef ZOOMCHARTVIEW_H
+#define ZOOMCHARTVIEW_H
+
+#include <QChartView>
+#include <QDateTime>
+#include <QList>
+#include <QVector>
+
+#include "timeseriespyramid.h"
+
+QT_CHARTS_BEGIN_NAMESPACE
+class QDateTimeAxis;
+class QXYSeries;
+QT_CHARTS_END_NAMESPACE
+QT_CHARTS_USE_NAMESPACE
+
+class ZoomChartView : public QChartView
+{
+    Q_OBJECT
+
+public:
+    explicit ZoomChartView(QWidget *parent = 0);
+
+    void addSeries(QXYSeries *series, const TimeSeriesPyramid &pyramid);
+    void addStack(const QVector<QXYSeries*> &layers, const QVector<TimeSeriesPyramid> &pyramids);
+
+protected:
+    void mouseDoubleClickEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void paintEvent(QPaintEvent *event);
+    void wheelEvent(QWheelEvent *event);
+
+private slots:
+    void refill();
+
+private:
+    struct Stack {
+        QVector<QXYSeries*>         layers;   // the series, each one on top of the previous
+        QVector<TimeSeriesPyramid>  pyramids; // the data of each layer
+    };
+
+    QDateTimeAxis *axis();
+    void          setRange(double min, double max);
+
+    QDateTimeAxis *mAxis;    // the time axis of the chart, found with the first series
+    bool          mDragging; // true while the left button pans the chart
+    double        mFullMax;  // the end of the time span of the data (ms since epoch)
+    double        mFullMin;  // the start of the time span of the data (ms since epoch)
+    QString       mFormat;   // the format of the time axis labels for the full range
+    QPoint        mLastPos;  // the last mouse position while dragging
+    QList<Stack>  mStacks;   // the series refilled when zooming
+};
+
+#endif // ZOOMCHARTVIEW_H